@@ -0,0 +1,134 @@
+//
+// The last H observations of an env in a fixed ring, stacked newest first
+// into one state vector. With HistoryMode::deltas every older slot holds the
+// change to the next newer observation instead, which gives an MLP the
+// finite differences it needs to infer velocities. Nothing is allocated
+// after construction.
+//   ObservationHistory<double, 21, 4> history;
+//   history.reset(observation);        // at the start of an episode
+//   history.push(observation);         // after every step
+//   history.stack(state);              // 21 x 4 state
+// ObservationHistoryBatch does the same for a batch of envs stepped
+// together, with one column per env.
+//
+
+#ifndef RAI_OBSERVATIONHISTORY_HPP
+#define RAI_OBSERVATIONHISTORY_HPP
+
+#include <Eigen/Core>
+
+namespace rai {
+namespace Task {
+
+enum class HistoryMode { observations, deltas };
+
+template<typename Dtype, int Dim, int H, HistoryMode Mode = HistoryMode::observations>
+class ObservationHistory {
+  static_assert(H >= 1, "the history holds at least the current observation");
+
+ public:
+  enum { ObservationDim = Dim, Length = H, StackedDim = Dim * H };
+  using Observation = Eigen::Matrix<Dtype, Dim, 1>;
+  using Stacked = Eigen::Matrix<Dtype, StackedDim, 1>;
+
+  /// a new episode, the history is filled with its first observation
+  void reset(const Observation &observation) {
+    ring_.colwise() = observation;
+    newest_ = 0;
+  }
+
+  void push(const Observation &observation) {
+    newest_ = (newest_ + 1) % H;
+    ring_.col(newest_) = observation;
+  }
+
+  /// the ring and its newest slot as doubles, e.g. for a task snapshot
+  enum { SnapshotSize = Dim * H + 1 };
+
+  void save(double *out) const {
+    Eigen::Map<Eigen::Matrix<double, Dim, H> > ring(out);
+    ring = ring_.template cast<double>();
+    out[Dim * H] = newest_;
+  }
+
+  void load(const double *in) {
+    ring_ = Eigen::Map<const Eigen::Matrix<double, Dim, H> >(in).template cast<Dtype>();
+    newest_ = int(in[Dim * H]);
+  }
+
+  /// slot k holds the observation k steps back, or its change to slot k - 1 in deltas mode
+  void stack(Stacked &stacked) const {
+    int index = newest_;
+    stacked.template head<Dim>() = ring_.col(index);
+    for (int k = 1; k < H; k++) {
+      const int older = (index + H - 1) % H;
+      if (Mode == HistoryMode::deltas)
+        stacked.template segment<Dim>(k * Dim) = ring_.col(index) - ring_.col(older);
+      else
+        stacked.template segment<Dim>(k * Dim) = ring_.col(older);
+      index = older;
+    }
+  }
+
+ private:
+  Eigen::Matrix<Dtype, Dim, H> ring_ = Eigen::Matrix<Dtype, Dim, H>::Zero();
+  int newest_ = 0;
+};
+
+template<typename Dtype, int Dim, int H, HistoryMode Mode = HistoryMode::observations>
+class ObservationHistoryBatch {
+  static_assert(H >= 1, "the history holds at least the current observation");
+
+ public:
+  enum { ObservationDim = Dim, Length = H, StackedDim = Dim * H };
+  using ObservationBatch = Eigen::Matrix<Dtype, Dim, Eigen::Dynamic>;
+  using StackedBatch = Eigen::Matrix<Dtype, StackedDim, Eigen::Dynamic>;
+
+  /// slot k of every env lives in rows k * Dim of one matrix, so a push is a single block copy
+  explicit ObservationHistoryBatch(int nEnvs) : ring_(StackedDim, nEnvs) { ring_.setZero(); }
+
+  int nEnvs() const { return int(ring_.cols()); }
+
+  /// a new episode of env
+  template<typename Derived>
+  void reset(int env, const Eigen::MatrixBase<Derived> &observation) {
+    for (int k = 0; k < H; k++)
+      ring_.col(env).template segment<Dim>(k * Dim) = observation;
+  }
+
+  void resetAll(const ObservationBatch &observations) {
+    for (int k = 0; k < H; k++)
+      ring_.template middleRows<Dim>(k * Dim) = observations;
+    newest_ = 0;
+  }
+
+  /// the observations after one step of every env
+  void push(const ObservationBatch &observations) {
+    newest_ = (newest_ + 1) % H;
+    ring_.template middleRows<Dim>(newest_ * Dim) = observations;
+  }
+
+  void stack(StackedBatch &out) const {
+    out.resize(StackedDim, ring_.cols());
+    int index = newest_;
+    out.template topRows<Dim>() = ring_.template middleRows<Dim>(index * Dim);
+    for (int k = 1; k < H; k++) {
+      const int older = (index + H - 1) % H;
+      if (Mode == HistoryMode::deltas)
+        out.template middleRows<Dim>(k * Dim) =
+            ring_.template middleRows<Dim>(index * Dim) - ring_.template middleRows<Dim>(older * Dim);
+      else
+        out.template middleRows<Dim>(k * Dim) = ring_.template middleRows<Dim>(older * Dim);
+      index = older;
+    }
+  }
+
+ private:
+  StackedBatch ring_;
+  int newest_ = 0;
+};
+
+}
+}
+
+#endif //RAI_OBSERVATIONHISTORY_HPP
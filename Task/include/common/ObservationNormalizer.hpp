@@ -0,0 +1,172 @@
+//
+// Running observation normalization for the tasks. Every task keeps its own
+// Welford statistics of the states it returns and normalizes them with a
+// frozen mean and stdev in getState, so an iteration sees one fixed mapping
+// and the threads never share a counter. At an iteration boundary the
+// trainer merges the statistics of all tasks and hands the new frozen
+// normalization back to them:
+//   ObservationNormalizer<Dtype, StateDim>::update(normalizers, total);
+// The frozen normalization is saved next to the policy parameters, a
+// deployed policy needs it to build its input.
+//
+
+#ifndef RAI_OBSERVATIONNORMALIZER_HPP
+#define RAI_OBSERVATIONNORMALIZER_HPP
+
+#include <Eigen/Core>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "glog/logging.h"
+
+namespace rai {
+namespace Task {
+
+/// mean and sum of squared deviations of a stream of Dim vectors
+template<int Dim>
+class RunningStatistics {
+ public:
+  using Vector = Eigen::Array<double, Dim, 1>;
+
+  RunningStatistics() { clear(); }
+
+  void clear() {
+    count_ = 0.0;
+    mean_.setZero();
+    m2_.setZero();
+  }
+
+  template<typename Derived>
+  void push(const Eigen::ArrayBase<Derived> &x) {
+    count_ += 1.0;
+    const Vector delta = x - mean_;
+    mean_ += delta / count_;
+    m2_ += delta * (x - mean_);
+  }
+
+  /// the statistics of both streams together (Chan et al.), exact in any merge order
+  void merge(const RunningStatistics &other) {
+    if (other.count_ == 0.0) return;
+    const double count = count_ + other.count_;
+    const Vector delta = other.mean_ - mean_;
+    m2_ += other.m2_ + delta.square() * (count_ * other.count_ / count);
+    mean_ += delta * (other.count_ / count);
+    count_ = count;
+  }
+
+  double count() const { return count_; }
+  const Vector &mean() const { return mean_; }
+  Vector variance() const { return count_ > 1.0 ? Vector(m2_ / (count_ - 1.0)) : Vector(Vector::Ones()); }
+
+ private:
+  double count_;
+  Vector mean_, m2_;
+};
+
+/// the mapping applied to the states during an iteration
+template<int Dim>
+struct FrozenNormalization {
+  using Vector = Eigen::Array<double, Dim, 1>;
+  Vector mean = Vector::Zero();
+  Vector invStdev = Vector::Ones();
+  double count = 0.0;
+
+  /// components whose stdev is below minStdev, e.g. constant ones, are only centered
+  static FrozenNormalization from(const RunningStatistics<Dim> &statistics, double minStdev = 1e-2) {
+    FrozenNormalization frozen;
+    frozen.mean = statistics.mean();
+    frozen.invStdev = statistics.variance().sqrt().max(minStdev).inverse();
+    frozen.count = statistics.count();
+    return frozen;
+  }
+
+  void save(const std::string &path) const {
+    std::ofstream file(path);
+    file.precision(17);
+    file << Dim << " " << count << "\n" << mean.transpose() << "\n" << invStdev.inverse().transpose() << "\n";
+    LOG_IF(FATAL, !file) << "observation normalization: cannot write " << path;
+  }
+
+  static FrozenNormalization load(const std::string &path) {
+    std::ifstream file(path);
+    FrozenNormalization frozen;
+    int dim;
+    Vector stdev;
+    LOG_IF(FATAL, !(file >> dim >> frozen.count) || dim != Dim) << "observation normalization: cannot read " << path;
+    for (int i = 0; i < Dim; i++) file >> frozen.mean(i);
+    for (int i = 0; i < Dim; i++) file >> stdev(i);
+    LOG_IF(FATAL, !file) << "observation normalization: " << path << " is truncated";
+    frozen.invStdev = stdev.inverse();
+    return frozen;
+  }
+};
+
+template<typename Dtype, int Dim>
+class ObservationNormalizer {
+ public:
+  using State = Eigen::Matrix<Dtype, Dim, 1>;
+  using Statistics = RunningStatistics<Dim>;
+  using Frozen = FrozenNormalization<Dim>;
+
+  /// normalizes with frozen from now on. collect keeps statistics of the states for the next update
+  void enable(std::shared_ptr<const Frozen> frozen, bool collect = true) {
+    frozen_ = std::move(frozen);
+    collect_ = collect;
+  }
+
+  void disable() {
+    frozen_.reset();
+    collect_ = false;
+  }
+
+  bool enabled() const { return bool(frozen_); }
+
+  /// called by getState on the state it built, one pass that records and normalizes it
+  void apply(State &state) {
+    if (!frozen_) return;
+    const Eigen::Array<double, Dim, 1> raw = state.template cast<double>().array();
+    if (collect_) statistics_.push(raw);
+    state = ((raw - frozen_->mean) * frozen_->invStdev).matrix().template cast<Dtype>();
+  }
+
+  /// the state getState built before apply, for initTo
+  State restore(const State &state) const {
+    if (!frozen_) return state;
+    return (state.template cast<double>().array() / frozen_->invStdev + frozen_->mean).matrix().template cast<Dtype>();
+  }
+
+  Statistics &statistics() { return statistics_; }
+
+  /// merges the statistics of every normalizer into total, clears them and enables the
+  /// normalization total describes on all of them. The merge is a pairwise tree over the normalizers
+  static std::shared_ptr<const Frozen> update(const std::vector<ObservationNormalizer *> &normalizers,
+                                              Statistics &total, bool collect = true) {
+    std::vector<Statistics> partial(normalizers.size());
+    for (size_t i = 0; i < normalizers.size(); i++) {
+      partial[i] = normalizers[i]->statistics_;
+      normalizers[i]->statistics_.clear();
+    }
+    for (size_t stride = 1; stride < partial.size(); stride *= 2) {
+#pragma omp parallel for schedule(static)
+      for (long i = 0; i < long(partial.size() - stride); i += 2 * stride)
+        partial[i].merge(partial[i + stride]);
+    }
+    if (!partial.empty()) total.merge(partial[0]);
+
+    auto frozen = std::make_shared<const Frozen>(Frozen::from(total));
+    for (auto normalizer : normalizers)
+      normalizer->enable(frozen, collect);
+    return frozen;
+  }
+
+ private:
+  std::shared_ptr<const Frozen> frozen_;
+  Statistics statistics_;
+  bool collect_ = false;
+};
+
+}
+}
+
+#endif //RAI_OBSERVATIONNORMALIZER_HPP
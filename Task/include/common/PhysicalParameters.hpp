@@ -0,0 +1,84 @@
+//
+// Physical parameters of the quadrotor tasks as one contiguous block of
+// doubles, so a task can swap them at every reset instead of being rebuilt.
+// ParameterRandomization draws each field uniformly from a relative range
+// around its nominal value, e.g. spread.mass = 0.2 for +-20% mass.
+// QuadrotorControl ignores loadMass and tetherLength.
+//
+
+#ifndef RAI_PHYSICALPARAMETERS_HPP
+#define RAI_PHYSICALPARAMETERS_HPP
+
+#include <Eigen/Core>
+#include <random>
+#include <string>
+#include <type_traits>
+
+namespace rai {
+namespace Task {
+
+struct PhysicalParameters {
+  double mass = 0.665;
+  double loadMass = 0.08;
+  double tetherLength = 1.0;
+  double armLength = 0.17;
+  double dragCoeff = 0.016;
+  double inertia[3] = {0.007, 0.007, 0.012};  // diagonal, body frame
+
+  enum { size = 8 };
+  using Vector = Eigen::Matrix<double, size, 1>;
+
+  Eigen::Map<Vector> vector() { return Eigen::Map<Vector>(&mass); }
+  Eigen::Map<const Vector> vector() const { return Eigen::Map<const Vector>(&mass); }
+
+  /// the parameters the thrust to generalized force mapping depends on
+  bool sameRotorGeometry(const PhysicalParameters &other) const {
+    return armLength == other.armLength && dragCoeff == other.dragCoeff;
+  }
+};
+
+static_assert(std::is_standard_layout<PhysicalParameters>::value
+                  && sizeof(PhysicalParameters) == PhysicalParameters::size * sizeof(double),
+              "PhysicalParameters must stay a contiguous block of doubles");
+
+struct ParameterRandomization {
+  PhysicalParameters nominal;
+  PhysicalParameters spread = zeroSpread();  // relative half width of the uniform range
+
+  bool enabled() const { return !spread.vector().isZero(); }
+
+  void sample(std::mt19937_64 &rng, PhysicalParameters &parameters) const {
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    PhysicalParameters::Vector u;
+    for (int i = 0; i < PhysicalParameters::size; i++) u(i) = uniform(rng);
+    parameters.vector() = nominal.vector().cwiseProduct(
+        (PhysicalParameters::Vector::Ones() + spread.vector().cwiseProduct(u)));
+  }
+
+  /// spreads from "randomize.<field>" keys of a Config; fields without a key are not randomized
+  template<typename Config>
+  static ParameterRandomization fromConfig(const Config &config) {
+    ParameterRandomization randomization;
+    PhysicalParameters &spread = randomization.spread;
+    spread.mass = config.get("randomize.mass", 0.0);
+    spread.loadMass = config.get("randomize.load_mass", 0.0);
+    spread.tetherLength = config.get("randomize.tether_length", 0.0);
+    spread.armLength = config.get("randomize.arm_length", 0.0);
+    spread.dragCoeff = config.get("randomize.drag", 0.0);
+    const double inertia = config.get("randomize.inertia", 0.0);
+    for (double &axis : spread.inertia) axis = inertia;
+    return randomization;
+  }
+
+ private:
+  static PhysicalParameters zeroSpread() {
+    PhysicalParameters zero;
+    zero.vector().setZero();
+    return zero;
+  }
+};
+
+}
+}
+
+#endif //RAI_PHYSICALPARAMETERS_HPP
@@ -0,0 +1,164 @@
+//
+// Initial states of a task, generated in batches ahead of time. A background
+// thread keeps a few batches ready, so an episode reset only copies one
+// column out of the current batch. One pool is shared by every env of a
+// process, handed to them with setResetPool; pop is thread safe. Seeded from
+// the run's generator, the same seed gives the same stream of resets.
+//   ResetPool<19> pool([](std::mt19937_64 &rng, ResetPool<19>::Batch &batch) { ... }, 1024, 4, seed);
+//   pool.pop(sample);
+// A fixed pool holds one seeded batch and cycles through it instead, which
+// gives the same set of initial states on every run. Its version() names the
+// seed and size, and save/load keep the set next to the results.
+//
+
+#ifndef RAI_RESETPOOL_HPP
+#define RAI_RESETPOOL_HPP
+
+#include <Eigen/Core>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include "glog/logging.h"
+
+namespace rai {
+namespace Task {
+
+template<int Dim>
+class ResetPool {
+ public:
+  using Sample = Eigen::Matrix<double, Dim, 1>;
+  using Batch = Eigen::Matrix<double, Dim, Eigen::Dynamic>;
+  /// fills every column of batch with one initial state
+  using Generator = std::function<void(std::mt19937_64 &rng, Batch &batch)>;
+
+  /// without a seed the states differ on every run
+  ResetPool(Generator generator, int batchSize = 1024, int readyBatches = 4, uint64_t seed = std::random_device()())
+      : generator_(std::move(generator)), batchSize_(batchSize), readyBatches_(readyBatches), rng_(seed) {
+    current_.resize(Dim, 0);
+    filler_ = std::thread(&ResetPool::fill, this);
+  }
+
+  /// a pool cycling through count states generated from seed
+  static std::unique_ptr<ResetPool> fixed(const Generator &generator, int count, uint64_t seed) {
+    LOG_IF(FATAL, count < 1) << "reset pool: a fixed pool needs at least one state, got " << count;
+    std::unique_ptr<ResetPool> pool(new ResetPool());
+    std::mt19937_64 rng(seed);
+    pool->current_.resize(Dim, count);
+    generator(rng, pool->current_);
+    pool->version_ = "seed " + std::to_string(seed) + ", " + std::to_string(count) + " states";
+    return pool;
+  }
+
+  /// a fixed pool with the states written by save
+  static std::unique_ptr<ResetPool> load(const std::string &path) {
+    std::ifstream file(path);
+    std::unique_ptr<ResetPool> pool(new ResetPool());
+    int dim, count;
+    LOG_IF(FATAL, !std::getline(file, pool->version_) || !(file >> dim >> count) || dim != Dim || count < 1)
+    << "reset pool: cannot read " << path;
+    pool->current_.resize(Dim, count);
+    for (int i = 0; i < count; i++)
+      for (int j = 0; j < Dim; j++)
+        file >> pool->current_(j, i);
+    LOG_IF(FATAL, !file) << "reset pool: " << path << " is truncated";
+    return pool;
+  }
+
+  ~ResetPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    refill_.notify_one();
+    if (filler_.joinable()) filler_.join();
+  }
+
+  ResetPool(const ResetPool &) = delete;
+  ResetPool &operator=(const ResetPool &) = delete;
+
+  void pop(Sample &sample) {
+    if (isFixed()) {
+      const auto index = cursor_.fetch_add(1, std::memory_order_relaxed);
+      sample = current_.col(index % current_.cols());
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (next_ == current_.cols()) {
+      ready_.wait(lock, [this] { return !full_.empty(); });
+      empty_.push_back(std::move(current_));
+      current_ = std::move(full_.front());
+      full_.pop_front();
+      next_ = 0;
+      refill_.notify_one();
+    }
+    sample = current_.col(next_++);
+  }
+
+  bool isFixed() const { return !filler_.joinable(); }
+
+  /// empty unless the pool is fixed
+  const std::string &version() const { return version_; }
+
+  /// writes the states of a fixed pool so a later run can load them
+  void save(const std::string &path) const {
+    LOG_IF(FATAL, !isFixed()) << "reset pool: only a fixed pool can be saved";
+    std::ofstream file(path);
+    file.precision(17);
+    file << version_ << "\n" << Dim << " " << current_.cols() << "\n";
+    for (int i = 0; i < current_.cols(); i++)
+      file << current_.col(i).transpose() << "\n";
+  }
+
+ private:
+  ResetPool() = default;
+
+  void fill() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      refill_.wait(lock, [this] { return stop_ || int(full_.size()) < readyBatches_; });
+      if (stop_) return;
+
+      Batch batch;
+      if (!empty_.empty()) {
+        batch = std::move(empty_.back());
+        empty_.pop_back();
+      }
+      lock.unlock();
+      batch.resize(Dim, batchSize_);
+      generator_(rng_, batch);
+      lock.lock();
+
+      full_.push_back(std::move(batch));
+      ready_.notify_all();
+    }
+  }
+
+  Generator generator_;
+  int batchSize_ = 0, readyBatches_ = 0;
+  std::mt19937_64 rng_;
+  std::string version_;
+
+  Batch current_;
+  Eigen::Index next_ = 0;
+  std::atomic<uint64_t> cursor_{0};
+
+  std::deque<Batch> full_, empty_;
+  std::mutex mutex_;
+  std::condition_variable ready_, refill_;
+  bool stop_ = false;
+  std::thread filler_;
+};
+
+}
+}
+
+#endif //RAI_RESETPOOL_HPP
@@ -0,0 +1,226 @@
+//
+// Sampling-based model predictive control on the tasks themselves. From a
+// snapshot of the controlled task, every iteration rolls out `samples`
+// perturbed action sequences of `horizon` steps on worker tasks, one worker
+// per thread, and moves the nominal sequence towards the cheap ones: MPPI
+// averages all samples with exponential weights, CEM refits mean and stdev
+// to the elites. Iterations repeat until the next one would overrun the time
+// budget, then the first action is returned and the sequence shifted to warm
+// start the next control step. The task's own PD stabilizer stays in the
+// loop, the MPC plans the same actions a policy would output. The workers
+// are left as act() found them, their episode, observation normalizer and
+// episode statistics are put back, so the imagined steps never show up in
+// them.
+//   SamplingMpc<slungloadControl<double> > mpc(workers, parameters);
+//   task.saveState(snapshot);
+//   mpc.act(snapshot, action);
+//   mpc.statistics().controlRate();
+//
+
+#ifndef RAI_SAMPLINGMPC_HPP
+#define RAI_SAMPLINGMPC_HPP
+
+#include <Eigen/Core>
+#include <omp.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <type_traits>
+#include <vector>
+#include "glog/logging.h"
+#include "metrics/EpisodeStatistics.hpp"
+#include "raiCommon/enumeration.hpp"
+
+namespace rai {
+namespace Task {
+
+enum class MpcMethod { mppi, cem };
+
+struct MpcParameters {
+  MpcMethod method = MpcMethod::mppi;
+  int samples = 256;
+  int horizon = 50;
+  double noiseStdev = 0.3;      // of the action perturbations, CEM starts its stdev here and keeps refitting it
+  double temperature = 0.1;     // MPPI, relative to the stdev of the sampled costs
+  double eliteFraction = 0.1;   // CEM
+  double timeBudget = 0.01;     // seconds per control step, at least one iteration always runs
+  int maxIterations = 10;
+};
+
+template<typename TaskType>
+class SamplingMpc {
+ public:
+  using Snapshot = typename TaskType::Snapshot;
+  using State = typename TaskType::State;
+  using Action = typename TaskType::Action;
+  using Dtype = typename State::Scalar;
+  enum { ActionDim = Action::RowsAtCompileTime };
+  using Sequence = Eigen::Matrix<double, ActionDim, Eigen::Dynamic>;
+  using Normalizer = typename std::decay<decltype(std::declval<TaskType &>().observationNormalizer())>::type;
+
+  struct Statistics {
+    long controlSteps = 0, iterations = 0, rollouts = 0;
+    double seconds = 0.0;
+    /// control steps per second of wall time
+    double controlRate() const { return seconds > 0.0 ? controlSteps / seconds : 0.0; }
+    double rolloutsPerSecond() const { return seconds > 0.0 ? rollouts / seconds : 0.0; }
+  };
+
+  /// the samples are spread over the workers, so one worker per core uses the whole machine
+  SamplingMpc(std::vector<TaskType *> workers, const MpcParameters &parameters) :
+      workers_(std::move(workers)), param_(parameters), rngs_(workers_.size()),
+      noise_(param_.samples, Sequence(int(ActionDim), param_.horizon)), costs_(param_.samples) {
+    LOG_IF(FATAL, workers_.empty()) << "the MPC needs at least one worker task";
+    for (auto worker : workers_) {
+      saved_.emplace_back();
+      imagined_.emplace_back(worker->episodeStatistics());
+    }
+    LOG_IF(FATAL, param_.samples < 2 || param_.horizon < 1) << "the MPC needs 2 samples and 1 step at least";
+    std::random_device device;
+    for (auto &rng : rngs_) rng.seed(device());
+    reset();
+  }
+
+  /// forgets the warm start, e.g. at the start of an episode, CEM's stdev starts over as well
+  void reset() {
+    mean_.setZero(int(ActionDim), param_.horizon);
+    stdev_.setConstant(int(ActionDim), param_.horizon, param_.noiseStdev);
+  }
+
+  void act(const Snapshot &snapshot, Action &action) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    auto elapsed = [&]() { return std::chrono::duration<double>(Clock::now() - start).count(); };
+
+    /// CEM keeps the stdev refitted at the previous step, the warm start below only widens the new last column
+    for (size_t i = 0; i < workers_.size(); i++) {
+      workers_[i]->saveState(saved_[i].snapshot);
+      saved_[i].normalizer = workers_[i]->observationNormalizer();
+      workers_[i]->episodeStatistics().swap(imagined_[i]);
+    }
+    double iterationTime = 0.0;
+    int iteration = 0;
+    do {
+      const double iterationStart = elapsed();
+      rollouts(snapshot);
+      if (param_.method == MpcMethod::mppi)
+        updateMppi();
+      else
+        updateCem();
+      iterationTime = elapsed() - iterationStart;
+      iteration++;
+    } while (iteration < param_.maxIterations && elapsed() + iterationTime <= param_.timeBudget);
+
+    for (size_t i = 0; i < workers_.size(); i++) {
+      workers_[i]->episodeStatistics().swap(imagined_[i]);
+      workers_[i]->observationNormalizer() = saved_[i].normalizer;
+      workers_[i]->restoreState(saved_[i].snapshot);
+    }
+    action = mean_.col(0).template cast<Dtype>();
+
+    /// warm start, the plan moves one step and its last action is repeated
+    const int h = param_.horizon;
+    mean_.leftCols(h - 1) = mean_.rightCols(h - 1).eval();
+    stdev_.leftCols(h - 1) = stdev_.rightCols(h - 1).eval();
+    stdev_.col(h - 1).setConstant(param_.noiseStdev);
+
+    statistics_.controlSteps++;
+    statistics_.iterations += iteration;
+    statistics_.rollouts += long(iteration) * param_.samples;
+    statistics_.seconds += elapsed();
+  }
+
+  const Sequence &plan() const { return mean_; }
+  const Statistics &statistics() const { return statistics_; }
+  void clearStatistics() { statistics_ = Statistics(); }
+
+ private:
+  /// discounted cost of every perturbed sequence, a terminal state ends it with the terminal value
+  void rollouts(const Snapshot &snapshot) {
+    const Dtype discount = workers_[0]->discountFtr();
+    const Dtype terminalValue = workers_[0]->termValue();
+
+#pragma omp parallel for schedule(dynamic) num_threads(int(workers_.size()))
+    for (int k = 0; k < param_.samples; k++) {
+      const int thread = omp_get_thread_num();
+      TaskType &task = *workers_[thread];
+      std::normal_distribution<double> normal;
+      Sequence &noise = noise_[k];
+      for (int t = 0; t < param_.horizon; t++)
+        for (int a = 0; a < ActionDim; a++)
+          noise(a, t) = normal(rngs_[thread]) * stdev_(a, t);
+      /// the first sample keeps the nominal sequence
+      if (k == 0) noise.setZero();
+
+      task.restoreState(snapshot);
+      State state;
+      Dtype stepCost, weight = 1;
+      double cost = 0.0;
+      for (int t = 0; t < param_.horizon; t++) {
+        TerminationType termType = TerminationType::not_terminated;
+        const Action action = (mean_.col(t) + noise.col(t)).template cast<Dtype>();
+        task.step(action, state, termType, stepCost);
+        cost += weight * stepCost;
+        if (termType == TerminationType::terminalState) {
+          cost += weight * discount * terminalValue;
+          break;
+        }
+        weight *= discount;
+      }
+      costs_[k] = cost;
+    }
+  }
+
+  void updateMppi() {
+    const Eigen::Map<const Eigen::ArrayXd> costs(costs_.data(), param_.samples);
+    const double minCost = costs.minCoeff();
+    const double spread = std::sqrt((costs - costs.mean()).square().mean());
+    const Eigen::ArrayXd weights = (-(costs - minCost) / std::max(param_.temperature * spread, 1e-12)).exp();
+    Sequence update = Sequence::Zero(int(ActionDim), param_.horizon);
+    for (int k = 0; k < param_.samples; k++)
+      update += weights(k) * noise_[k];
+    mean_ += update / weights.sum();
+  }
+
+  void updateCem() {
+    const int nElites = std::max(2, int(param_.eliteFraction * param_.samples));
+    std::vector<int> order(param_.samples);
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(order.begin(), order.begin() + nElites, order.end(),
+                      [&](int a, int b) { return costs_[a] < costs_[b]; });
+    Sequence mean = Sequence::Zero(int(ActionDim), param_.horizon);
+    Sequence squares = Sequence::Zero(int(ActionDim), param_.horizon);
+    for (int e = 0; e < nElites; e++) {
+      mean += noise_[order[e]];
+      squares += noise_[order[e]].cwiseAbs2();
+    }
+    mean /= nElites;
+    squares /= nElites;
+    mean_ += mean;
+    stdev_ = (squares - mean.cwiseAbs2()).cwiseMax(0.0).cwiseSqrt().cwiseMax(1e-3 * param_.noiseStdev);
+  }
+
+  /// what act() puts back on a worker
+  struct Saved {
+    Snapshot snapshot;
+    Normalizer normalizer;
+  };
+
+  std::vector<TaskType *> workers_;
+  std::vector<Saved> saved_;
+  /// the imagined episodes end up here, swapped in for the worker's own statistics during act()
+  std::vector<Metrics::EpisodeStatistics> imagined_;
+  MpcParameters param_;
+  std::vector<std::mt19937_64> rngs_;
+  std::vector<Sequence> noise_;
+  std::vector<double> costs_;
+  Sequence mean_, stdev_;
+  Statistics statistics_;
+};
+
+}
+}
+
+#endif //RAI_SAMPLINGMPC_HPP
@@ -0,0 +1,84 @@
+//
+// Builds envs by name. A task is registered with its class template; create
+// checks the requested dimensions against its TaskTraits, so a typo in a
+// config fails with a message instead of a wrong cast.
+//   TaskRegistry<double> registry;
+//   registry.add<slungloadControl>();
+//   auto env = registry.create<24, 4>("slungload");
+//
+
+#ifndef RAI_TASKREGISTRY_HPP
+#define RAI_TASKREGISTRY_HPP
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "glog/logging.h"
+#include "rai/tasks/common/Task.hpp"
+#include "common/TaskTraits.hpp"
+
+namespace rai {
+namespace Task {
+
+template<typename Dtype>
+class TaskRegistry {
+ public:
+
+  struct Entry {
+    int stateDim, actionDim, commandDim;
+    std::function<void *()> create;  // returns a Task<Dtype, stateDim, actionDim, commandDim> *
+  };
+
+  /// registers TaskType under TaskTraits<TaskType>::name() or the given name
+  template<template<typename> class TaskType>
+  void add(const std::string &name = TaskTraits<TaskType>::name()) {
+    using Traits = TaskTraits<TaskType>;
+    using Base = Task<Dtype, Traits::StateDim, Traits::ActionDim, Traits::CommandDim>;
+    entries_[name] = Entry{Traits::StateDim, Traits::ActionDim, Traits::CommandDim, []() {
+      return static_cast<void *>(static_cast<Base *>(new TaskType<Dtype>()));
+    }};
+  }
+
+  bool has(const std::string &name) const { return entries_.count(name) != 0; }
+
+  const Entry &entry(const std::string &name) const {
+    auto found = entries_.find(name);
+    LOG_IF(FATAL, found == entries_.end()) << "task registry: unknown task " << name;
+    return found->second;
+  }
+
+  template<int StateDim, int ActionDim, int CommandDim = 0>
+  std::unique_ptr<Task<Dtype, StateDim, ActionDim, CommandDim> > create(const std::string &name) const {
+    const Entry &found = entry(name);
+    LOG_IF(FATAL, found.stateDim != StateDim || found.actionDim != ActionDim || found.commandDim != CommandDim)
+    << "task registry: " << name << " has dimensions " << found.stateDim << "/" << found.actionDim
+    << ", requested " << StateDim << "/" << ActionDim;
+    return std::unique_ptr<Task<Dtype, StateDim, ActionDim, CommandDim> >(
+        static_cast<Task<Dtype, StateDim, ActionDim, CommandDim> *>(found.create()));
+  }
+
+  template<int StateDim, int ActionDim, int CommandDim = 0>
+  std::vector<std::unique_ptr<Task<Dtype, StateDim, ActionDim, CommandDim> > >
+  create(const std::string &name, int count) const {
+    std::vector<std::unique_ptr<Task<Dtype, StateDim, ActionDim, CommandDim> > > tasks;
+    for (int i = 0; i < count; i++)
+      tasks.push_back(create<StateDim, ActionDim, CommandDim>(name));
+    return tasks;
+  }
+
+  std::vector<std::string> names() const {
+    std::vector<std::string> names;
+    for (auto &entry : entries_) names.push_back(entry.first);
+    return names;
+  }
+
+ private:
+  std::map<std::string, Entry> entries_;
+};
+
+}
+}
+
+#endif //RAI_TASKREGISTRY_HPP
@@ -0,0 +1,57 @@
+//
+// The part of a task that changes during an episode, as plain data. A task
+// copied as a whole drags its visualizer handles, StopWatch, reset pool and
+// normalizer along; saveState / restoreState only move this block, so an env
+// can be put back to a junction of an episode once per branch:
+//   slungloadControl<double>::Snapshot junction;
+//   task.saveState(junction);
+//   worker.restoreState(junction);   // any task of the same type continues from there
+// The reset draws of init() are not part of it, a restored task continues
+// the episode exactly but its next episode starts from a fresh draw.
+//
+
+#ifndef RAI_TASKSNAPSHOT_HPP
+#define RAI_TASKSNAPSHOT_HPP
+
+#include <Eigen/Core>
+#include <random>
+#include <type_traits>
+#include "common/PhysicalParameters.hpp"
+
+namespace rai {
+namespace Task {
+
+/// extra holds what a task keeps beyond q, u and du, e.g. the state of its load estimator
+template<int CoordinateDim, int VelocityDim, int ExtraDim = 0>
+struct TaskSnapshot {
+  enum { ExtraSize = ExtraDim > 0 ? ExtraDim : 1 };
+  using Coordinate = Eigen::Matrix<double, CoordinateDim, 1>;
+  using Velocity = Eigen::Matrix<double, VelocityDim, 1>;
+  using Extra = Eigen::Matrix<double, ExtraSize, 1>;
+
+  double q[CoordinateDim];
+  double u[VelocityDim];
+  double du[VelocityDim];
+  double extra[ExtraSize];
+  PhysicalParameters parameters;
+  std::mt19937_64 rng;        // the task's own generator, e.g. for parameter randomization
+  bool rngSeeded;
+  long steps;                 // control steps since the episode started
+
+  Eigen::Map<Coordinate> coordinate() { return Eigen::Map<Coordinate>(q); }
+  Eigen::Map<const Coordinate> coordinate() const { return Eigen::Map<const Coordinate>(q); }
+  Eigen::Map<Velocity> velocity() { return Eigen::Map<Velocity>(u); }
+  Eigen::Map<const Velocity> velocity() const { return Eigen::Map<const Velocity>(u); }
+  Eigen::Map<Velocity> acceleration() { return Eigen::Map<Velocity>(du); }
+  Eigen::Map<const Velocity> acceleration() const { return Eigen::Map<const Velocity>(du); }
+  Eigen::Map<Extra> extraState() { return Eigen::Map<Extra>(extra); }
+  Eigen::Map<const Extra> extraState() const { return Eigen::Map<const Extra>(extra); }
+};
+
+static_assert(std::is_trivially_copyable<TaskSnapshot<10, 9> >::value,
+              "a snapshot is copied between envs and threads byte by byte");
+
+}
+}
+
+#endif //RAI_TASKSNAPSHOT_HPP
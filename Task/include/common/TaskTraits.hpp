@@ -0,0 +1,20 @@
+//
+// Compile-time dimensions of the tasks. Each task header specializes
+// TaskTraits for its class template instead of defining namespace-level
+// constants, so tasks with different dimensions can share a translation unit:
+//   TaskTraits<slungloadControl>::StateDim
+//
+
+#ifndef RAI_TASKTRAITS_HPP
+#define RAI_TASKTRAITS_HPP
+
+namespace rai {
+namespace Task {
+
+template<template<typename> class TaskType>
+struct TaskTraits;
+
+}
+}
+
+#endif //RAI_TASKTRAITS_HPP
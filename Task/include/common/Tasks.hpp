@@ -0,0 +1,65 @@
+//
+// Every task of this repository, registered under its TaskTraits name.
+// visitTask turns a task name into its compile-time dimensions, so a binary
+// can pick the task at runtime and still instantiate the algorithms for it.
+//
+
+#ifndef RAI_TASKS_HPP
+#define RAI_TASKS_HPP
+
+#include "common/TaskRegistry.hpp"
+#include "quadrotor/QuadrotorControl.hpp"
+#include "slungload/slungloadControl.hpp"
+#include "slungload/slungloadControl_partial.hpp"
+#include "slungload/slungloadControl_history.hpp"
+#include "slungload/slungloadControl_estimator.hpp"
+#include "slungload/multiSlungloadControl.hpp"
+
+#include <string>
+#include "glog/logging.h"
+
+namespace rai {
+namespace Task {
+
+template<typename Dtype>
+TaskRegistry<Dtype> defaultTaskRegistry() {
+  TaskRegistry<Dtype> registry;
+  registry.template add<QuadrotorControl>();
+  registry.template add<slungloadControl>();
+  registry.template add<slungloadControl_partial>();
+  registry.template add<slungloadControl_history4>();
+  registry.template add<slungloadControl_estimator>();
+  registry.template add<multiSlungloadControl4>();
+  return registry;
+}
+
+template<template<typename> class TaskType>
+struct TaskTag {
+  using Traits = TaskTraits<TaskType>;
+  template<typename Dtype>
+  using Type = TaskType<Dtype>;
+};
+
+/// calls visitor(TaskTag<TaskType>()) for the task registered as name
+template<typename Visitor>
+void visitTask(const std::string &name, Visitor &&visitor) {
+  if (name == TaskTraits<QuadrotorControl>::name())
+    visitor(TaskTag<QuadrotorControl>());
+  else if (name == TaskTraits<slungloadControl>::name())
+    visitor(TaskTag<slungloadControl>());
+  else if (name == TaskTraits<slungloadControl_partial>::name())
+    visitor(TaskTag<slungloadControl_partial>());
+  else if (name == TaskTraits<slungloadControl_history4>::name())
+    visitor(TaskTag<slungloadControl_history4>());
+  else if (name == TaskTraits<slungloadControl_estimator>::name())
+    visitor(TaskTag<slungloadControl_estimator>());
+  else if (name == TaskTraits<multiSlungloadControl4>::name())
+    visitor(TaskTag<multiSlungloadControl4>());
+  else
+    LOG(FATAL) << "unknown task " << name;
+}
+
+}
+}
+
+#endif //RAI_TASKS_HPP
@@ -0,0 +1,112 @@
+//
+// Vine-style branching from a junction of an episode. Every branch restores
+// the junction snapshot on its own worker task, takes its own first action
+// and then follows the policy, so the branches of one junction run in
+// parallel across the workers and a branch costs what a plain rollout of the
+// same length costs. The policy is evaluated once per step for all branches.
+//   VineBrancher<slungloadControl<double> > vine(workers);
+//   task.saveState(junction);
+//   vine.branch(junction, firstActions, maxSteps, policy, branches);
+// More branches than workers run in waves of one branch per worker.
+//
+
+#ifndef RAI_VINEBRANCHING_HPP
+#define RAI_VINEBRANCHING_HPP
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <vector>
+#include "glog/logging.h"
+#include "raiCommon/enumeration.hpp"
+
+namespace rai {
+namespace Task {
+
+template<typename TaskType>
+class VineBrancher {
+ public:
+  using Snapshot = typename TaskType::Snapshot;
+  using State = typename TaskType::State;
+  using StateBatch = typename TaskType::StateBatch;
+  using Action = typename TaskType::Action;
+  using ActionBatch = typename TaskType::ActionBatch;
+  using Dtype = typename State::Scalar;
+
+  struct Branches {
+    /// sum of gamma^t cost_t of every branch, plus gamma^steps of the terminal value where it hit a terminal state
+    Eigen::Matrix<Dtype, 1, Eigen::Dynamic> costs;
+    /// where every branch stopped, a timed out branch is bootstrapped from there with gamma^steps V(lastState)
+    StateBatch lastStates;
+    std::vector<TerminationType> termination;
+    std::vector<int> steps;
+  };
+
+  explicit VineBrancher(std::vector<TaskType *> workers) : workers_(std::move(workers)) {
+    LOG_IF(FATAL, workers_.empty()) << "vine branching needs at least one worker task";
+  }
+
+  /// firstActions holds one column per branch. policy(states, actions) fills the actions of a state batch.
+  /// A branch ends at a terminal state or after maxSteps steps, then it is a timeout
+  template<typename Policy>
+  void branch(const Snapshot &junction, const ActionBatch &firstActions, int maxSteps, Policy &&policy,
+              Branches &out) {
+    const int nBranches = int(firstActions.cols());
+    out.costs.setZero(1, nBranches);
+    out.lastStates.resize(State::RowsAtCompileTime, nBranches);
+    out.termination.assign(nBranches, TerminationType::timeout);
+    out.steps.assign(nBranches, 0);
+
+    const Dtype discount = workers_[0]->discountFtr();
+    const Dtype terminalValue = workers_[0]->termValue();
+    for (int first = 0; first < nBranches; first += int(workers_.size())) {
+      const int wave = std::min(int(workers_.size()), nBranches - first);
+      StateBatch states(State::RowsAtCompileTime, wave);
+      ActionBatch actions = firstActions.middleCols(first, wave);
+      std::vector<char> active(wave, 1);
+
+#pragma omp parallel for schedule(static)
+      for (int b = 0; b < wave; b++) {
+        State state;
+        workers_[b]->restoreState(junction);
+        workers_[b]->getState(state);
+        states.col(b) = state;
+      }
+
+      Dtype weight = 1;
+      for (int t = 0; t < maxSteps; t++) {
+        if (t > 0) policy(states, actions);
+        int nActive = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+:nActive)
+        for (int b = 0; b < wave; b++) {
+          if (!active[b]) continue;
+          const int index = first + b;
+          State next;
+          Dtype cost;
+          TerminationType termType = TerminationType::not_terminated;
+          workers_[b]->step(actions.col(b), next, termType, cost);
+          states.col(b) = next;
+          out.costs(index) += weight * cost;
+          out.steps[index]++;
+          if (termType == TerminationType::terminalState) {
+            out.costs(index) += weight * discount * terminalValue;
+            out.termination[index] = TerminationType::terminalState;
+            active[b] = 0;
+          } else {
+            nActive++;
+          }
+        }
+        weight *= discount;
+        if (nActive == 0) break;
+      }
+      out.lastStates.middleCols(first, wave) = states;
+    }
+  }
+
+ private:
+  std::vector<TaskType *> workers_;
+};
+
+}
+}
+
+#endif //RAI_VINEBRANCHING_HPP
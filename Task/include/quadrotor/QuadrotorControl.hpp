@@ -15,23 +15,41 @@
 #include <rai/RAI_core>
 #include "raiGraphics/RAI_graphics.hpp"
 #include "quadrotor/visualizer/Quadrotor_Visualizer.hpp"
+#include "quadrotor/visualizer/Quadrotor_OffscreenVisualizer.hpp"
 #include "raiCommon/utils/StopWatch.hpp"
+#include "trace/Trace.hpp"
+#include "metrics/EpisodeStatistics.hpp"
+#include "common/TaskTraits.hpp"
+#include "common/PhysicalParameters.hpp"
+#include "common/ObservationNormalizer.hpp"
+#include "common/TaskSnapshot.hpp"
 
 #pragma once
 
 namespace rai {
 namespace Task {
 
-constexpr int StateDim = 18;
-constexpr int ActionDim = 4;
-constexpr int CommandDim = 0;
+template<typename Dtype>
+class QuadrotorControl;
+
+template<>
+struct TaskTraits<QuadrotorControl> {
+  enum { StateDim = 18, ActionDim = 4, CommandDim = 0 };
+  static const char *name() { return "quadrotor"; }
+};
 
 template<typename Dtype>
 class QuadrotorControl : public Task<Dtype,
-                                     StateDim,
-                                     ActionDim,
-                                     CommandDim> {
+                                     TaskTraits<QuadrotorControl>::StateDim,
+                                     TaskTraits<QuadrotorControl>::ActionDim,
+                                     TaskTraits<QuadrotorControl>::CommandDim> {
  public:
+  enum {
+    StateDim = TaskTraits<QuadrotorControl>::StateDim,
+    ActionDim = TaskTraits<QuadrotorControl>::ActionDim,
+    CommandDim = TaskTraits<QuadrotorControl>::CommandDim
+  };
+
   using TaskBase = Task<Dtype, StateDim, ActionDim, CommandDim>;
   using State = typename TaskBase::State;
   using StateBatch = typename TaskBase::StateBatch;
@@ -47,6 +65,8 @@ class QuadrotorControl : public Task<Dtype,
   using GeneralizedCoordinate = Eigen::Matrix<double, 7, 1>;
   using GeneralizedVelocity = Eigen::Matrix<double, 6, 1>;
   using GeneralizedAcceleration = Eigen::Matrix<double, 6, 1>;
+  using Snapshot = TaskSnapshot<7, 6>;
+
 
   QuadrotorControl() {
 
@@ -57,12 +77,7 @@ class QuadrotorControl : public Task<Dtype,
     this->controlUpdate_dt_ = 0.01;
     gravity_ << 0.0, 0.0, -9.81;
 
-    Eigen::Vector3d diagonalInertia;
-//    diagonalInertia << 0.0105, 0.0105, 0.018;
-    diagonalInertia << 0.007, 0.007, 0.012;
-
-    inertia_ = diagonalInertia.asDiagonal();
-    cholInv(inertia_, inertiaInv_);
+    updateParameters(true);
     comLocation_ << 0.0, 0.0, -0.05;
 
     /////// scale //////
@@ -80,11 +95,7 @@ class QuadrotorControl : public Task<Dtype,
                         6.0, 6.0, 6.0;
     lowerStateBound = -upperStateBound;
     this->setBoxConstraints(lowerStateBound, upperStateBound);
-    transsThrust2GenForce << 0, 0, length_, -length_,
-        -length_, length_, 0, 0,
-        dragCoeff_, dragCoeff_, -dragCoeff_, -dragCoeff_,
-        1, 1, 1, 1;
-    transsThrust2GenForceInv = transsThrust2GenForce.inverse();
+    episodeStatistics_.setBounds(lowerStateBound, upperStateBound);
     targetPosition.setZero();
   }
 
@@ -95,7 +106,8 @@ class QuadrotorControl : public Task<Dtype,
             State &state_tp1,
             TerminationType &termType,
             Dtype &costOUT) {
-
+    RAI_TRACE_SCOPE("env step");
+    steps_++;
 
     //Get current state from q_, u_
     orientation = q_.head(4); //Orientation of quadrotor
@@ -127,18 +139,20 @@ class QuadrotorControl : public Task<Dtype,
     fbTorque_b(2) = fbTorque_b(2) * 0.15; //Lower yaw gains
 
     B_torque += fbTorque_b; //Sum of torque inputs
-    B_force(2) += mass_ * 9.81; //Sum of thrust inputs
+    B_force(2) += params_.mass * 9.81; //Sum of thrust inputs
 
     // clip inputs
     Action genForce;
     genForce << B_torque, B_force(2);
     Action thrust = transsThrust2GenForceInv * genForce;    // TODO: This is not exactly thrust: change name
+    uint64_t saturated = 0; // rotors held at their minimum thrust
+    for (int i = 0; i < 4; i++) saturated |= uint64_t(thrust(i) < 1e-8) << i;
     thrust = thrust.array().cwiseMax(1e-8); // clip for min value
     genForce = transsThrust2GenForce * thrust;
     B_torque = genForce.segment(0, 3);
     B_force(2) = genForce(3);
 
-    du_.tail(3) = (R_ * B_force) / mass_ + gravity_; // acceleration
+    du_.tail(3) = (R_ * B_force) / params_.mass + gravity_; // acceleration
 //  w_B_ = R_.transpose() * u_.head(3); //body rates // TODO: u_.head(3) = w_I_
 
     du_.head(3) = R_ * (inertiaInv_ * (B_torque - w_B_.cross(inertia_ * w_B_))); //acceleration by inputs
@@ -171,7 +185,7 @@ class QuadrotorControl : public Task<Dtype,
     u_(4) = clip(u_(4), -5.0, 5.0);
     u_(5) = clip(u_(5), -5.0, 5.0);
 
-    getState(state_tp1);
+    buildState(state_tp1);
 
 //    costOUT = 0.004 * q_.tail(3).norm() +
 //        0.0002 * action_t.norm() +
@@ -182,12 +196,15 @@ class QuadrotorControl : public Task<Dtype,
         0.00005 * action_t.norm() +
         0.00005 * u_.head(3).norm() +
         0.00005 * u_.tail(3).norm();
+    episodeStatistics_.step(costOUT, saturated);
 
 
 //    std::cout << "distance cost " << 0.004 * q_.tail(3).squaredNorm() << std::endl;
 //    std::cout << "actuation cost " << 0.0002 * action_t.squaredNorm() << std::endl;
 //    std::cout << "angular velocity cost " << 0.0003 * u_.head(3).squaredNorm() << std::endl;
 //    std::cout << "orientation cost " << 0.0005 * acos(q_(0)) * acos(q_(0)) << std::endl;
+    normalizer_.apply(state_tp1);
+
 //    if (this->isViolatingBoxConstraint(state_tp1))
 //      termType = TerminationType::timeout;
 
@@ -195,10 +212,14 @@ class QuadrotorControl : public Task<Dtype,
     if (this->visualization_ON_) {
 
       updateVisualizationFrames();
-      visualizer_.drawWorld(visualizeFrame, position, orientation);
-      double waitTime = std::max(0.0, this->controlUpdate_dt_ / realTimeRatio - watch.measure("sim", true));
-      watch.start("sim");
-      usleep(waitTime * 1e6);
+      if (headless_) {
+        offscreenVisualizer().drawWorld(visualizeFrame, position, orientation);
+      } else {
+        visualizer().drawWorld(visualizeFrame, position, orientation);
+        double waitTime = std::max(0.0, this->controlUpdate_dt_ / realTimeRatio - watch.measure("sim", true));
+        watch.start("sim");
+        usleep(waitTime * 1e6);
+      }
 
     }
   }
@@ -223,11 +244,11 @@ class QuadrotorControl : public Task<Dtype,
 //    std::cout<<"proportioanl part "<< kp_rot * angle * ( R_.transpose() * orientation.tail(3) ) / std::sin(angle) <<std::endl;
 //    std::cout<<"diff part "<< kd_rot * ( R_.transpose() * u_.head(3) ) <<std::endl;
 
-    du_.tail(3) = (R_ * B_force) / mass_ + gravity_;
+    du_.tail(3) = (R_ * B_force) / params_.mass + gravity_;
     w_B_ = R_.transpose() * u_.head(3);
 
     /// compute in body coordinate and transform it to world coordinate
-//    B_torque += comLocation_.cross(mass_ * R_.transpose() * gravity_);
+//    B_torque += comLocation_.cross(params_.mass * R_.transpose() * gravity_);
     du_.head(3) = R_ * (inertiaInv_ * (B_torque - w_B_.cross(inertia_ * w_B_)));
 
     u_ += du_ * this->controlUpdate_dt_;
@@ -253,10 +274,14 @@ class QuadrotorControl : public Task<Dtype,
     if (this->visualization_ON_) {
 
       updateVisualizationFrames();
-      visualizer_.drawWorld(visualizeFrame, position, orientation);
-      double waitTime = std::max(0.0, this->controlUpdate_dt_ / realTimeRatio - watch.measure("sim", true));
-      watch.start("sim");
-      usleep(waitTime * 1e6);
+      if (headless_) {
+        offscreenVisualizer().drawWorld(visualizeFrame, position, orientation);
+      } else {
+        visualizer().drawWorld(visualizeFrame, position, orientation);
+        double waitTime = std::max(0.0, this->controlUpdate_dt_ / realTimeRatio - watch.measure("sim", true));
+        watch.start("sim");
+        usleep(waitTime * 1e6);
+      }
 
     }
 
@@ -272,6 +297,10 @@ class QuadrotorControl : public Task<Dtype,
   bool isTerminalState(State &state) { return false; }
 
   void init() {
+    restartEpisode();
+    steps_ = 0;
+    randomizeParameters();
+
     /// initial state is random
     double oriF[4], posiF[3], angVelF[3], linVelF[3];
     rn_.template sampleOnUnitSphere<4>(oriF);
@@ -295,6 +324,50 @@ class QuadrotorControl : public Task<Dtype,
 //    visualizer_.reinitialize();
   }
 
+  /// takes effect immediately. The thrust mapping is only rebuilt if the rotor geometry changed
+  void setPhysicalParameters(const PhysicalParameters &parameters) {
+    const bool rotorsChanged = !parameters.sameRotorGeometry(params_);
+    params_ = parameters;
+    updateParameters(rotorsChanged);
+  }
+
+  const PhysicalParameters &physicalParameters() const { return params_; }
+
+  /// running observation normalization applied by getState, disabled by default
+  ObservationNormalizer<Dtype, StateDim> &observationNormalizer() { return normalizer_; }
+
+  /// every episode this task runs, test episodes included. The rotors are the actuators
+  Metrics::EpisodeStatistics &episodeStatistics() { return episodeStatistics_; }
+
+  /// the episode so far as plain data, restoreState continues it exactly on any task of this type
+  void saveState(Snapshot &snapshot) const {
+    snapshot.coordinate() = q_;
+    snapshot.velocity() = u_;
+    snapshot.acceleration() = du_;
+    snapshot.parameters = params_;
+    snapshot.rng = parameterRng_;
+    snapshot.rngSeeded = parameterRngSeeded_;
+    snapshot.steps = steps_;
+  }
+
+  void restoreState(const Snapshot &snapshot) {
+    q_ = snapshot.coordinate();
+    u_ = snapshot.velocity();
+    du_ = snapshot.acceleration();
+    setPhysicalParameters(snapshot.parameters);
+    parameterRng_ = snapshot.rng;
+    parameterRngSeeded_ = snapshot.rngSeeded;
+    steps_ = snapshot.steps;
+  }
+
+  /// control steps since the episode started
+  long episodeSteps() const { return steps_; }
+
+  /// resamples the parameters at every init(), a zero spread keeps them fixed
+  void setParameterRandomization(const ParameterRandomization &randomization) {
+    randomization_ = randomization;
+  }
+
   void translate(Position& position) {
     q_.segment(4,3) += position;
   }
@@ -309,18 +382,27 @@ class QuadrotorControl : public Task<Dtype,
   }
 
   void initTo(const State &state) {
-    State stateT = state;
+    restartEpisode();
+    const State stateT = normalizer_.restore(state);
     R_.col(0) = stateT.segment(0, 3);
     R_.col(1) = stateT.segment(3, 3);
     R_.col(2) = stateT.segment(6, 3);
     orientation = Math::MathFunc::rotMatToQuat(R_);
     q_.head(4) = orientation;
-    q_.tail(3) = state.segment(9, 3) / positionScale_;
-    u_.head(3) = state.segment(12, 3) / angVelScale_;
-    u_.tail(3) = state.segment(15, 3) / linVelScale_;
+    q_.tail(3) = stateT.segment(9, 3) / positionScale_;
+    u_.head(3) = stateT.segment(12, 3) / angVelScale_;
+    u_.tail(3) = stateT.segment(15, 3) / linVelScale_;
+    steps_ = 0;
   }
 
+  /// the state of the simulation, normalized if observationNormalizer() is enabled
   void getState(State &state) {
+    buildState(state);
+    normalizer_.apply(state);
+  }
+
+  /// the state before normalization, the box constraints apply to it
+  void buildState(State &state) {
     LOG_IF(FATAL, std::isnan(q_.head(4).norm())) << "simulation unstable";
     orientation = q_.head(4);
     Math::MathFunc::normalizeQuat(orientation);
@@ -362,15 +444,57 @@ class QuadrotorControl : public Task<Dtype,
 
   void startRecordingVideo(std::string dir, std::string fileName) {
     mkdir(dir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
-    visualizer_.getGraphics()->savingSnapshots(dir, fileName);
+    if (headless_)
+      offscreenVisualizer().startRecording(dir, fileName, this->controlUpdate_dt_);
+    else
+      visualizer().getGraphics()->savingSnapshots(dir, fileName);
   }
 
   void endRecordingVideo() {
-    visualizer_.getGraphics()->images2Video();
+    if (headless_)
+      offscreenVisualizer().endRecording();
+    else
+      visualizer().getGraphics()->images2Video();
   }
 
+  /// renders offscreen into the recorded video and steps without real-time pacing, for hosts
+  /// without a display. Defaults to Render::headlessByDefault()
+  void setHeadless(bool headless) { headless_ = headless; }
+  bool isHeadless() const { return headless_; }
+
  private:
 
+  void updateParameters(bool rotorsChanged) {
+    const Eigen::Map<const Eigen::Vector3d> diagonalInertia(params_.inertia);
+    inertia_ = diagonalInertia.asDiagonal();
+    inertiaInv_ = diagonalInertia.cwiseInverse().asDiagonal();
+    if (!rotorsChanged) return;
+
+    const double length = params_.armLength, dragCoeff = params_.dragCoeff;
+    transsThrust2GenForce << 0, 0, length, -length,
+        -length, length, 0, 0,
+        dragCoeff, dragCoeff, -dragCoeff, -dragCoeff,
+        1, 1, 1, 1;
+    transsThrust2GenForceInv = transsThrust2GenForce.inverse();
+  }
+
+  void randomizeParameters() {
+    if (!randomization_.enabled()) return;
+    /// seeded on first use, so tasks copied from one prototype draw different parameters
+    if (!parameterRngSeeded_) {
+      parameterRng_.seed(std::random_device()());
+      parameterRngSeeded_ = true;
+    }
+    PhysicalParameters parameters;
+    randomization_.sample(parameterRng_, parameters);
+    setPhysicalParameters(parameters);
+  }
+
+  /// ends the running episode of episodeStatistics(), a timeout if it ran for the whole time limit
+  void restartEpisode() {
+    episodeStatistics_.restart(q_.tail(3).norm(),
+                               steps_ * this->controlUpdate_dt_ >= this->timeLimit_ - 0.5 * this->controlUpdate_dt_);
+  }
 
   void updateVisualizationFrames() {
 
@@ -399,10 +523,14 @@ class QuadrotorControl : public Task<Dtype,
   double orientationScale_, positionScale_, angVelScale_, linVelScale_;
   double actionScale_;
   /// robot parameters
-  double length_ = 0.17;
+  PhysicalParameters params_;
+  ObservationNormalizer<Dtype, StateDim> normalizer_;
+  Metrics::EpisodeStatistics episodeStatistics_{StateDim, ActionDim};
+  ParameterRandomization randomization_;
+  std::mt19937_64 parameterRng_;
+  bool parameterRngSeeded_ = false;
+  long steps_ = 0;
   Position comLocation_;
-  double dragCoeff_ = 0.016;
-  double mass_ = 0.665;
   Inertia inertia_;
   Inertia inertiaInv_;
   Quaternion orientation;
@@ -426,7 +554,16 @@ class QuadrotorControl : public Task<Dtype,
   //Visualization
   StopWatch watch;
   double realTimeRatio = 1;
-  static rai::Vis::Quadrotor_Visualizer visualizer_;
+  bool headless_ = Render::headlessByDefault();
+  /// constructed on first use, a task that never visualizes opens no window and no EGL context
+  static rai::Vis::Quadrotor_Visualizer &visualizer() {
+    static rai::Vis::Quadrotor_Visualizer visualizer;
+    return visualizer;
+  }
+  static rai::Vis::Quadrotor_OffscreenVisualizer &offscreenVisualizer() {
+    static rai::Vis::Quadrotor_OffscreenVisualizer visualizer;
+    return visualizer;
+  }
 
   HomogeneousTransform visualizeFrame;
 
@@ -435,6 +572,4 @@ class QuadrotorControl : public Task<Dtype,
 } /// namespaces
 template<typename Dtype>
 rai::Position rai::Task::QuadrotorControl<Dtype>::targetPosition;
-template<typename Dtype>
-rai::Vis::Quadrotor_Visualizer rai::Task::QuadrotorControl<Dtype>::visualizer_;
 //#endif //RAI_QUADROTORCONTROL_HPP
\ No newline at end of file
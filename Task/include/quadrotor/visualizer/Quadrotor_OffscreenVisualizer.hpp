@@ -0,0 +1,65 @@
+#pragma once
+
+#include "raiCommon/math/RAI_math.hpp"
+#include "render/Headless.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#ifdef RAI_OFFSCREEN
+#include "render/OffscreenRenderer.hpp"
+#include "render/VideoRecorder.hpp"
+#else
+#include <glog/logging.h>
+#endif
+
+namespace rai {
+namespace Vis {
+
+#ifdef RAI_OFFSCREEN
+/// the scene of Quadrotor_Visualizer without a window, for hosts without a display.
+/// drawWorld only renders the frames of a recorded video and never waits, a rollout is recorded as fast as it steps
+class Quadrotor_OffscreenVisualizer {
+
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  /// frames of the size of the on-screen window
+  explicit Quadrotor_OffscreenVisualizer(int width = 600, int height = 450);
+
+  void drawWorld(HomogeneousTransform &visualizationPose, rai::Position &quadPos, rai::Quaternion &quadAtt);
+
+  /// records dir/fileName.mp4 of a task stepping every dt. Every few steps are one frame, so the video has
+  /// about fps frames per simulated second, and it plays in real time
+  void startRecording(const std::string &dir, const std::string &fileName, double dt, double fps = 30.0);
+  void endRecording();
+  bool recording() const { return bool(video_); }
+
+  /// the last frame, rgb rows from the top
+  const std::vector<unsigned char> &frame() const { return frame_; }
+  rai::Render::OffscreenRenderer &getRenderer() { return renderer_; }
+
+ private:
+  rai::Render::OffscreenRenderer renderer_;
+  std::unique_ptr<rai::Render::VideoRecorder> video_;
+  int stepsPerFrame_ = 1;
+  long steps_ = 0;
+  std::vector<unsigned char> frame_;
+};
+#else
+/// a build without EGL has no offscreen rendering, a headless task draws and records nothing
+class Quadrotor_OffscreenVisualizer {
+
+ public:
+  explicit Quadrotor_OffscreenVisualizer(int width = 600, int height = 450) {}
+
+  void drawWorld(HomogeneousTransform &, rai::Position &, rai::Quaternion &) {}
+
+  void startRecording(const std::string &dir, const std::string &fileName, double dt, double fps = 30.0) {
+    LOG(WARNING) << "built without EGL, not recording " << dir << "/" << fileName << " on a host without a display";
+  }
+  void endRecording() {}
+  bool recording() const { return false; }
+};
+#endif
+
+}
+}
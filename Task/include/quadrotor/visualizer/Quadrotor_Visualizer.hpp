@@ -1,4 +1,6 @@
 
+#pragma once
+
 #include "raiCommon/math/RAI_math.hpp"
 #include "raiGraphics/RAI_graphics.hpp"
 #include "raiGraphics/obj/Mesh.hpp"
@@ -0,0 +1,135 @@
+//
+// Kalman filter for the load of a slung-load quadrotor, run from the states
+// the quadrotor measures itself. The quadrotor acceleration minus what its
+// thrust and gravity explain is the tether pull. That pull drives the load
+// (a_load = g - pull / loadMass), and while the tether is taut its direction
+// gives the load offset, tetherLength * pull / |pull|. With the offset and
+// the load velocity as the state, the model is linear. Its three axes share
+// one 2 x 2 covariance, so an env's filter is a few scalars.
+// Envs columns hold independent filters. Every operation works on whole rows,
+// so a batch vectorizes across envs; Envs = 1 keeps a task's filter on the stack.
+//
+
+#ifndef RAI_SLUNGLOAD_LOADESTIMATOR_HPP
+#define RAI_SLUNGLOAD_LOADESTIMATOR_HPP
+
+#include <Eigen/Core>
+
+namespace rai {
+namespace Task {
+
+struct LoadEstimatorNoise {
+  double acceleration = 2.0;   // stdev of the unmodelled load acceleration, m/s^2
+  double direction = 0.05;     // stdev of the measured offset per axis while taut, m
+  double initialVelocity = 1.0;
+};
+
+template<int Envs = 1>
+class LoadEstimator {
+ public:
+  using Rows3 = Eigen::Array<double, 3, Envs>;
+  using Row = Eigen::Array<double, 1, Envs>;
+
+  explicit LoadEstimator(int nEnvs = Envs, const LoadEstimatorNoise &noise = LoadEstimatorNoise()) :
+      offset_(3, nEnvs), velocity_(3, nEnvs), pOffset_(1, nEnvs), pCross_(1, nEnvs), pVelocity_(1, nEnvs),
+      noise_(noise) {
+    offset_.setZero();
+    velocity_.setZero();
+    pOffset_.setZero();
+    pCross_.setZero();
+    pVelocity_.setZero();
+  }
+
+  void setNoise(const LoadEstimatorNoise &noise) { noise_ = noise; }
+
+  /// load offset from the quadrotor and load velocity of env, both in the world frame
+  template<typename Offset, typename Velocity>
+  void reset(int env, const Offset &offset, const Velocity &velocity) {
+    offset_.col(env) = offset;
+    velocity_.col(env) = velocity;
+    pOffset_(env) = noise_.direction * noise_.direction;
+    pCross_(env) = 0.0;
+    pVelocity_(env) = noise_.initialVelocity * noise_.initialVelocity;
+  }
+
+  /// one control step. quadVelocity is before the step, quadVelocityNext after it, and
+  /// thrustAcceleration = R f / mass the commanded thrust the step applied
+  void step(const Rows3 &quadVelocity, const Rows3 &quadVelocityNext, const Rows3 &thrustAcceleration,
+            double dt, double loadMass, double tetherLength) {
+    Rows3 pull = (quadVelocityNext - quadVelocity) / dt - thrustAcceleration;
+    pull.row(2) += 9.81;
+
+    /// predict, the load follows gravity and the pull
+    velocity_ -= pull * (dt / loadMass);
+    velocity_.row(2) -= 9.81 * dt;
+    offset_ += (velocity_ - quadVelocityNext) * dt;
+
+    const double q = noise_.acceleration * noise_.acceleration * dt * dt;
+    pOffset_ += 2.0 * dt * pCross_ + dt * dt * pVelocity_ + 0.25 * q * dt * dt;
+    pCross_ += dt * pVelocity_ + 0.5 * q * dt;
+    pVelocity_ += q;
+
+    /// update with the tether direction where it pulls, the gain is zero where it is slack
+    const Row pullNorm = pull.matrix().colwise().norm().array();
+    const Row taut = (pullNorm > 1e-6).template cast<double>();
+    const double r = noise_.direction * noise_.direction;
+    const Row gainOffset = taut * pOffset_ / (pOffset_ + r);
+    const Row gainVelocity = taut * pCross_ / (pOffset_ + r);
+    const Row scale = tetherLength / pullNorm.max(1e-6);
+    for (int a = 0; a < 3; a++) {
+      const Row innovation = pull.row(a) * scale - offset_.row(a);
+      offset_.row(a) += gainOffset * innovation;
+      velocity_.row(a) += gainVelocity * innovation;
+    }
+    pVelocity_ -= gainVelocity * pCross_;
+    pCross_ *= 1.0 - gainOffset;
+    pOffset_ *= 1.0 - gainOffset;
+
+    /// the load is never farther than the tether
+    const Row length = offset_.matrix().colwise().norm().array();
+    offset_.rowwise() *= (tetherLength / length.max(1e-9)).min(1.0);
+  }
+
+  /// offset, velocity and the three covariance entries of every env, e.g. for a task snapshot
+  enum { SnapshotSize = Envs == Eigen::Dynamic ? Eigen::Dynamic : 9 * Envs };
+
+  void save(double *out) const {
+    const long n = offset_.cols();
+    Eigen::Map<Rows3>(out, 3, n) = offset_;
+    Eigen::Map<Rows3>(out + 3 * n, 3, n) = velocity_;
+    Eigen::Map<Row>(out + 6 * n, 1, n) = pOffset_;
+    Eigen::Map<Row>(out + 7 * n, 1, n) = pCross_;
+    Eigen::Map<Row>(out + 8 * n, 1, n) = pVelocity_;
+  }
+
+  void load(const double *in) {
+    const long n = offset_.cols();
+    offset_ = Eigen::Map<const Rows3>(in, 3, n);
+    velocity_ = Eigen::Map<const Rows3>(in + 3 * n, 3, n);
+    pOffset_ = Eigen::Map<const Row>(in + 6 * n, 1, n);
+    pCross_ = Eigen::Map<const Row>(in + 7 * n, 1, n);
+    pVelocity_ = Eigen::Map<const Row>(in + 8 * n, 1, n);
+  }
+
+  const Rows3 &offset() const { return offset_; }
+  const Rows3 &velocity() const { return velocity_; }
+
+  /// unit offset of each env, straight down for a load on the quadrotor
+  Rows3 direction() const {
+    const Row length = offset_.matrix().colwise().norm().array();
+    Rows3 direction = offset_;
+    direction.rowwise() /= length.max(1e-9);
+    direction.row(2) -= (length <= 1e-9).template cast<double>();
+    return direction;
+  }
+
+ private:
+  Rows3 offset_, velocity_;
+  Row pOffset_, pCross_, pVelocity_;
+  LoadEstimatorNoise noise_;
+};
+
+}
+}
+
+#endif //RAI_SLUNGLOAD_LOADESTIMATOR_HPP
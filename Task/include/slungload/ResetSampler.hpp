@@ -0,0 +1,85 @@
+//
+// Random initial states of the slungload tasks, a batch at a time. Column i
+// holds q (quaternion, quadrotor position, load position) followed by
+// u (angular, linear and load velocity), with the same distribution as
+// init() used to draw one state at a time. The load lies in the lower half of
+// a ball of radius tetherLength around the quadrotor, in the body frame.
+//
+
+#ifndef RAI_SLUNGLOAD_RESETSAMPLER_HPP
+#define RAI_SLUNGLOAD_RESETSAMPLER_HPP
+
+#include <Eigen/Core>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include "raiCommon/utils/RandomNumberGenerator.hpp"
+#include "common/ResetPool.hpp"
+
+namespace rai {
+namespace Task {
+
+enum { SlungloadResetDim = 19 };
+
+/// the load is kept at least this fraction of the tether away, so getState never divides by a zero length
+constexpr double slungloadMinLoadDistance = 1e-3;
+
+template<typename Batch>
+void sampleSlungloadResets(std::mt19937_64 &rng, Batch &batch, double tetherLength) {
+  using Array = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+  const Eigen::Index n = batch.cols();
+  std::normal_distribution<double> normal;
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0), unit(0.0, 1.0);
+
+  /// the random numbers are drawn first, the rest works on whole rows
+  Array quat(4, n), loadDir(3, n), loadRadius(1, n), uniforms(12, n);
+  for (Eigen::Index i = 0; i < quat.size(); i++) quat.data()[i] = normal(rng);
+  for (Eigen::Index i = 0; i < loadDir.size(); i++) loadDir.data()[i] = normal(rng);
+  for (Eigen::Index i = 0; i < n; i++) loadRadius(0, i) = unit(rng);
+  for (Eigen::Index i = 0; i < uniforms.size(); i++) uniforms.data()[i] = uniform(rng);
+
+  /// orientation on the unit sphere, scalar part positive
+  quat.row(0) = quat.row(0).abs();
+  quat.rowwise() /= quat.matrix().colwise().norm().array();
+
+  /// uniform in the ball: a random direction and a cube-root radius
+  loadRadius = loadRadius.pow(1.0 / 3.0).max(slungloadMinLoadDistance) * tetherLength;
+  loadDir.rowwise() *= loadRadius.row(0) / loadDir.matrix().colwise().norm().array();
+  loadDir.row(2) = -loadDir.row(2).abs();
+
+  /// load offset in the world frame, v + 2w(r x v) + 2r x (r x v) for the quaternion (w, r)
+  auto w = quat.row(0), x = quat.row(1), y = quat.row(2), z = quat.row(3);
+  auto vx = loadDir.row(0), vy = loadDir.row(1), vz = loadDir.row(2);
+  Array t(3, n);
+  t.row(0) = 2.0 * (y * vz - z * vy);
+  t.row(1) = 2.0 * (z * vx - x * vz);
+  t.row(2) = 2.0 * (x * vy - y * vx);
+
+  auto position = 2.0 * uniforms.topRows(3);
+  batch.template topRows<4>() = quat.matrix();
+  batch.template middleRows<3>(4) = position.matrix();
+  batch.row(7) = (position.row(0) + vx + w * t.row(0) + y * t.row(2) - z * t.row(1)).matrix();
+  batch.row(8) = (position.row(1) + vy + w * t.row(1) + z * t.row(0) - x * t.row(2)).matrix();
+  batch.row(9) = (position.row(2) + vz + w * t.row(2) + x * t.row(1) - y * t.row(0)).matrix();
+  batch.template bottomRows<9>() = uniforms.bottomRows(9).matrix();
+}
+
+/// the pool every slungload task of the process draws from unless setResetPool gives it another one.
+/// Created on first use with a single filler thread, seeded from RAI's generator, so seeding
+/// rai::RandomNumberGenerator before the first reset fixes the initial states as well
+inline std::shared_ptr<ResetPool<SlungloadResetDim> > slungloadResetPool() {
+  static std::shared_ptr<ResetPool<SlungloadResetDim> > pool = [] {
+    RandomNumberGenerator<double> generator;
+    const uint64_t seed = uint64_t(0.5 * (generator.sampleUniform() + 1.0) * 9007199254740992.0);
+    return std::make_shared<ResetPool<SlungloadResetDim> >(
+        [](std::mt19937_64 &rng, ResetPool<SlungloadResetDim>::Batch &batch) {
+          sampleSlungloadResets(rng, batch, 1.0);
+        }, 1024, 4, seed);
+  }();
+  return pool;
+}
+
+}
+}
+
+#endif //RAI_SLUNGLOAD_RESETSAMPLER_HPP
@@ -0,0 +1,541 @@
+//
+// K quadrotors carrying one load through K tethers, controlled centrally.
+// Every per-agent quantity is a 3 x K (or 4 x K, 9 x K) row major array, one
+// column per quadrotor, so the step is a fixed sequence of row operations
+// over all agents: its cost grows linearly with K and the rows vectorize.
+// The state is per agent R (9), position (3), angular and linear velocity
+// (3 each), followed by load position and velocity: StateDim = 18 K + 6.
+// The action is four rotor commands per agent: ActionDim = 4 K.
+//
+
+#ifndef RAI_MULTISLUNGLOADCONTROL_HPP
+#define RAI_MULTISLUNGLOADCONTROL_HPP
+
+#include <omp.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "rai/tasks/common/Task.hpp"
+#include "raiCommon/enumeration.hpp"
+#include "raiCommon/TypeDef.hpp"
+#include "raiCommon/math/RAI_math.hpp"
+#include <rai/RAI_core>
+#include "raiCommon/utils/StopWatch.hpp"
+#include "slungload/visualizer/slungload_Visualizer.hpp"
+#include "slungload/visualizer/slungload_OffscreenVisualizer.hpp"
+#include "trace/Trace.hpp"
+#include "metrics/EpisodeStatistics.hpp"
+#include "common/TaskTraits.hpp"
+#include "common/PhysicalParameters.hpp"
+#include "common/ObservationNormalizer.hpp"
+#include "common/TaskSnapshot.hpp"
+
+namespace rai {
+namespace Task {
+
+template<typename Dtype, int K>
+class multiSlungloadControl : public Task<Dtype, 18 * K + 6, 4 * K, 0> {
+  static_assert(K >= 2, "use slungloadControl for a single quadrotor");
+
+ public:
+  enum { Agents = K, StateDim = 18 * K + 6, ActionDim = 4 * K, CommandDim = 0 };
+
+  using TaskBase = Task<Dtype, StateDim, ActionDim, CommandDim>;
+  using State = typename TaskBase::State;
+  using StateBatch = typename TaskBase::StateBatch;
+  using Action = typename TaskBase::Action;
+  using ActionBatch = typename TaskBase::ActionBatch;
+  using CostBatch = Eigen::Matrix<Dtype, 1, Eigen::Dynamic>;
+  using MatrixJacobian = typename TaskBase::JacobianStateResAct;
+  using MatrixJacobianCostResAct = typename TaskBase::JacobianCostResAct;
+
+  /// row r holds component r of every agent
+  template<int Rows>
+  using AgentArray = Eigen::Array<double, Rows, K, Eigen::RowMajor>;
+  using AgentRow = Eigen::Array<double, 1, K>;
+  /// q: quaternions, positions, load position; u: angular velocities, velocities, load velocity
+  using Snapshot = TaskSnapshot<7 * K + 3, 6 * K + 3>;
+
+  multiSlungloadControl() {
+
+    //// set default parameters
+    this->valueAtTermination_ = 1.5;
+    this->discountFactor_ = 0.99;
+    this->timeLimit_ = 15.0;
+    this->controlUpdate_dt_ = 0.01;
+    gravity_ << 0.0, 0.0, -9.81;
+
+    updateParameters(true);
+
+    /////// scale //////
+    actionScale_ = 2.0;
+    positionScale_ = 0.5;
+    angVelScale_ = 0.15;
+    linVelScale_ = 0.5;
+
+    /////// adding constraints////////////////////
+    State upperStateBound;
+    for (int i = 0; i < K; i++)
+      upperStateBound.template segment<18>(18 * i) << 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, //Rotation Matrix
+          3.0, 3.0, 3.0, //Quad Position
+          5.0, 5.0, 5.0, //Quad Angular Velocity
+          6.0, 6.0, 6.0; //Quad Linear Velocity
+    upperStateBound.template tail<6>() << 3.0, 3.0, 3.0, //Load Position
+        6.0, 6.0, 6.0; //Load Velocity
+    this->setBoxConstraints(-upperStateBound, upperStateBound);
+    episodeStatistics_.setBounds(State(-upperStateBound), upperStateBound);
+  }
+
+  void step(const Action &action_t,
+            State &state_tp1,
+            TerminationType &termType,
+            Dtype &costOUT) {
+    RAI_TRACE_SCOPE("env step");
+    steps_++;
+    const double dt = this->controlUpdate_dt_;
+    const Eigen::Matrix<double, 4, K> action = Eigen::Map<const Eigen::Matrix<Dtype, 4, K> >(action_t.data())
+        .template cast<double>();
+
+    updateRotations();
+    /// body rates w_B = R^T w_I
+    AgentArray<3> wB;
+    for (int c = 0; c < 3; c++)
+      wB.row(c) = rot_.row(c) * angVel_.row(0) + rot_.row(3 + c) * angVel_.row(1) + rot_.row(6 + c) * angVel_.row(2);
+
+    //Control input from action, one column per agent
+    Eigen::Matrix<double, 4, K> genForce = transsThrust2GenForce * (actionScale_ * action);
+
+    //Control input from PD stabilization
+    const double kp_rot = -0.2, kd_rot = -0.06;
+    const AgentRow angle = 2.0 * quat_.row(0).min(1.0).max(-1.0).acos();
+    const AgentRow gain = (angle > 1e-6).select(kp_rot * angle / angle.sin(), 0.0);
+    for (int c = 0; c < 3; c++) {
+      /// (R^T q_vec)_c
+      const AgentRow qBody = rot_.row(c) * quat_.row(1) + rot_.row(3 + c) * quat_.row(2) + rot_.row(6 + c) * quat_.row(3);
+      const double yawGain = c == 2 ? 0.15 : 1.0; //Lower yaw gains
+      genForce.row(c).array() += yawGain * (gain * qBody + kd_rot * wB.row(c));
+    }
+    genForce.row(3).array() += params_.mass * 9.81; //Sum of thrust inputs
+
+    // clip inputs
+    Eigen::Matrix<double, 4, K> thrust = transsThrust2GenForceInv * genForce;
+    uint64_t saturated = 0; // rotors held at their minimum thrust, in the order of the action
+    for (int i = 0; i < 4 * K; i++) saturated |= uint64_t(thrust.data()[i] < 1e-8) << i;
+    thrust = thrust.cwiseMax(1e-8);
+    genForce = transsThrust2GenForce * thrust;
+
+    // tethers, a taut tether shares the load's weight with the other taut ones
+    AgentArray<3> tether;
+    for (int r = 0; r < 3; r++) tether.row(r) = loadPosition_(r) - position_.row(r);
+    const AgentRow length = tether.matrix().colwise().norm().array();
+    const AgentRow taut = (length >= params_.tetherLength).template cast<double>();
+    const double nTaut = taut.sum();
+    const double tension = nTaut > 0 ? params_.loadMass * (gravity_ + loadAcceleration_).norm() / nTaut : 0.0;
+    const AgentRow tensionPerLength = taut * tension / length.max(1e-9);
+
+    // quadrotor accelerations, thrust along the body z axis
+    const double invMass = 1.0 / params_.mass;
+    for (int r = 0; r < 3; r++) {
+      const AgentRow acceleration = rot_.row(3 * r + 2) * genForce.row(3).array() * invMass + gravity_(r)
+          + tensionPerLength * tether.row(r) * invMass;
+      velocity_.row(r) += acceleration * dt;
+    }
+
+    // angular accelerations, diagonal inertia: I^-1 (tau - w_B x I w_B) in the body frame, then rotated to the world
+    const Eigen::Map<const Eigen::Vector3d> inertia(params_.inertia);
+    AgentArray<3> bodyAcc;
+    for (int c = 0; c < 3; c++) {
+      const int a = (c + 1) % 3, b = (c + 2) % 3;
+      bodyAcc.row(c) = (genForce.row(c).array() - (wB.row(a) * wB.row(b) * (inertia(b) - inertia(a))))
+          / inertia(c);
+    }
+    for (int r = 0; r < 3; r++)
+      angVel_.row(r) += (rot_.row(3 * r) * bodyAcc.row(0) + rot_.row(3 * r + 1) * bodyAcc.row(1)
+          + rot_.row(3 * r + 2) * bodyAcc.row(2)) * dt;
+
+    // load acceleration
+    Eigen::Vector3d pull;
+    for (int r = 0; r < 3; r++) pull(r) = (tensionPerLength * tether.row(r)).sum();
+    loadAcceleration_ = gravity_ - pull / params_.loadMass - 0.01 * loadVelocity_;
+    loadVelocity_ += loadAcceleration_ * dt;
+
+    //Integrate states
+    integrateOrientations(dt);
+    position_ += velocity_ * dt;
+    loadPosition_ += loadVelocity_ * dt;
+    enforceTethers();
+
+    angVel_ = angVel_.max(-20.0).min(20.0);
+    velocity_ = velocity_.max(-5.0).min(5.0);
+    loadVelocity_ = loadVelocity_.cwiseMax(-5.0).cwiseMin(5.0);
+
+    buildState(state_tp1);
+
+    if (this->isViolatingBoxConstraint(state_tp1))
+      termType = TerminationType::terminalState;
+    normalizer_.apply(state_tp1);
+
+    costOUT = 0.004 * std::sqrt(loadPosition_.norm()) +                        // load position
+        (0.00005 * action.colwise().norm().sum() +                              // action
+            0.00008 * angVel_.matrix().colwise().norm().sum() +                 // angular velocity
+            0.00005 * velocity_.matrix().colwise().norm().sum()) / K;           // linear velocity
+
+    episodeStatistics_.step(costOUT, saturated);
+    if (termType == TerminationType::terminalState) {
+      State unnormalized;
+      buildState(unnormalized);
+      episodeStatistics_.endTerminalState(unnormalized, loadPosition_.norm());
+    }
+
+    // visualization
+    if (this->visualization_ON_) {
+      visualizeFrame.setIdentity();
+      Eigen::Matrix<double, 3, Eigen::Dynamic> positions = position_.matrix();
+      Eigen::Matrix<double, 4, Eigen::Dynamic> orientations = quat_.matrix();
+      if (headless_) {
+        offscreenVisualizer().drawWorld(visualizeFrame, positions, orientations, loadPosition_);
+      } else {
+        visualizer().drawWorld(visualizeFrame, positions, orientations, loadPosition_);
+        double waitTime = std::max(0.0, this->controlUpdate_dt_ / realTimeRatio - watch.measure("sim", true));
+        watch.start("sim");
+        usleep(waitTime * 1e6);
+      }
+    }
+  }
+
+  /// steps every env with its column of actions, in parallel over the envs
+  static void stepBatch(const std::vector<multiSlungloadControl *> &envs,
+                        const ActionBatch &actions,
+                        StateBatch &nextStates,
+                        std::vector<TerminationType> &termTypes,
+                        CostBatch &costs) {
+    const int nEnvs = int(envs.size());
+    nextStates.resize(StateDim, nEnvs);
+    termTypes.assign(nEnvs, TerminationType::not_terminated);
+    costs.resize(nEnvs);
+
+#pragma omp parallel for schedule(static)
+    for (int e = 0; e < nEnvs; e++) {
+      State next;
+      Dtype cost;
+      envs[e]->step(actions.col(e), next, termTypes[e], cost);
+      nextStates.col(e) = next;
+      costs(e) = cost;
+    }
+  }
+
+  bool isTerminalState(State &state) { return false; }
+
+  /// load near the origin, the quadrotors spread around it on a ring above it
+  void init() {
+    restartEpisode();
+    steps_ = 0;
+    randomizeParameters();
+    seedGenerator();
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0), unit(0.0, 1.0);
+    std::normal_distribution<double> normal;
+
+    for (int r = 0; r < 3; r++) loadPosition_(r) = uniform(rng_);
+    loadVelocity_.setZero();
+    loadAcceleration_.setZero();
+
+    for (int i = 0; i < K; i++) {
+      const double azimuth = 2.0 * M_PI * (i + 0.25 * uniform(rng_)) / K;
+      const double elevation = M_PI / 6.0 + unit(rng_) * M_PI / 6.0;
+      const double distance = params_.tetherLength * (0.9 + 0.1 * unit(rng_));
+      position_(0, i) = loadPosition_(0) + distance * std::cos(elevation) * std::cos(azimuth);
+      position_(1, i) = loadPosition_(1) + distance * std::cos(elevation) * std::sin(azimuth);
+      position_(2, i) = loadPosition_(2) + distance * std::sin(elevation);
+
+      Quaternion orientation;
+      for (int r = 0; r < 4; r++) orientation(r) = normal(rng_);
+      orientation(0) = std::abs(orientation(0));
+      orientation.normalize();
+      quat_.col(i) = orientation;
+      for (int r = 0; r < 3; r++) {
+        angVel_(r, i) = uniform(rng_);
+        velocity_(r, i) = uniform(rng_);
+      }
+    }
+  }
+
+  void getInitialState(State &state) {
+    init();
+    getState(state);
+  }
+
+  void setInitialState(const State &in) {
+    LOG(FATAL) << "The initial state is random. No need to set it" << std::endl;
+  }
+
+  void initTo(const State &state) {
+    restartEpisode();
+    const Eigen::Matrix<double, StateDim, 1> s = normalizer_.restore(state).template cast<double>();
+    for (int i = 0; i < K; i++) {
+      const int offset = 18 * i;
+      RotationMatrix R;
+      R.col(0) = s.template segment<3>(offset);
+      R.col(1) = s.template segment<3>(offset + 3);
+      R.col(2) = s.template segment<3>(offset + 6);
+      quat_.col(i) = Math::MathFunc::rotMatToQuat(R);
+      position_.col(i) = s.template segment<3>(offset + 9) / positionScale_;
+      angVel_.col(i) = s.template segment<3>(offset + 12) / angVelScale_;
+      velocity_.col(i) = s.template segment<3>(offset + 15) / linVelScale_;
+    }
+    loadPosition_ = s.template segment<3>(18 * K) / positionScale_;
+    loadVelocity_ = s.template tail<3>() / linVelScale_;
+    loadAcceleration_.setZero();
+    steps_ = 0;
+  }
+
+  /// the state of the simulation, normalized if observationNormalizer() is enabled
+  void getState(State &state) {
+    buildState(state);
+    normalizer_.apply(state);
+  }
+
+  /// the state before normalization, the box constraints apply to it
+  void buildState(State &state) {
+    LOG_IF(FATAL, std::isnan(quat_.sum())) << "simulation unstable";
+    quat_.rowwise() /= quat_.matrix().colwise().norm().array();
+    updateRotations();
+
+    for (int i = 0; i < K; i++) {
+      const int offset = 18 * i;
+      /// rot_ rows are row major R entries, the state holds the columns of R
+      for (int c = 0; c < 3; c++)
+        for (int r = 0; r < 3; r++)
+          state(offset + 3 * c + r) = Dtype(rot_(3 * r + c, i));
+      state.template segment<3>(offset + 9) = (position_.col(i) * positionScale_).template cast<Dtype>();
+      state.template segment<3>(offset + 12) = (angVel_.col(i) * angVelScale_).template cast<Dtype>();
+      state.template segment<3>(offset + 15) = (velocity_.col(i) * linVelScale_).template cast<Dtype>();
+    }
+    state.template segment<3>(18 * K) = (loadPosition_ * positionScale_).template cast<Dtype>();
+    state.template tail<3>() = (loadVelocity_ * linVelScale_).template cast<Dtype>();
+  }
+
+  // Misc implementations
+  void getGradientStateResAct(const State &stateIN,
+                              const Action &actionIN,
+                              MatrixJacobian &gradientOUT) {
+    LOG(FATAL) << "To do!" << std::endl;
+  };
+
+  void getGradientCostResAct(const State &stateIN,
+                             const Action &actionIN,
+                             MatrixJacobianCostResAct &gradientOUT) {
+    LOG(FATAL) << "To do!" << std::endl;
+  }
+
+  /// takes effect immediately. The thrust mapping is only rebuilt if the rotor geometry changed
+  void setPhysicalParameters(const PhysicalParameters &parameters) {
+    const bool rotorsChanged = !parameters.sameRotorGeometry(params_);
+    params_ = parameters;
+    updateParameters(rotorsChanged);
+  }
+
+  const PhysicalParameters &physicalParameters() const { return params_; }
+
+  /// running observation normalization applied by getState, disabled by default
+  ObservationNormalizer<Dtype, StateDim> &observationNormalizer() { return normalizer_; }
+
+  /// every episode this task runs, test episodes included. The actuators are the rotors in the order of the action
+  Metrics::EpisodeStatistics &episodeStatistics() { return episodeStatistics_; }
+
+  /// the episode so far as plain data, restoreState continues it exactly on any task of this type
+  void saveState(Snapshot &snapshot) const {
+    Eigen::Map<AgentArray<4> >(snapshot.q) = quat_;
+    Eigen::Map<AgentArray<3> >(snapshot.q + 4 * K) = position_;
+    Eigen::Map<Eigen::Vector3d>(snapshot.q + 7 * K) = loadPosition_;
+    Eigen::Map<AgentArray<3> >(snapshot.u) = angVel_;
+    Eigen::Map<AgentArray<3> >(snapshot.u + 3 * K) = velocity_;
+    Eigen::Map<Eigen::Vector3d>(snapshot.u + 6 * K) = loadVelocity_;
+    /// the agents' accelerations are recomputed every step, only the load's carries over
+    snapshot.acceleration().setZero();
+    snapshot.acceleration().template tail<3>() = loadAcceleration_;
+    snapshot.parameters = params_;
+    snapshot.rng = rng_;
+    snapshot.rngSeeded = generatorSeeded_;
+    snapshot.steps = steps_;
+  }
+
+  void restoreState(const Snapshot &snapshot) {
+    quat_ = Eigen::Map<const AgentArray<4> >(snapshot.q);
+    position_ = Eigen::Map<const AgentArray<3> >(snapshot.q + 4 * K);
+    loadPosition_ = Eigen::Map<const Eigen::Vector3d>(snapshot.q + 7 * K);
+    angVel_ = Eigen::Map<const AgentArray<3> >(snapshot.u);
+    velocity_ = Eigen::Map<const AgentArray<3> >(snapshot.u + 3 * K);
+    loadVelocity_ = Eigen::Map<const Eigen::Vector3d>(snapshot.u + 6 * K);
+    loadAcceleration_ = snapshot.acceleration().template tail<3>();
+    setPhysicalParameters(snapshot.parameters);
+    rng_ = snapshot.rng;
+    generatorSeeded_ = snapshot.rngSeeded;
+    steps_ = snapshot.steps;
+  }
+
+  /// control steps since the episode started
+  long episodeSteps() const { return steps_; }
+
+  /// resamples the parameters at every init(), a zero spread keeps them fixed. All agents share them
+  void setParameterRandomization(const ParameterRandomization &randomization) {
+    randomization_ = randomization;
+  }
+
+  void getLoadPosition(Position &position) { position = loadPosition_; }
+
+  void startRecordingVideo(std::string dir, std::string fileName) {
+    mkdir(dir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    if (headless_)
+      offscreenVisualizer().startRecording(dir, fileName, this->controlUpdate_dt_);
+    else
+      visualizer().getGraphics()->savingSnapshots(dir, fileName);
+  }
+
+  void endRecordingVideo() {
+    if (headless_)
+      offscreenVisualizer().endRecording();
+    else
+      visualizer().getGraphics()->images2Video();
+  }
+
+  /// renders offscreen into the recorded video and steps without real-time pacing, for hosts
+  /// without a display. Defaults to Render::headlessByDefault()
+  void setHeadless(bool headless) { headless_ = headless; }
+  bool isHeadless() const { return headless_; }
+
+ private:
+
+  void updateParameters(bool rotorsChanged) {
+    if (!rotorsChanged) return;
+    const double length = params_.armLength, dragCoeff = params_.dragCoeff;
+    transsThrust2GenForce << 0, 0, length, -length,
+        -length, length, 0, 0,
+        dragCoeff, dragCoeff, -dragCoeff, -dragCoeff,
+        1, 1, 1, 1;
+    transsThrust2GenForceInv = transsThrust2GenForce.inverse();
+  }
+
+  void seedGenerator() {
+    /// seeded on first use, so tasks copied from one prototype differ
+    if (generatorSeeded_) return;
+    rng_.seed(std::random_device()());
+    generatorSeeded_ = true;
+  }
+
+  void randomizeParameters() {
+    if (!randomization_.enabled()) return;
+    seedGenerator();
+    PhysicalParameters parameters;
+    randomization_.sample(rng_, parameters);
+    setPhysicalParameters(parameters);
+  }
+
+  /// ends the running episode of episodeStatistics(), a timeout if it ran for the whole time limit
+  void restartEpisode() {
+    episodeStatistics_.restart(loadPosition_.norm(),
+                               steps_ * this->controlUpdate_dt_ >= this->timeLimit_ - 0.5 * this->controlUpdate_dt_);
+  }
+
+  /// rot_ row 3 r + c holds R(r, c) of every agent
+  void updateRotations() {
+    const auto w = quat_.row(0), x = quat_.row(1), y = quat_.row(2), z = quat_.row(3);
+    rot_.row(0) = 1.0 - 2.0 * (y * y + z * z);
+    rot_.row(1) = 2.0 * (x * y - w * z);
+    rot_.row(2) = 2.0 * (x * z + w * y);
+    rot_.row(3) = 2.0 * (x * y + w * z);
+    rot_.row(4) = 1.0 - 2.0 * (x * x + z * z);
+    rot_.row(5) = 2.0 * (y * z - w * x);
+    rot_.row(6) = 2.0 * (x * z - w * y);
+    rot_.row(7) = 2.0 * (y * z + w * x);
+    rot_.row(8) = 1.0 - 2.0 * (x * x + y * y);
+  }
+
+  /// q <- exp(w dt) * q, the rotation vector w dt is in the world frame
+  void integrateOrientations(double dt) {
+    const AgentRow angle = angVel_.matrix().colwise().norm().array() * dt;
+    const AgentRow half = 0.5 * angle;
+    /// sin(angle / 2) / |w|, with its limit dt / 2 for a resting agent
+    const AgentRow scale = (angle > 1e-12).select(half.sin() / angle * dt, 0.5 * dt);
+    const AgentRow dw = half.cos();
+    const AgentRow dx = scale * angVel_.row(0), dy = scale * angVel_.row(1), dz = scale * angVel_.row(2);
+    const AgentArray<4> q = quat_;
+    quat_.row(0) = dw * q.row(0) - dx * q.row(1) - dy * q.row(2) - dz * q.row(3);
+    quat_.row(1) = dw * q.row(1) + dx * q.row(0) + dy * q.row(3) - dz * q.row(2);
+    quat_.row(2) = dw * q.row(2) - dx * q.row(3) + dy * q.row(0) + dz * q.row(1);
+    quat_.row(3) = dw * q.row(3) + dx * q.row(2) - dy * q.row(1) + dz * q.row(0);
+    quat_.rowwise() /= quat_.matrix().colwise().norm().array();
+  }
+
+  /// pulls every overstretched tether back to its length and removes the velocity stretching it,
+  /// splitting both corrections by mass. Each sweep is O(K); a few Gauss-Seidel sweeps settle the
+  /// coupling of the tethers through the load
+  void enforceTethers() {
+    const double loadShare = params_.mass / (params_.mass + params_.loadMass);
+    for (int sweep = 0; sweep < tetherSweeps_; sweep++)
+      for (int i = 0; i < K; i++) {
+        const Eigen::Vector3d tether = loadPosition_ - position_.col(i).matrix();
+        const double length = tether.norm();
+        if (length <= params_.tetherLength) continue;
+        const Eigen::Vector3d direction = tether / length;
+        const Eigen::Vector3d correction = (length - params_.tetherLength) * direction;
+        loadPosition_ -= loadShare * correction;
+        position_.col(i) += ((1.0 - loadShare) * correction).array();
+
+        const double stretchRate = direction.dot(loadVelocity_ - velocity_.col(i).matrix());
+        if (stretchRate <= 0.0) continue;
+        loadVelocity_ -= loadShare * stretchRate * direction;
+        velocity_.col(i) += ((1.0 - loadShare) * stretchRate * direction).array();
+      }
+  }
+
+  AgentArray<4> quat_;
+  AgentArray<9> rot_;
+  AgentArray<3> position_, velocity_, angVel_;
+  Eigen::Vector3d loadPosition_, loadVelocity_, loadAcceleration_;
+  LinearAcceleration gravity_;
+
+  double positionScale_, angVelScale_, linVelScale_;
+  double actionScale_;
+  int tetherSweeps_ = 8;
+  /// robot parameters, shared by the agents
+  PhysicalParameters params_;
+  ObservationNormalizer<Dtype, StateDim> normalizer_;
+  Metrics::EpisodeStatistics episodeStatistics_{StateDim, ActionDim};
+  ParameterRandomization randomization_;
+  std::mt19937_64 rng_;
+  bool generatorSeeded_ = false;
+  long steps_ = 0;
+
+  Eigen::Matrix4d transsThrust2GenForce;
+  Eigen::Matrix4d transsThrust2GenForceInv;
+
+  //Visualization
+  StopWatch watch;
+  double realTimeRatio = 1;
+  bool headless_ = Render::headlessByDefault();
+  /// constructed on first use, a task that never visualizes opens no window and no EGL context
+  static rai::Vis::slungload_Visualizer &visualizer() {
+    static rai::Vis::slungload_Visualizer visualizer(K);
+    return visualizer;
+  }
+  static rai::Vis::slungload_OffscreenVisualizer &offscreenVisualizer() {
+    static rai::Vis::slungload_OffscreenVisualizer visualizer(K);
+    return visualizer;
+  }
+  HomogeneousTransform visualizeFrame;
+};
+
+/// four quadrotors, the team size registered with the task registry
+template<typename Dtype>
+class multiSlungloadControl4 : public multiSlungloadControl<Dtype, 4> {};
+
+template<>
+struct TaskTraits<multiSlungloadControl4> {
+  enum { StateDim = 18 * 4 + 6, ActionDim = 4 * 4, CommandDim = 0 };
+  static const char *name() { return "multi_slungload_4"; }
+};
+
+}
+} /// namespaces
+
+#endif //RAI_MULTISLUNGLOADCONTROL_HPP
@@ -0,0 +1,184 @@
+//
+// slungloadControl_partial with its load estimate appended to the state: the
+// estimated tether direction and load velocity of a LoadEstimator running on
+// the quadrotor states. A feed-forward policy gets the load velocity the
+// partial task leaves out without a recurrent network.
+//
+
+#ifndef RAI_SLUNGLOADCONTROL_ESTIMATOR_HPP
+#define RAI_SLUNGLOADCONTROL_ESTIMATOR_HPP
+
+#include "slungload/slungloadControl_partial.hpp"
+#include "common/ObservationNormalizer.hpp"
+
+namespace rai {
+namespace Task {
+
+template<typename Dtype>
+class slungloadControl_estimator;
+
+template<>
+struct TaskTraits<slungloadControl_estimator> {
+  enum { StateDim = 21 + 6, ActionDim = 4, CommandDim = 0 };
+  static const char *name() { return "slungload_estimator"; }
+};
+
+template<typename Dtype>
+class slungloadControl_estimator : public Task<Dtype,
+                                               TaskTraits<slungloadControl_estimator>::StateDim,
+                                               TaskTraits<slungloadControl_estimator>::ActionDim,
+                                               TaskTraits<slungloadControl_estimator>::CommandDim> {
+ public:
+  using PartialTask = slungloadControl_partial<Dtype>;
+
+  enum {
+    ObservationDim = PartialTask::StateDim,
+    StateDim = TaskTraits<slungloadControl_estimator>::StateDim,
+    ActionDim = PartialTask::ActionDim,
+    CommandDim = PartialTask::CommandDim
+  };
+
+  using TaskBase = Task<Dtype, StateDim, ActionDim, CommandDim>;
+  using State = typename TaskBase::State;
+  using StateBatch = typename TaskBase::StateBatch;
+  using Action = typename TaskBase::Action;
+  using ActionBatch = typename TaskBase::ActionBatch;
+  using Observation = typename PartialTask::State;
+  using Estimate = Eigen::Matrix<Dtype, 6, 1>;
+  using MatrixJacobian = typename TaskBase::JacobianStateResAct;
+  using MatrixJacobianCostResAct = typename TaskBase::JacobianCostResAct;
+  using ResetStatePool = typename PartialTask::ResetStatePool;
+  /// the partial task's, its load estimator is part of it
+  using Snapshot = typename PartialTask::Snapshot;
+
+  slungloadControl_estimator(const LoadEstimatorNoise &noise = LoadEstimatorNoise()) {
+
+    //// set default parameters
+    this->valueAtTermination_ = 1.5;
+    this->discountFactor_ = 0.99;
+    this->timeLimit_ = 15.0;
+    this->controlUpdate_dt_ = 0.01;
+
+    /////// adding constraints////////////////////
+    /// a unit direction and a load velocity within the partial task's linear velocity bound
+    State upperStateBound;
+    upperStateBound << PartialTask::stateBound(), 1.5, 1.5, 1.5, 6.0, 6.0, 6.0;
+    this->setBoxConstraints(-upperStateBound, upperStateBound);
+    task_.enableLoadEstimation(noise);
+  }
+
+  void step(const Action &action_t,
+            State &state_tp1,
+            TerminationType &termType,
+            Dtype &costOUT) {
+    syncSettings();
+    Observation observation;
+    task_.step(action_t, observation, termType, costOUT);
+    compose(observation, state_tp1);
+  }
+
+  bool isTerminalState(State &state) { return false; }
+
+  void init() {
+    syncSettings();
+    task_.init();
+  }
+
+  void getInitialState(State &state) {
+    init();
+    getState(state);
+  }
+
+  void setInitialState(const State &in) {
+    LOG(FATAL) << "The initial state is random. No need to set it" << std::endl;
+  }
+
+  /// the estimate restarts from the observation
+  void initTo(const State &state) {
+    syncSettings();
+    task_.initTo(normalizer_.restore(state).template head<ObservationDim>());
+  }
+
+  void getState(State &state) {
+    Observation observation;
+    task_.getState(observation);
+    compose(observation, state);
+  }
+
+  // Misc implementations
+  void getGradientStateResAct(const State &stateIN,
+                              const Action &actionIN,
+                              MatrixJacobian &gradientOUT) {
+    LOG(FATAL) << "To do!" << std::endl;
+  };
+
+  void getGradientCostResAct(const State &stateIN,
+                             const Action &actionIN,
+                             MatrixJacobianCostResAct &gradientOUT) {
+    LOG(FATAL) << "To do!" << std::endl;
+  }
+
+  void setResetPool(std::shared_ptr<ResetStatePool> pool) { task_.setResetPool(std::move(pool)); }
+
+  void setPhysicalParameters(const PhysicalParameters &parameters) { task_.setPhysicalParameters(parameters); }
+
+  const PhysicalParameters &physicalParameters() const { return task_.physicalParameters(); }
+
+  void setParameterRandomization(const ParameterRandomization &randomization) {
+    task_.setParameterRandomization(randomization);
+  }
+
+  /// normalizes the whole state, the partial task's own normalizer stays disabled
+  ObservationNormalizer<Dtype, StateDim> &observationNormalizer() { return normalizer_; }
+
+  /// the partial task's, it decides how an episode ends
+  Metrics::EpisodeStatistics &episodeStatistics() { return task_.episodeStatistics(); }
+
+  void saveState(Snapshot &snapshot) const { task_.saveState(snapshot); }
+
+  void restoreState(const Snapshot &snapshot) { task_.restoreState(snapshot); }
+
+  long episodeSteps() const { return task_.episodeSteps(); }
+
+  PartialTask &partialTask() { return task_; }
+
+  void startRecordingVideo(std::string dir, std::string fileName) {
+    task_.startRecordingVideo(dir, fileName);
+  }
+
+  void endRecordingVideo() {
+    task_.endRecordingVideo();
+  }
+
+  void setHeadless(bool headless) { task_.setHeadless(headless); }
+
+ private:
+
+  void compose(const Observation &observation, State &state) {
+    Estimate estimate;
+    task_.getLoadEstimate(estimate);
+    state << observation, estimate;
+    normalizer_.apply(state);
+  }
+
+  /// the settings made on this task apply to the simulation
+  void syncSettings() {
+    task_.setControlUpdate_dt(this->controlUpdate_dt_);
+    task_.setTimeLimitPerEpisode(this->timeLimit_);
+    if (this->visualization_ON_ == visualizing_) return;
+    visualizing_ = this->visualization_ON_;
+    if (visualizing_)
+      task_.turnOnVisualization("");
+    else
+      task_.turnOffVisualization();
+  }
+
+  PartialTask task_;
+  ObservationNormalizer<Dtype, StateDim> normalizer_;
+  bool visualizing_ = false;
+};
+
+}
+} /// namespaces
+
+#endif //RAI_SLUNGLOADCONTROL_ESTIMATOR_HPP
@@ -0,0 +1,195 @@
+//
+// slungloadControl_partial with the last H observations stacked into the
+// state, so a feed-forward policy can infer the load velocity the partial
+// task leaves out. With HistoryMode::deltas the older slots hold the
+// change between consecutive observations. The simulation is the wrapped
+// partial task; this class only keeps the ring of its observations.
+//
+
+#ifndef RAI_SLUNGLOADCONTROL_HISTORY_HPP
+#define RAI_SLUNGLOADCONTROL_HISTORY_HPP
+
+#include "slungload/slungloadControl_partial.hpp"
+#include "common/ObservationNormalizer.hpp"
+#include "common/ObservationHistory.hpp"
+
+namespace rai {
+namespace Task {
+
+template<typename Dtype, int H, HistoryMode Mode = HistoryMode::deltas>
+class slungloadControl_history : public Task<Dtype, 21 * H, 4, 0> {
+ public:
+  using PartialTask = slungloadControl_partial<Dtype>;
+  using History = ObservationHistory<Dtype, PartialTask::StateDim, H, Mode>;
+
+  enum {
+    ObservationDim = PartialTask::StateDim,
+    StateDim = History::StackedDim,
+    ActionDim = PartialTask::ActionDim,
+    CommandDim = PartialTask::CommandDim
+  };
+
+  using TaskBase = Task<Dtype, StateDim, ActionDim, CommandDim>;
+  using State = typename TaskBase::State;
+  using StateBatch = typename TaskBase::StateBatch;
+  using Action = typename TaskBase::Action;
+  using ActionBatch = typename TaskBase::ActionBatch;
+  using Observation = typename PartialTask::State;
+  using MatrixJacobian = typename TaskBase::JacobianStateResAct;
+  using MatrixJacobianCostResAct = typename TaskBase::JacobianCostResAct;
+  using ResetStatePool = typename PartialTask::ResetStatePool;
+
+  struct Snapshot {
+    typename PartialTask::Snapshot task;
+    double history[History::SnapshotSize];
+  };
+
+  slungloadControl_history() {
+
+    //// set default parameters
+    this->valueAtTermination_ = 1.5;
+    this->discountFactor_ = 0.99;
+    this->timeLimit_ = 15.0;
+    this->controlUpdate_dt_ = 0.01;
+
+    /////// adding constraints////////////////////
+    /// the newest observation has the partial task's bounds, a delta spans at most twice them
+    const Observation bound = PartialTask::stateBound();
+    State upperStateBound;
+    upperStateBound.template head<ObservationDim>() = bound;
+    for (int k = 1; k < H; k++)
+      upperStateBound.template segment<ObservationDim>(k * ObservationDim) =
+          Mode == HistoryMode::deltas ? Observation(2.0 * bound) : bound;
+    this->setBoxConstraints(-upperStateBound, upperStateBound);
+  }
+
+  void step(const Action &action_t,
+            State &state_tp1,
+            TerminationType &termType,
+            Dtype &costOUT) {
+    syncSettings();
+    Observation observation;
+    task_.step(action_t, observation, termType, costOUT);
+    history_.push(observation);
+    getState(state_tp1);
+  }
+
+  bool isTerminalState(State &state) { return false; }
+
+  void init() {
+    syncSettings();
+    Observation observation;
+    task_.getInitialState(observation);
+    history_.reset(observation);
+  }
+
+  void getInitialState(State &state) {
+    init();
+    getState(state);
+  }
+
+  void setInitialState(const State &in) {
+    LOG(FATAL) << "The initial state is random. No need to set it" << std::endl;
+  }
+
+  /// starts from the newest observation of state, the older ones are not recoverable
+  void initTo(const State &state) {
+    syncSettings();
+    const Observation observation = normalizer_.restore(state).template head<ObservationDim>();
+    task_.initTo(observation);
+    history_.reset(observation);
+  }
+
+  void getState(State &state) {
+    history_.stack(state);
+    normalizer_.apply(state);
+  }
+
+  // Misc implementations
+  void getGradientStateResAct(const State &stateIN,
+                              const Action &actionIN,
+                              MatrixJacobian &gradientOUT) {
+    LOG(FATAL) << "To do!" << std::endl;
+  };
+
+  void getGradientCostResAct(const State &stateIN,
+                             const Action &actionIN,
+                             MatrixJacobianCostResAct &gradientOUT) {
+    LOG(FATAL) << "To do!" << std::endl;
+  }
+
+  void setResetPool(std::shared_ptr<ResetStatePool> pool) { task_.setResetPool(std::move(pool)); }
+
+  void setPhysicalParameters(const PhysicalParameters &parameters) { task_.setPhysicalParameters(parameters); }
+
+  const PhysicalParameters &physicalParameters() const { return task_.physicalParameters(); }
+
+  void setParameterRandomization(const ParameterRandomization &randomization) {
+    task_.setParameterRandomization(randomization);
+  }
+
+  /// normalizes the whole state, the partial task's own normalizer stays disabled
+  ObservationNormalizer<Dtype, StateDim> &observationNormalizer() { return normalizer_; }
+
+  /// the partial task's, it decides how an episode ends
+  Metrics::EpisodeStatistics &episodeStatistics() { return task_.episodeStatistics(); }
+
+  /// the partial task's snapshot and the observations stacked so far
+  void saveState(Snapshot &snapshot) const {
+    task_.saveState(snapshot.task);
+    history_.save(snapshot.history);
+  }
+
+  void restoreState(const Snapshot &snapshot) {
+    task_.restoreState(snapshot.task);
+    history_.load(snapshot.history);
+  }
+
+  long episodeSteps() const { return task_.episodeSteps(); }
+
+  PartialTask &partialTask() { return task_; }
+
+  void startRecordingVideo(std::string dir, std::string fileName) {
+    task_.startRecordingVideo(dir, fileName);
+  }
+
+  void endRecordingVideo() {
+    task_.endRecordingVideo();
+  }
+
+  void setHeadless(bool headless) { task_.setHeadless(headless); }
+
+ private:
+
+  /// the settings made on this task apply to the simulation
+  void syncSettings() {
+    task_.setControlUpdate_dt(this->controlUpdate_dt_);
+    task_.setTimeLimitPerEpisode(this->timeLimit_);
+    if (this->visualization_ON_ == visualizing_) return;
+    visualizing_ = this->visualization_ON_;
+    if (visualizing_)
+      task_.turnOnVisualization("");
+    else
+      task_.turnOffVisualization();
+  }
+
+  PartialTask task_;
+  ObservationNormalizer<Dtype, StateDim> normalizer_;
+  History history_;
+  bool visualizing_ = false;
+};
+
+/// four observations as the newest one and three deltas, the variant registered with the task registry
+template<typename Dtype>
+class slungloadControl_history4 : public slungloadControl_history<Dtype, 4> {};
+
+template<>
+struct TaskTraits<slungloadControl_history4> {
+  enum { StateDim = 21 * 4, ActionDim = 4, CommandDim = 0 };
+  static const char *name() { return "slungload_history_4"; }
+};
+
+}
+} /// namespaces
+
+#endif //RAI_SLUNGLOADCONTROL_HISTORY_HPP
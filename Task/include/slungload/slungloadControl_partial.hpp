@@ -2,8 +2,8 @@
 // Created by Jaeyoung Lim on 25.11.17.
 //
 
-//#ifndef RAI_SLUNGLOADCONTROL_HPP
-//#define RAI_SLUNGLOADCONTROL_HPP
+#ifndef RAI_SLUNGLOADCONTROL_PARTIAL_HPP
+#define RAI_SLUNGLOADCONTROL_PARTIAL_HPP
 
 // custom inclusion- Modify for your task
 #include "rai/tasks/common/Task.hpp"
@@ -15,23 +15,42 @@
 #include <rai/RAI_core>
 #include "raiGraphics/RAI_graphics.hpp"
 #include "slungload/visualizer/slungload_Visualizer.hpp"
+#include "slungload/visualizer/slungload_OffscreenVisualizer.hpp"
 #include "raiCommon/utils/StopWatch.hpp"
-
-#pragma once
+#include "trace/Trace.hpp"
+#include "metrics/EpisodeStatistics.hpp"
+#include "common/TaskTraits.hpp"
+#include "common/PhysicalParameters.hpp"
+#include "common/ObservationNormalizer.hpp"
+#include "common/TaskSnapshot.hpp"
+#include "common/ResetPool.hpp"
+#include "slungload/ResetSampler.hpp"
+#include "slungload/LoadEstimator.hpp"
 
 namespace rai {
 namespace Task {
 
-constexpr int StateDim = 21;
-constexpr int ActionDim = 4;
-constexpr int CommandDim = 0;
+template<typename Dtype>
+class slungloadControl_partial;
+
+template<>
+struct TaskTraits<slungloadControl_partial> {
+  enum { StateDim = 21, ActionDim = 4, CommandDim = 0 };
+  static const char *name() { return "slungload_partial"; }
+};
 
 template<typename Dtype>
-class slungloadControl : public Task<Dtype,
-                                     StateDim,
-                                     ActionDim,
-                                     CommandDim> {
+class slungloadControl_partial : public Task<Dtype,
+                                             TaskTraits<slungloadControl_partial>::StateDim,
+                                             TaskTraits<slungloadControl_partial>::ActionDim,
+                                             TaskTraits<slungloadControl_partial>::CommandDim> {
  public:
+  enum {
+    StateDim = TaskTraits<slungloadControl_partial>::StateDim,
+    ActionDim = TaskTraits<slungloadControl_partial>::ActionDim,
+    CommandDim = TaskTraits<slungloadControl_partial>::CommandDim
+  };
+
   using TaskBase = Task<Dtype, StateDim, ActionDim, CommandDim>;
   using State = typename TaskBase::State;
   using StateBatch = typename TaskBase::StateBatch;
@@ -47,8 +66,11 @@ class slungloadControl : public Task<Dtype,
   using GeneralizedCoordinate = Eigen::Matrix<double, 10, 1>;
   using GeneralizedVelocity = Eigen::Matrix<double, 9, 1>;
   using GeneralizedAcceleration = Eigen::Matrix<double, 9, 1>;
+  using Snapshot = TaskSnapshot<10, 9, LoadEstimator<1>::SnapshotSize>;
 
-  slungloadControl() {
+  using ResetStatePool = ResetPool<SlungloadResetDim>;
+
+  slungloadControl_partial() {
 
     //// set default parameters
     this->valueAtTermination_ = 1.5;
@@ -57,12 +79,7 @@ class slungloadControl : public Task<Dtype,
     this->controlUpdate_dt_ = 0.01;
     gravity_ << 0.0, 0.0, -9.81;
 
-    Eigen::Vector3d diagonalInertia;
-//    diagonalInertia << 0.0105, 0.0105, 0.018;
-    diagonalInertia << 0.007, 0.007, 0.012;
-
-    inertia_ = diagonalInertia.asDiagonal();
-    cholInv(inertia_, inertiaInv_);
+    updateParameters(true);
     comLocation_ << 0.0, 0.0, -0.05;
 
     /////// scale //////
@@ -73,32 +90,34 @@ class slungloadControl : public Task<Dtype,
     linVelScale_ = 0.5;
 
     /////// adding constraints////////////////////
-    State upperStateBound, lowerStateBound;
-    upperStateBound << 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, //Rotation Matrix
-                        3.0, 3.0, 3.0, //Quad Position
-                        5.0, 5.0, 5.0, //Load State Position
-                        5.0, 5.0, 5.0, //Quad Angular Velocity
-                        6.0, 6.0, 6.0, //Quad Linear Velocity
-                        6.0, 6.0, 6.0; //Load State Velocity
+    State upperStateBound = stateBound(), lowerStateBound;
     lowerStateBound = -upperStateBound;
 
     this->setBoxConstraints(lowerStateBound, upperStateBound);
-    transsThrust2GenForce << 0, 0, length_, -length_,
-        -length_, length_, 0, 0,
-        dragCoeff_, dragCoeff_, -dragCoeff_, -dragCoeff_,
-        1, 1, 1, 1;
-    transsThrust2GenForceInv = transsThrust2GenForce.inverse();
+    episodeStatistics_.setBounds(lowerStateBound, upperStateBound);
     targetPosition.setZero();
   }
 
-  ~slungloadControl() {
+  ~slungloadControl_partial() {
+  }
+
+  /// upper box constraint of the state, the lower one is its negative
+  static State stateBound() {
+    State upperStateBound;
+    upperStateBound << 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, //Rotation Matrix
+                        3.0, 3.0, 3.0, //Quad Position
+                        5.0, 5.0, 5.0, //Load State Position
+                        5.0, 5.0, 5.0, //Quad Angular Velocity
+                        6.0, 6.0, 6.0; //Quad Linear Velocity
+    return upperStateBound;
   }
 
   void step(const Action &action_t,
             State &state_tp1,
             TerminationType &termType,
             Dtype &costOUT) {
-
+    RAI_TRACE_SCOPE("env step");
+    steps_++;
 
     //Get current state from q_, u_
     orientation = q_.head(4); //Orientation of quadrotor
@@ -132,12 +151,14 @@ class slungloadControl : public Task<Dtype,
     fbTorque_b(2) = fbTorque_b(2) * 0.15; //Lower yaw gains
 
     B_torque += fbTorque_b; //Sum of torque inputs
-    B_force(2) += mass_ * 9.81; //Sum of thrust inputs
+    B_force(2) += params_.mass * 9.81; //Sum of thrust inputs
 
     // clip inputs
     Action genForce;
     genForce << B_torque, B_force(2);
     Action thrust = transsThrust2GenForceInv * genForce;    // TODO: This is not exactly thrust: change name
+    uint64_t saturated = 0; // rotors held at their minimum thrust
+    for (int i = 0; i < 4; i++) saturated |= uint64_t(thrust(i) < 1e-8) << i;
     thrust = thrust.array().cwiseMax(1e-8); // clip for min value
     genForce = transsThrust2GenForce * thrust;
     B_torque = genForce.segment(0, 3);
@@ -146,12 +167,12 @@ class slungloadControl : public Task<Dtype,
     load_direction = load_position - position;
     Position direction = (1 /load_direction.norm())* load_direction;
 
-    if(load_direction.norm() < tether_length) T_force = 0.0*T_force;
-    else T_force = load_mass_ * (gravity_ + du_.tail(3)).norm() * direction;
+    if(load_direction.norm() < params_.tetherLength) T_force = 0.0*T_force;
+    else T_force = params_.loadMass * (gravity_ + du_.tail(3)).norm() * direction;
 
-    du_.segment<3>(3) = (R_ * B_force) / mass_ + gravity_ + T_force; // quadrotor acceleration
+    du_.segment<3>(3) = (R_ * B_force) / params_.mass + gravity_ + T_force; // quadrotor acceleration
     du_.head(3) = R_ * (inertiaInv_ * (B_torque - w_B_.cross(inertia_ * w_B_))); //acceleration by inputs
-    du_.tail(3) = gravity_ - T_force / load_mass_ - 0.01*u_.tail(3).norm()*u_.tail(3)/u_.segment<3>(6).norm(); // Load Acceleration
+    du_.tail(3) = gravity_ - T_force / params_.loadMass - 0.01*u_.tail(3).norm()*u_.tail(3)/u_.segment<3>(6).norm(); // Load Acceleration
 
     //Integrate states
     u_ += du_ * this->controlUpdate_dt_; //velocity after timestep
@@ -165,8 +186,8 @@ class slungloadControl : public Task<Dtype,
     q_.tail(3) = q_.tail(3) + u_.tail(3) * this->controlUpdate_dt_; // Load Posittion
 
 
-    if ((q_.tail(3) - q_.segment<3>(4)).norm() > tether_length)
-      q_.tail(3) = q_.segment<3>(4) + tether_length * (q_.tail(3) - q_.segment<3>(4))/(q_.tail(3) - q_.segment<3>(4)).norm(); // Position Constraint
+    if ((q_.tail(3) - q_.segment<3>(4)).norm() > params_.tetherLength)
+      q_.tail(3) = q_.segment<3>(4) + params_.tetherLength * (q_.tail(3) - q_.segment<3>(4))/(q_.tail(3) - q_.segment<3>(4)).norm(); // Position Constraint
 
 
     if (std::isnan(orientation.norm())) {
@@ -178,6 +199,11 @@ class slungloadControl : public Task<Dtype,
       std::cout << "action_t " << action_t.transpose() << std::endl;
     }
 
+    /// the quadrotor velocity before the clipping below is the one its acceleration produced
+    if (estimateLoad_)
+      loadEstimator_.step(v_I_, u_.segment<3>(3), R_ * B_force / params_.mass, this->controlUpdate_dt_,
+                          params_.loadMass, params_.tetherLength);
+
     u_(0) = clip(u_(0), -20.0, 20.0);
     u_(1) = clip(u_(1), -20.0, 20.0);
     u_(2) = clip(u_(2), -20.0, 20.0);
@@ -187,10 +213,11 @@ class slungloadControl : public Task<Dtype,
     u_(6) = clip(u_(6), -5.0, 5.0);
     u_(7) = clip(u_(7), -5.0, 5.0);
 
-    getState(state_tp1);
+    buildState(state_tp1);
 
     if (this->isViolatingBoxConstraint(state_tp1))
       termType = TerminationType::terminalState;
+    normalizer_.apply(state_tp1);
 
     costOUT = 0.004 * std::sqrt(q_.tail(3).norm()) +  // load position
         0.00005 * action_t.norm() +                   // action
@@ -198,13 +225,24 @@ class slungloadControl : public Task<Dtype,
         0.00005 * u_.segment<3>(3).norm() +           // linear velocity
         0.00000 * u_.tail(3).norm();                  //
 
+    episodeStatistics_.step(costOUT, saturated);
+    if (termType == TerminationType::terminalState) {
+      State unnormalized;
+      buildState(unnormalized);
+      episodeStatistics_.endTerminalState(unnormalized, q_.tail(3).norm());
+    }
+
     // visualization
     if (this->visualization_ON_) {
       updateVisualizationFrames();
-      visualizer_.drawWorld(visualizeFrame, position, orientation, load_position);
-      double waitTime = std::max(0.0, this->controlUpdate_dt_ / realTimeRatio - watch.measure("sim", true));
-      watch.start("sim");
-      usleep(waitTime * 1e6);
+      if (headless_) {
+        offscreenVisualizer().drawWorld(visualizeFrame, position, orientation, load_position);
+      } else {
+        visualizer().drawWorld(visualizeFrame, position, orientation, load_position);
+        double waitTime = std::max(0.0, this->controlUpdate_dt_ / realTimeRatio - watch.measure("sim", true));
+        watch.start("sim");
+        usleep(waitTime * 1e6);
+      }
 
     }
   }
@@ -223,11 +261,11 @@ class slungloadControl : public Task<Dtype,
     position = q_.tail(3);
     R_ = Math::MathFunc::quatToRotMat(orientation);
 
-    du_.tail(3) = (R_ * B_force) / mass_ + gravity_;
+    du_.tail(3) = (R_ * B_force) / params_.mass + gravity_;
     w_B_ = R_.transpose() * u_.head(3);
 
     /// compute in body coordinate and transform it to world coordinate
-//    B_torque += comLocation_.cross(mass_ * R_.transpose() * gravity_);
+//    B_torque += comLocation_.cross(params_.mass * R_.transpose() * gravity_);
     du_.head(3) = R_ * (inertiaInv_ * (B_torque - w_B_.cross(inertia_ * w_B_)));
 
     u_ += du_ * this->controlUpdate_dt_;
@@ -253,10 +291,14 @@ class slungloadControl : public Task<Dtype,
     if (this->visualization_ON_) {
 
       updateVisualizationFrames();
-      visualizer_.drawWorld(visualizeFrame, position, orientation, load_position);
-      double waitTime = std::max(0.0, this->controlUpdate_dt_ / realTimeRatio - watch.measure("sim", true));
-      watch.start("sim");
-      usleep(waitTime * 1e6);
+      if (headless_) {
+        offscreenVisualizer().drawWorld(visualizeFrame, position, orientation, load_position);
+      } else {
+        visualizer().drawWorld(visualizeFrame, position, orientation, load_position);
+        double waitTime = std::max(0.0, this->controlUpdate_dt_ / realTimeRatio - watch.measure("sim", true));
+        watch.start("sim");
+        usleep(waitTime * 1e6);
+      }
     }
   }
 
@@ -267,34 +309,80 @@ class slungloadControl : public Task<Dtype,
   bool isTerminalState(State &state) { return false; }
 
   void init() {
-    /// initial state is random
-    double oriF[4], posiF[3], angVelF[3], linVelF[3], loadPosF[3],loadVelF[3], tetherLength;
-    rn_.template sampleOnUnitSphere<4>(oriF);
-    rn_.template sampleVectorInNormalUniform<3>(posiF);
-    rn_.template sampleVectorInNormalUniform<3>(angVelF);
-    rn_.template sampleVectorInNormalUniform<3>(linVelF);
-    rn_.template sampleInUnitSphere<3>(loadPosF);
-    rn_.template sampleVectorInNormalUniform<3>(loadVelF);
+    restartEpisode();
+    steps_ = 0;
+    randomizeParameters();
+
+    /// initial state is random, drawn ahead of time by the reset pool for a unit tether
+    if (!resetPool_)
+      resetPool_ = slungloadResetPool();
+    typename ResetStatePool::Sample sample;
+    resetPool_->pop(sample);
+    q_ = sample.template head<10>();
+    u_ = sample.template tail<9>();
+    q_.template tail<3>() = q_.template segment<3>(4) + params_.tetherLength * (q_.template tail<3>() - q_.template segment<3>(4));
+    /// the partial task starts the load with the quadrotor's velocity
+    u_.tail(3) = u_.template segment<3>(3);
+    resetLoadEstimator();
+  }
+
+  /// fills a ResetStatePool, e.g. ResetStatePool::fixed(resetGenerator(), 1000, seed) for reproducible
+  /// runs. The states are drawn for a unit tether, init() scales them to the current tether length
+  static typename ResetStatePool::Generator resetGenerator() {
+    return [](std::mt19937_64 &rng, typename ResetStatePool::Batch &batch) {
+      sampleSlungloadResets(rng, batch, 1.0);
+    };
+  }
 
+  /// replaces the process-wide slungloadResetPool() for this task, e.g. with a fixed pool
+  void setResetPool(std::shared_ptr<ResetStatePool> pool) {
+    resetPool_ = std::move(pool);
+  }
+
+  /// takes effect immediately. The thrust mapping is only rebuilt if the rotor geometry changed
+  void setPhysicalParameters(const PhysicalParameters &parameters) {
+    const bool rotorsChanged = !parameters.sameRotorGeometry(params_);
+    params_ = parameters;
+    updateParameters(rotorsChanged);
+  }
 
-    Quaternion orientation;
-    Position position, loadPosition;
-    AngularVelocity angularVelocity;
-    LinearVelocity linearVelocity, loadVelocity;
+  const PhysicalParameters &physicalParameters() const { return params_; }
 
-    orientation << double(std::abs(oriF[0])), double(oriF[1]), double(oriF[2]), double(oriF[3]);
-    rai::Math::MathFunc::normalizeQuat(orientation);
-    position << double(posiF[0])*2., double(posiF[1])*2., double(posiF[2])*2.;
-    angularVelocity << double(angVelF[0]), double(angVelF[1]), double(angVelF[2]);
-    linearVelocity << double(linVelF[0]), double(linVelF[1]), double(linVelF[2]);
-    loadPosition << double(loadPosF[0])*tether_length, double(loadPosF[1])*tether_length, -double(std::abs(loadPosF[2]))*tether_length;
-    loadVelocity << double(loadVelF[0]), double(loadVelF[1]), double(loadVelF[2]);
+  /// running observation normalization applied by getState, disabled by default
+  ObservationNormalizer<Dtype, StateDim> &observationNormalizer() { return normalizer_; }
 
-    load_direction = rai::Math::MathFunc::quatToRotMat(orientation)*loadPosition;
+  /// every episode this task runs, test episodes included. The rotors are the actuators
+  Metrics::EpisodeStatistics &episodeStatistics() { return episodeStatistics_; }
 
-    q_ << orientation, position, position + load_direction;
-    u_ << angularVelocity, linearVelocity, linearVelocity;
+  /// the episode so far as plain data, restoreState continues it exactly on any task of this type
+  void saveState(Snapshot &snapshot) const {
+    snapshot.coordinate() = q_;
+    snapshot.velocity() = u_;
+    snapshot.acceleration() = du_;
+    loadEstimator_.save(snapshot.extra);
+    snapshot.parameters = params_;
+    snapshot.rng = parameterRng_;
+    snapshot.rngSeeded = parameterRngSeeded_;
+    snapshot.steps = steps_;
+  }
 
+  void restoreState(const Snapshot &snapshot) {
+    q_ = snapshot.coordinate();
+    u_ = snapshot.velocity();
+    du_ = snapshot.acceleration();
+    loadEstimator_.load(snapshot.extra);
+    setPhysicalParameters(snapshot.parameters);
+    parameterRng_ = snapshot.rng;
+    parameterRngSeeded_ = snapshot.rngSeeded;
+    steps_ = snapshot.steps;
+  }
+
+  /// control steps since the episode started
+  long episodeSteps() const { return steps_; }
+
+  /// resamples the parameters at every init(), a zero spread keeps them fixed
+  void setParameterRandomization(const ParameterRandomization &randomization) {
+    randomization_ = randomization;
   }
 
   void translate(Position& position) {
@@ -311,28 +399,34 @@ class slungloadControl : public Task<Dtype,
   }
 
   void initTo(const State &state) {
-    State stateT = state;
-    Position load_state_v;
+    restartEpisode();
+    const State stateT = normalizer_.restore(state);
 
     R_.col(0) = stateT.segment(0, 3);
     R_.col(1) = stateT.segment(3, 3);
     R_.col(2) = stateT.segment(6, 3);
     orientation = Math::MathFunc::rotMatToQuat(R_);
     q_.head(4) = orientation;
-    q_.segment<3>(4) = state.segment(9, 3) / positionScale_;
-
+    q_.segment<3>(4) = stateT.segment(9, 3) / positionScale_;
+    q_.tail(3) = q_.segment<3>(4) + R_ * loadOffset(stateT.template segment<3>(12).template cast<double>());
 
-    q_.tail(3) << load_state_v(2)*sin(load_state_v(0)),
-                  load_state_v(2)*sin(load_state_v(1)),
-                  -load_state_v(2)*std::sqrt(1 - sin(load_state_v(0))*sin(load_state_v(0)) - sin(load_state_v(1)) *sin(load_state_v(1)));
-
-    u_.head(3) = state.segment(12, 3) / angVelScale_;
-    u_.segment<3>(3) = state.segment(15, 3) / linVelScale_;
-    u_.tail(3) = state.tail(3) * linVelScale_;
+    u_.head(3) = stateT.segment(15, 3) / angVelScale_;
+    u_.segment<3>(3) = stateT.segment(18, 3) / linVelScale_;
+    /// the load velocity is not observed, it starts with the quadrotor's as in init()
+    u_.tail(3) = u_.segment<3>(3);
     du_ = 0.0*du_;
+    resetLoadEstimator();
+    steps_ = 0;
   }
 
+  /// the state of the simulation, normalized if observationNormalizer() is enabled
   void getState(State &state) {
+    buildState(state);
+    normalizer_.apply(state);
+  }
+
+  /// the state before normalization, the box constraints apply to it
+  void buildState(State &state) {
     LOG_IF(FATAL, std::isnan(q_.head(4).norm())) << "simulation unstable";
     orientation = q_.head(4);
     Math::MathFunc::normalizeQuat(orientation);
@@ -365,6 +459,19 @@ class slungloadControl : public Task<Dtype,
     LOG(FATAL) << "To do!" << std::endl;
   }
 
+  /// runs a LoadEstimator on the quadrotor states and commanded thrust at every step
+  void enableLoadEstimation(const LoadEstimatorNoise &noise = LoadEstimatorNoise()) {
+    estimateLoad_ = true;
+    loadEstimator_.setNoise(noise);
+    resetLoadEstimator();
+  }
+
+  /// estimated tether direction and load velocity, in the world frame and scaled like the state
+  void getLoadEstimate(Eigen::Matrix<Dtype, 6, 1> &estimate) {
+    estimate << loadEstimator_.direction().template cast<Dtype>(),
+        (loadEstimator_.velocity() * linVelScale_).template cast<Dtype>();
+  }
+
   void getOrientation(Quaternion &quat){
     quat = orientation;
   }
@@ -383,16 +490,73 @@ class slungloadControl : public Task<Dtype,
 
   void startRecordingVideo(std::string dir, std::string fileName) {
     mkdir(dir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
-    visualizer_.getGraphics()->savingSnapshots(dir, fileName);
+    if (headless_)
+      offscreenVisualizer().startRecording(dir, fileName, this->controlUpdate_dt_);
+    else
+      visualizer().getGraphics()->savingSnapshots(dir, fileName);
   }
 
   void endRecordingVideo() {
-    visualizer_.getGraphics()->images2Video();
+    if (headless_)
+      offscreenVisualizer().endRecording();
+    else
+      visualizer().getGraphics()->images2Video();
   }
 
+  /// renders offscreen into the recorded video and steps without real-time pacing, for hosts
+  /// without a display. Defaults to Render::headlessByDefault()
+  void setHeadless(bool headless) { headless_ = headless; }
+  bool isHeadless() const { return headless_; }
+
 
  private:
 
+  void updateParameters(bool rotorsChanged) {
+    const Eigen::Map<const Eigen::Vector3d> diagonalInertia(params_.inertia);
+    inertia_ = diagonalInertia.asDiagonal();
+    inertiaInv_ = diagonalInertia.cwiseInverse().asDiagonal();
+    if (!rotorsChanged) return;
+
+    const double length = params_.armLength, dragCoeff = params_.dragCoeff;
+    transsThrust2GenForce << 0, 0, length, -length,
+        -length, length, 0, 0,
+        dragCoeff, dragCoeff, -dragCoeff, -dragCoeff,
+        1, 1, 1, 1;
+    transsThrust2GenForceInv = transsThrust2GenForce.inverse();
+  }
+
+  void randomizeParameters() {
+    if (!randomization_.enabled()) return;
+    /// seeded on first use, so tasks copied from one prototype draw different parameters
+    if (!parameterRngSeeded_) {
+      parameterRng_.seed(std::random_device()());
+      parameterRngSeeded_ = true;
+    }
+    PhysicalParameters parameters;
+    randomization_.sample(parameterRng_, parameters);
+    setPhysicalParameters(parameters);
+  }
+
+  /// ends the running episode of episodeStatistics(), a timeout if it ran for the whole time limit
+  void restartEpisode() {
+    episodeStatistics_.restart(q_.tail(3).norm(),
+                               steps_ * this->controlUpdate_dt_ >= this->timeLimit_ - 0.5 * this->controlUpdate_dt_);
+  }
+
+  /// inverse of the load parametrization of getState: the body frame offset from the two angles
+  /// and the distance, with the load below the quadrotor
+  static Position loadOffset(const Position &loadState) {
+    const double sx = std::sin(loadState(0)), sy = std::sin(loadState(1));
+    Position offset;
+    offset << sx, sy, -std::sqrt(std::max(0.0, 1.0 - sx * sx - sy * sy));
+    return loadState(2) * offset;
+  }
+
+  /// the load offset is part of the observation, its velocity starts at the quadrotor's
+  void resetLoadEstimator() {
+    if (!estimateLoad_) return;
+    loadEstimator_.reset(0, q_.template tail<3>() - q_.template segment<3>(4), u_.template segment<3>(3));
+  }
 
   void updateVisualizationFrames() {
 
@@ -421,12 +585,14 @@ class slungloadControl : public Task<Dtype,
   double orientationScale_, positionScale_, angVelScale_, linVelScale_;
   double actionScale_;
   /// robot parameters
-  double length_ = 0.17;
+  PhysicalParameters params_;
+  ObservationNormalizer<Dtype, StateDim> normalizer_;
+  Metrics::EpisodeStatistics episodeStatistics_{StateDim, ActionDim};
+  ParameterRandomization randomization_;
+  std::mt19937_64 parameterRng_;
+  bool parameterRngSeeded_ = false;
+  long steps_ = 0;
   Position comLocation_;
-  double dragCoeff_ = 0.016;
-  double mass_ = 0.665;
-  double tether_length = 1.0;
-  double load_mass_ = 0.08;
   Inertia inertia_;
   Inertia inertiaInv_;
   Quaternion orientation;
@@ -435,7 +601,9 @@ class slungloadControl : public Task<Dtype,
   Torque B_torque;
   AngularVelocity w_I_, w_B_;
   LinearVelocity v_I_, vl_I_;
-  RandomNumberGenerator<Dtype> rn_;
+  std::shared_ptr<ResetStatePool> resetPool_;
+  LoadEstimator<1> loadEstimator_;
+  bool estimateLoad_ = false;
   EulerVector w_IXdt_;
   static rai_graphics::RAI_graphics graphics;
   static rai_graphics::object::Quadrotor quadrotor;
@@ -450,14 +618,21 @@ class slungloadControl : public Task<Dtype,
   //Visualization
   StopWatch watch;
   double realTimeRatio = 1;
-  static rai::Vis::slungload_Visualizer visualizer_;
+  bool headless_ = Render::headlessByDefault();
+  /// constructed on first use, a task that never visualizes opens no window and no EGL context
+  static rai::Vis::slungload_Visualizer &visualizer() {
+    static rai::Vis::slungload_Visualizer visualizer;
+    return visualizer;
+  }
+  static rai::Vis::slungload_OffscreenVisualizer &offscreenVisualizer() {
+    static rai::Vis::slungload_OffscreenVisualizer visualizer;
+    return visualizer;
+  }
   HomogeneousTransform visualizeFrame;
 
 };
 }
 } /// namespaces
 template<typename Dtype>
-rai::Position rai::Task::slungloadControl<Dtype>::targetPosition;
-template<typename Dtype>
-rai::Vis::slungload_Visualizer rai::Task::slungloadControl<Dtype>::visualizer_;
-//#endif //RAI_SLUNGLOADCONTROL_HPP
\ No newline at end of file
+rai::Position rai::Task::slungloadControl_partial<Dtype>::targetPosition;
+#endif //RAI_SLUNGLOADCONTROL_PARTIAL_HPP
\ No newline at end of file
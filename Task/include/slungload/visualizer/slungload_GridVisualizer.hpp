@@ -0,0 +1,52 @@
+#pragma once
+
+#include "raiCommon/math/RAI_math.hpp"
+#include "raiGraphics/RAI_graphics.hpp"
+#include "raiGraphics/obj/Cylinder.hpp"
+#include "raiGraphics/obj/Sphere.hpp"
+#include "raiGraphics/obj/Quadrotor.hpp"
+#include <memory>
+#include <vector>
+
+namespace rai {
+namespace Vis {
+
+/// many slungload envs in one window: tiled on a square grid, or overlaid at the origin with
+/// translucent bodies. An env marked failed keeps its last pose and draws its load red
+class slungload_GridVisualizer {
+
+ public:
+  enum class Layout { tiled, overlaid };
+  /// column i is the generalized coordinate of env i: quaternion, quadrotor position, load position
+  using Coordinates = Eigen::Matrix<double, 10, Eigen::Dynamic>;
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  explicit slungload_GridVisualizer(int nEnvs, Layout layout = Layout::tiled, double spacing = 4.0);
+
+  ~slungload_GridVisualizer();
+
+  void drawWorld(const Coordinates &q);
+  void setFailed(int env, bool failed);
+  /// where env is drawn relative to its own origin
+  rai::Position offset(int env) const;
+  int envs() const { return int(quadrotors.size()); }
+  rai_graphics::RAI_graphics* getGraphics();
+
+ private:
+  rai_graphics::RAI_graphics graphics;
+  std::vector<std::unique_ptr<rai_graphics::object::Quadrotor>> quadrotors;
+  std::vector<std::unique_ptr<rai_graphics::object::Sphere>> loads;
+  /// three segments per tether
+  std::vector<std::unique_ptr<rai_graphics::object::Cylinder>> tethers;
+  rai_graphics::object::Sphere center;
+  rai_graphics::object::Background background;
+
+  Layout layout_;
+  double spacing_;
+  int columns_;
+  std::vector<char> failed_;
+  HomogeneousTransform defaultPose_;
+};
+
+}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "raiCommon/math/RAI_math.hpp"
+#include "render/Headless.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#ifdef RAI_OFFSCREEN
+#include "render/OffscreenRenderer.hpp"
+#include "render/VideoRecorder.hpp"
+#else
+#include <glog/logging.h>
+#endif
+
+namespace rai {
+namespace Vis {
+
+#ifdef RAI_OFFSCREEN
+/// the scene of slungload_Visualizer without a window, for hosts without a display.
+/// drawWorld only renders the frames of a recorded video and never waits, a rollout is recorded as fast as it steps
+class slungload_OffscreenVisualizer {
+
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  /// one quadrotor and tether per team member, frames of the size of the on-screen window
+  explicit slungload_OffscreenVisualizer(int nQuadrotors = 1, int width = 1280, int height = 720);
+
+  void drawWorld(HomogeneousTransform &visualizationPose, rai::Position &quadPos, rai::Quaternion &quadAtt, rai::Position &loadPos);
+  /// column i of quadPos and quadAtt is quadrotor i
+  void drawWorld(HomogeneousTransform &visualizationPose, const Eigen::Matrix3Xd &quadPos,
+                 const Eigen::Matrix4Xd &quadAtt, const rai::Position &loadPos);
+
+  /// records dir/fileName.mp4 of a task stepping every dt. Every few steps are one frame, so the video has
+  /// about fps frames per simulated second, and it plays in real time
+  void startRecording(const std::string &dir, const std::string &fileName, double dt, double fps = 30.0);
+  void endRecording();
+  bool recording() const { return bool(video_); }
+
+  /// the last frame, rgb rows from the top
+  const std::vector<unsigned char> &frame() const { return frame_; }
+  rai::Render::OffscreenRenderer &getRenderer() { return renderer_; }
+
+ private:
+  int nQuadrotors_;
+  rai::Render::OffscreenRenderer renderer_;
+  std::unique_ptr<rai::Render::VideoRecorder> video_;
+  int stepsPerFrame_ = 1;
+  long steps_ = 0;
+  std::vector<unsigned char> frame_;
+};
+#else
+/// a build without EGL has no offscreen rendering, a headless task draws and records nothing
+class slungload_OffscreenVisualizer {
+
+ public:
+  explicit slungload_OffscreenVisualizer(int nQuadrotors = 1, int width = 1280, int height = 720) {}
+
+  void drawWorld(HomogeneousTransform &, rai::Position &, rai::Quaternion &, rai::Position &) {}
+  void drawWorld(HomogeneousTransform &, const Eigen::Matrix3Xd &, const Eigen::Matrix4Xd &, const rai::Position &) {}
+
+  void startRecording(const std::string &dir, const std::string &fileName, double dt, double fps = 30.0) {
+    LOG(WARNING) << "built without EGL, not recording " << dir << "/" << fileName << " on a host without a display";
+  }
+  void endRecording() {}
+  bool recording() const { return false; }
+};
+#endif
+
+}
+}
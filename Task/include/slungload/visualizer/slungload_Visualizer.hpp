@@ -1,10 +1,14 @@
 
+#pragma once
+
 #include "raiCommon/math/RAI_math.hpp"
 #include "raiGraphics/RAI_graphics.hpp"
 #include "raiGraphics/obj/Mesh.hpp"
 #include "raiGraphics/obj/Cylinder.hpp"
 #include "raiGraphics/obj/Sphere.hpp"
 #include "raiGraphics/obj/Quadrotor.hpp"
+#include <memory>
+#include <vector>
 
 
 
@@ -16,22 +20,30 @@ class slungload_Visualizer {
  public:
   using GeneralizedCoordinate = Eigen::Matrix<double, 10, 1>;
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
-  slungload_Visualizer();
+  /// one quadrotor and tether per team member
+  explicit slungload_Visualizer(int nQuadrotors = 1);
 
   ~slungload_Visualizer();
 
   void setTerrain(std::string fileName);
   void drawWorld(HomogeneousTransform &visualizationPose, rai::Position &quadPos, rai::Quaternion &quadAtt, rai::Position &loadPos);
+  /// column i of quadPos and quadAtt is quadrotor i
+  void drawWorld(HomogeneousTransform &visualizationPose, const Eigen::Matrix3Xd &quadPos,
+                 const Eigen::Matrix4Xd &quadAtt, const rai::Position &loadPos);
   rai_graphics::RAI_graphics* getGraphics();
 
+  /// the poses of the three segments drawn for the tether from quadPos to loadPos
+  static void tetherPoses(const rai::Position &quadPos, const rai::Position &loadPos, HomogeneousTransform poses[3]);
+
 private:
+  void drawTether(int i, const rai::Position &quadPos, const rai::Position &loadPos);
+
   rai_graphics::RAI_graphics graphics;
-  rai_graphics::object::Quadrotor quadrotor;
+  std::vector<std::unique_ptr<rai_graphics::object::Quadrotor>> quadrotors;
   rai_graphics::object::Sphere Target;
   rai_graphics::object::Sphere load;
-  rai_graphics::object::Cylinder tether1;
-  rai_graphics::object::Cylinder tether2;
-  rai_graphics::object::Cylinder tether3;
+  /// three segments per tether
+  std::vector<std::unique_ptr<rai_graphics::object::Cylinder>> tethers;
   rai_graphics::object::Background background;
 
   HomogeneousTransform defaultPose_;
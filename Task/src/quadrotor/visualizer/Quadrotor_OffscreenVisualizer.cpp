@@ -0,0 +1,51 @@
+#include "quadrotor/visualizer/Quadrotor_OffscreenVisualizer.hpp"
+#include <glog/logging.h>
+#include <algorithm>
+#include <cmath>
+
+namespace rai {
+namespace Vis {
+
+Quadrotor_OffscreenVisualizer::Quadrotor_OffscreenVisualizer(int width, int height) :
+    renderer_(width, height) {
+
+  /// the view of the on-screen window, 3 m behind the target at the origin
+  Eigen::Vector3d eye, target;
+  eye << -3, 0, 0;
+  target << 0, 0, 0;
+  renderer_.setCamera(eye, target);
+  LOG(INFO) << "rendering quadrotor videos offscreen on " << renderer_.device();
+}
+
+void Quadrotor_OffscreenVisualizer::drawWorld(HomogeneousTransform &bodyPose, Position &quadPos, Quaternion &quadAtt) {
+  if (!video_ || steps_++ % stepsPerFrame_ != 0) return;
+
+  HomogeneousTransform quadPose;
+  quadPose.setIdentity();
+  quadPose.topRightCorner(3, 1) = quadPos;
+  quadPose.topLeftCorner(3, 3) = rai::Math::MathFunc::quatToRotMat(quadAtt);
+
+  renderer_.beginFrame();
+  renderer_.drawGrid(-2.0, 5.0, 0.5, {{0.45f, 0.5f, 0.45f}});
+  renderer_.drawSphere(Eigen::Vector3d::Zero(), 0.055, {{1.0f, 0.0f, 0.0f}});
+  renderer_.drawQuadrotor(quadPose, 0.15, {{0.35f, 0.35f, 0.4f}});
+  renderer_.endFrame(frame_);
+  video_->write(frame_);
+}
+
+void Quadrotor_OffscreenVisualizer::startRecording(const std::string &dir, const std::string &fileName, double dt, double fps) {
+  stepsPerFrame_ = std::max(1, int(std::round(1.0 / (fps * dt))));
+  steps_ = 0;
+  video_.reset(new rai::Render::VideoRecorder(dir + "/" + fileName + ".mp4", renderer_.width(), renderer_.height(),
+                                              1.0 / (stepsPerFrame_ * dt)));
+}
+
+void Quadrotor_OffscreenVisualizer::endRecording() {
+  if (!video_) return;
+  video_->close();
+  LOG(INFO) << "recorded " << video_->frames() << " frames to " << video_->path();
+  video_.reset();
+}
+
+}
+}
@@ -0,0 +1,115 @@
+#include "slungload/visualizer/slungload_GridVisualizer.hpp"
+#include "slungload/visualizer/slungload_Visualizer.hpp"
+#include <glog/logging.h>
+#include <cmath>
+
+namespace rai {
+namespace Vis {
+
+slungload_GridVisualizer::slungload_GridVisualizer(int nEnvs, Layout layout, double spacing) :
+    graphics(1280, 720),
+    center(0.001),
+    background("sky"),
+    layout_(layout),
+    spacing_(spacing),
+    columns_(int(std::ceil(std::sqrt(double(nEnvs))))),
+    failed_(nEnvs, 0) {
+  LOG_IF(FATAL, nEnvs < 1) << "the grid needs at least one env";
+
+  /// overlaid bodies are translucent so the envs behind them stay visible
+  const float transparency = layout == Layout::overlaid ? 0.3f : 1.0f;
+  for (int i = 0; i < nEnvs; i++) {
+    quadrotors.emplace_back(new rai_graphics::object::Quadrotor(0.3));
+    loads.emplace_back(new rai_graphics::object::Sphere(0.03));
+    loads.back()->setColor({0.0, 1.0, 0.0});
+    loads.back()->setTransparency(transparency);
+    for (int segment = 0; segment < 3; segment++) {
+      tethers.emplace_back(new rai_graphics::object::Cylinder(0.001, 0.3));
+      tethers.back()->setTransparency(transparency);
+    }
+  }
+
+  defaultPose_.setIdentity();
+  rai::Math::MathFunc::rotateHTabout_x_axis(defaultPose_, -M_PI_2);
+
+  for (auto &quadrotor : quadrotors)
+    graphics.addSuperObject(quadrotor.get());
+  for (auto &load : loads)
+    graphics.addObject(load.get());
+  for (auto &tether : tethers)
+    graphics.addObject(tether.get());
+  graphics.addObject(&center);
+  graphics.addBackground(&background);
+
+  /// far enough back to see the whole grid
+  const double extent = layout == Layout::tiled ? spacing * columns_ : 2.0;
+  Eigen::Vector3d relPos;
+  relPos << -0.9 * extent - 3.0, 0, 0.5 * extent + 1.0;
+  std::vector<float> pos = {-100, 0, 0}, spec = {0.7, 0.7, 0.7}, amb = {0.7, 0.7, 0.7}, diff = {0.7, 0.7, 0.7};
+
+  rai_graphics::LightProp lprop;
+  lprop.amb_light = amb;
+  lprop.spec_light = spec;
+  lprop.diff_light = diff;
+  lprop.pos_light = pos;
+  rai_graphics::CameraProp cprop;
+  cprop.toFollow = &center;
+  cprop.relativeDist = relPos;
+
+  graphics.setCameraProp(cprop);
+  graphics.setLightProp(lprop);
+  graphics.start();
+}
+
+slungload_GridVisualizer::~slungload_GridVisualizer() {
+  graphics.end();
+}
+
+Position slungload_GridVisualizer::offset(int env) const {
+  Position offset;
+  offset.setZero();
+  if (layout_ == Layout::overlaid) return offset;
+  const int rows = (envs() + columns_ - 1) / columns_;
+  offset(0) = (env / columns_ - 0.5 * (rows - 1)) * spacing_;
+  offset(1) = (env % columns_ - 0.5 * (columns_ - 1)) * spacing_;
+  return offset;
+}
+
+void slungload_GridVisualizer::setFailed(int env, bool failed) {
+  if (failed_[env] == char(failed)) return;
+  failed_[env] = failed;
+  loads[env]->setColor(failed ? std::vector<float>{1.0, 0.0, 0.0} : std::vector<float>{0.0, 1.0, 0.0});
+  /// a failure is never hidden behind the other envs
+  loads[env]->setTransparency(failed || layout_ == Layout::tiled ? 1.0f : 0.3f);
+}
+
+void slungload_GridVisualizer::drawWorld(const Coordinates &q) {
+  LOG_IF(FATAL, q.cols() != envs()) << "expected " << envs() << " envs";
+  HomogeneousTransform quadPose, poses[3];
+
+  for (int i = 0; i < envs(); i++) {
+    const Position shift = offset(i);
+    const Quaternion att = q.col(i).head<4>();
+    const Position quadPos = q.col(i).segment<3>(4) + shift;
+    const Position loadPos = q.col(i).tail<3>() + shift;
+
+    quadPose.setIdentity();
+    quadPose.topRightCorner(3, 1) = quadPos;
+    quadPose.topLeftCorner(3, 3) = rai::Math::MathFunc::quatToRotMat(att);
+    quadPose = quadPose * defaultPose_;
+    quadrotors[i]->setPose(quadPose);
+    if (!failed_[i]) quadrotors[i]->spinRotors();
+
+    slungload_Visualizer::tetherPoses(quadPos, loadPos, poses);
+    for (int segment = 0; segment < 3; segment++)
+      tethers[3 * i + segment]->setPose(poses[segment]);
+    loads[i]->setPos(loadPos);
+  }
+}
+
+rai_graphics::RAI_graphics *slungload_GridVisualizer::getGraphics() {
+  return &graphics;
+}
+
+}
+}
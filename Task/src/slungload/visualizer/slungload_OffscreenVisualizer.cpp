@@ -0,0 +1,66 @@
+#include "slungload/visualizer/slungload_OffscreenVisualizer.hpp"
+#include <glog/logging.h>
+#include <algorithm>
+#include <cmath>
+
+namespace rai {
+namespace Vis {
+
+slungload_OffscreenVisualizer::slungload_OffscreenVisualizer(int nQuadrotors, int width, int height) :
+    nQuadrotors_(nQuadrotors),
+    renderer_(width, height) {
+
+  /// the view of the on-screen window, 3 m behind and 1 m above the target at the origin
+  Eigen::Vector3d eye, target;
+  eye << -3, 0, 1;
+  target << 0, 0, 0;
+  renderer_.setCamera(eye, target);
+  LOG(INFO) << "rendering slungload videos offscreen on " << renderer_.device();
+}
+
+void slungload_OffscreenVisualizer::drawWorld(HomogeneousTransform &bodyPose, Position &quadPos, Quaternion &quadAtt,
+                                              Position &loadPos) {
+  drawWorld(bodyPose, Eigen::Matrix3Xd(quadPos), Eigen::Matrix4Xd(quadAtt), loadPos);
+}
+
+void slungload_OffscreenVisualizer::drawWorld(HomogeneousTransform &bodyPose,
+                                              const Eigen::Matrix3Xd &quadPos,
+                                              const Eigen::Matrix4Xd &quadAtt,
+                                              const Position &loadPos) {
+  LOG_IF(FATAL, quadPos.cols() != nQuadrotors_ || quadAtt.cols() != quadPos.cols())
+  << "expected " << nQuadrotors_ << " quadrotors";
+  if (!video_ || steps_++ % stepsPerFrame_ != 0) return;
+
+  renderer_.beginFrame();
+  renderer_.drawGrid(-2.0, 5.0, 0.5, {{0.45f, 0.5f, 0.45f}});
+  renderer_.drawSphere(Eigen::Vector3d::Zero(), 0.055, {{1.0f, 0.0f, 0.0f}});
+  HomogeneousTransform quadPose;
+  for (int i = 0; i < quadPos.cols(); i++) {
+    Quaternion att = quadAtt.col(i);
+    quadPose.setIdentity();
+    quadPose.topRightCorner(3, 1) = quadPos.col(i);
+    quadPose.topLeftCorner(3, 3) = rai::Math::MathFunc::quatToRotMat(att);
+    renderer_.drawQuadrotor(quadPose, 0.15, {{0.35f, 0.35f, 0.4f}});
+    renderer_.drawSegment(quadPos.col(i), loadPos, 0.004, {{0.2f, 0.2f, 0.2f}});
+  }
+  renderer_.drawSphere(loadPos, 0.03, {{0.0f, 1.0f, 0.0f}});
+  renderer_.endFrame(frame_);
+  video_->write(frame_);
+}
+
+void slungload_OffscreenVisualizer::startRecording(const std::string &dir, const std::string &fileName, double dt, double fps) {
+  stepsPerFrame_ = std::max(1, int(std::round(1.0 / (fps * dt))));
+  steps_ = 0;
+  video_.reset(new rai::Render::VideoRecorder(dir + "/" + fileName + ".mp4", renderer_.width(), renderer_.height(),
+                                              1.0 / (stepsPerFrame_ * dt)));
+}
+
+void slungload_OffscreenVisualizer::endRecording() {
+  if (!video_) return;
+  video_->close();
+  LOG(INFO) << "recorded " << video_->frames() << " frames to " << video_->path();
+  video_.reset();
+}
+
+}
+}
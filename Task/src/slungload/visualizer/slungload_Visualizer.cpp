@@ -1,31 +1,34 @@
 
 #include "slungload/visualizer/slungload_Visualizer.hpp"
+#include <glog/logging.h>
 
 namespace rai {
 namespace Vis {
 
-slungload_Visualizer::slungload_Visualizer() :
+slungload_Visualizer::slungload_Visualizer(int nQuadrotors) :
     graphics(1280, 720),
-    quadrotor(0.3),
     load(0.03),
     Target(0.055),
-    tether1(0.001, 0.3),
-    tether2(0.001, 0.3),
-    tether3(0.001, 0.3),
     background("sky"){
 
+  for (int i = 0; i < nQuadrotors; i++) {
+    quadrotors.emplace_back(new rai_graphics::object::Quadrotor(0.3));
+    for (int segment = 0; segment < 3; segment++)
+      tethers.emplace_back(new rai_graphics::object::Cylinder(0.001, 0.3));
+  }
+
   Target.setColor({1.0, 0.0, 0.0});
   load.setColor({0.0, 1.0, 0.0});
 
   defaultPose_.setIdentity();
   rai::Math::MathFunc::rotateHTabout_x_axis(defaultPose_, -M_PI_2);
 
-  graphics.addSuperObject(&quadrotor);
+  for (auto &quadrotor : quadrotors)
+    graphics.addSuperObject(quadrotor.get());
   graphics.addObject(&Target);
   graphics.addObject(&load);
-  graphics.addObject(&tether1);
-  graphics.addObject(&tether2);
-  graphics.addObject(&tether3);
+  for (auto &tether : tethers)
+    graphics.addObject(tether.get());
   graphics.addBackground(&background);
   //graphics.setBackgroundColor(1, 1, 1, 1);
 
@@ -53,33 +56,55 @@ slungload_Visualizer::~slungload_Visualizer() {
 }
 
 void slungload_Visualizer::drawWorld(HomogeneousTransform &bodyPose, Position &quadPos, Quaternion &quadAtt, Position &loadPos) {
+  drawWorld(bodyPose, Eigen::Matrix3Xd(quadPos), Eigen::Matrix4Xd(quadAtt), loadPos);
+}
+
+void slungload_Visualizer::drawWorld(HomogeneousTransform &bodyPose,
+                                     const Eigen::Matrix3Xd &quadPos,
+                                     const Eigen::Matrix4Xd &quadAtt,
+                                     const Position &loadPos) {
+  LOG_IF(FATAL, quadPos.cols() != long(quadrotors.size()) || quadAtt.cols() != quadPos.cols())
+  << "expected " << quadrotors.size() << " quadrotors";
   Eigen::Vector3d pos;
   Eigen::Vector3d end;
-  HomogeneousTransform quadPose, tetherPose;
-  Quaternion tetherAtt;
+  HomogeneousTransform quadPose;
   RotationMatrix rotmat;
-  Position zAxis, loadDir;
-  zAxis << 0.0, 0.0, 1.0;
 
   rotmat = bodyPose.topLeftCorner(3, 3);
   pos = bodyPose.topRightCorner(3, 1);
-
-  quadPose.setIdentity();
-  quadPose.topRightCorner(3, 1) = quadPos;
-  quadPose.topLeftCorner(3,3) = rai::Math::MathFunc::quatToRotMat(quadAtt);
   end = rotmat * end;
-  quadPose = quadPose * defaultPose_;
 
-  quadrotor.setPose(quadPose);
-  quadrotor.spinRotors();
+  for (int i = 0; i < quadPos.cols(); i++) {
+    Quaternion att = quadAtt.col(i);
+    quadPose.setIdentity();
+    quadPose.topRightCorner(3, 1) = quadPos.col(i);
+    quadPose.topLeftCorner(3,3) = rai::Math::MathFunc::quatToRotMat(att);
+    quadPose = quadPose * defaultPose_;
+
+    quadrotors[i]->setPose(quadPose);
+    quadrotors[i]->spinRotors();
+    drawTether(i, quadPos.col(i), loadPos);
+  }
 
   load.setPos(loadPos);
+  Target.setPos(end);
 
-  tetherPose.setIdentity();
-  loadDir = quadPos - loadPos;
+}
+
+void slungload_Visualizer::drawTether(int i, const Position &quadPos, const Position &loadPos) {
+  HomogeneousTransform poses[3];
+  tetherPoses(quadPos, loadPos, poses);
+  for (int segment = 0; segment < 3; segment++)
+    tethers[3 * i + segment]->setPose(poses[segment]);
+}
+
+void slungload_Visualizer::tetherPoses(const Position &quadPos, const Position &loadPos,
+                                       HomogeneousTransform poses[3]) {
+  HomogeneousTransform tetherPose;
+  Position loadDir = quadPos - loadPos;
 
   // by dh
-  Position xAxis, yAxis;
+  Position xAxis, yAxis, zAxis;
   RotationMatrix tetherRotmat;
 
   zAxis = loadDir;
@@ -97,16 +122,14 @@ void slungload_Visualizer::drawWorld(HomogeneousTransform &bodyPose, Position &q
                   xAxis(1), yAxis(1), zAxis(1),
                   xAxis(2), yAxis(2), zAxis(2);
 
+  tetherPose.setIdentity();
   tetherPose.topLeftCorner(3,3) = tetherRotmat;
   tetherPose.topRightCorner(3,1) = quadPos + 1./3.*(loadPos - quadPos) + 0.15*(quadPos - loadPos);
-  tether1.setPose(tetherPose);
+  poses[0] = tetherPose;
   tetherPose.topRightCorner(3,1) = quadPos + 2./3.*(loadPos - quadPos) + 0.15*(quadPos - loadPos);
-  tether2.setPose(tetherPose);
+  poses[1] = tetherPose;
   tetherPose.topRightCorner(3,1) = loadPos + 0.15*(quadPos - loadPos);
-  tether3.setPose(tetherPose);
-
-  Target.setPos(end);
-
+  poses[2] = tetherPose;
 }
 
 rai_graphics::RAI_graphics *slungload_Visualizer::getGraphics() {
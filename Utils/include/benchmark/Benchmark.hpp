@@ -0,0 +1,103 @@
+//
+// Small benchmark runner for the simulation hot paths. Every benchmark is
+// calibrated to a minimum batch time and repeated, the report gives robust
+// statistics per operation and can be written as JSON for comparing commits.
+//
+
+#ifndef RAI_BENCHMARK_BENCHMARK_HPP
+#define RAI_BENCHMARK_BENCHMARK_HPP
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace rai {
+namespace Bench {
+
+/// keeps the compiler from optimizing a result away
+template<typename T>
+inline void doNotOptimize(T const &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Result {
+  std::string group, name;
+  int repetitions;
+  long iterationsPerRepetition;
+  double nsMedian, nsMean, nsStddev, nsMin, nsMax;
+  double nsCi95;   // half width of the 95% confidence interval of the mean
+  double nsMad;    // median absolute deviation
+
+  double opsPerSecond() const { return 1e9 / nsMedian; }
+};
+
+struct Options {
+  int repetitions = 20;
+  double minBatchSeconds = 0.01;
+  std::string filter;        // run only benchmarks whose "group/name" contains this
+  std::string jsonPath;      // empty: no json output
+  bool visualization = true; // benchmark the drawWorld paths, needs a display
+};
+
+class Runner {
+
+ public:
+  /// --reps N --min-time SEC --filter STR --json PATH --no-vis
+  Runner(int argc, char *argv[]);
+  explicit Runner(const Options &options) : options_(options) {}
+
+  const Options &options() const { return options_; }
+  bool enabled(const std::string &group, const std::string &name) const;
+
+  /// measures op(), which performs one operation. setup() runs untimed before every repetition
+  template<typename Op, typename Setup>
+  void run(const std::string &group, const std::string &name, Op op, Setup setup) {
+    if (!enabled(group, name)) return;
+    using Clock = std::chrono::steady_clock;
+
+    /// warm up and find a batch size that takes at least minBatchSeconds
+    long iterations = 1;
+    while (true) {
+      setup();
+      auto start = Clock::now();
+      for (long i = 0; i < iterations; i++) op();
+      double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+      if (elapsed >= options_.minBatchSeconds || iterations >= (1l << 30)) break;
+      iterations = elapsed <= 0 ? iterations * 10 :
+                   std::max(iterations * 2, long(iterations * 1.2 * options_.minBatchSeconds / elapsed));
+    }
+
+    std::vector<double> nsPerOp;
+    for (int rep = 0; rep < options_.repetitions; rep++) {
+      setup();
+      auto start = Clock::now();
+      for (long i = 0; i < iterations; i++) op();
+      nsPerOp.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations);
+    }
+    record(group, name, iterations, nsPerOp);
+  }
+
+  template<typename Op>
+  void run(const std::string &group, const std::string &name, Op op) {
+    run(group, name, op, []() {});
+  }
+
+  /// prints a table and writes the json file if requested
+  void report() const;
+
+  const std::vector<Result> &results() const { return results_; }
+
+ private:
+  void record(const std::string &group, const std::string &name, long iterations, std::vector<double> &nsPerOp);
+
+  Options options_;
+  std::vector<Result> results_;
+};
+
+/// escapes a string for embedding in json
+std::string jsonString(const std::string &str);
+
+}
+}
+
+#endif //RAI_BENCHMARK_BENCHMARK_HPP
@@ -0,0 +1,280 @@
+//
+// Compact storage for the state batches of many rollout steps. A state stores
+// its orientation as a 9-entry rotation matrix and the rest as doubles; here
+// the rotation becomes a quaternion in smallest-three form (the largest
+// component is dropped and rebuilt from the unit norm, the other three are
+// quantized), every other row is quantized with its own error bound, and each
+// env's integer codes are stored as varint deltas to its previous step. The
+// deltas are taken after quantization, so the error never accumulates along
+// the time axis. A keyframe every keyframeInterval steps restarts the deltas,
+// so decoding can start there instead of at the first step.
+// Batches are time-major like the rollout chunks, column t * nEnvs + e:
+//   auto layout = CompressedTrajectory<double, 24>::Layout::uniform(1e-3, 0);
+//   CompressedTrajectory<double, 24> buffer(nEnvs, layout);
+//   buffer.append(states);
+//   buffer.decode(beginStep, nSteps, states);
+// A Reader decodes one step after the other for a pass over the whole buffer.
+// A normalized state carries no rotation matrix; leave rotationRow at -1 for it.
+//
+
+#ifndef RAI_COMPRESSION_COMPRESSEDTRAJECTORY_HPP
+#define RAI_COMPRESSION_COMPRESSEDTRAJECTORY_HPP
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "glog/logging.h"
+
+namespace rai {
+namespace Compression {
+
+namespace detail {
+
+inline void writeVarint(std::vector<uint8_t> &bytes, int64_t value) {
+  uint64_t zigzag = (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+  while (zigzag >= 0x80) {
+    bytes.push_back(uint8_t(zigzag | 0x80));
+    zigzag >>= 7;
+  }
+  bytes.push_back(uint8_t(zigzag));
+}
+
+inline int64_t readVarint(const uint8_t *&ptr) {
+  uint64_t zigzag = 0;
+  int shift = 0;
+  while (*ptr & 0x80) {
+    zigzag |= uint64_t(*ptr++ & 0x7f) << shift;
+    shift += 7;
+  }
+  zigzag |= uint64_t(*ptr++) << shift;
+  return int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1);
+}
+
+}
+
+template<typename Dtype, int Dim>
+class CompressedTrajectory {
+ public:
+  using Batch = Eigen::Matrix<Dtype, Dim, Eigen::Dynamic>;
+  using Codes = Eigen::Matrix<int64_t, Dim, Eigen::Dynamic>;
+
+  struct Layout {
+    /// first of the 9 rows holding a column-major rotation matrix, -1 if the state has none
+    int rotationRow = -1;
+    /// bits per stored quaternion component, a component is off by at most rotationQuantum() / 2
+    /// and a rotation matrix entry by about 3 rotationQuantum(), 7e-5 with 16 bits
+    int quaternionBits = 16;
+    /// bound on the decoding error of every other row
+    Eigen::Array<double, Dim, 1> maxError = Eigen::Array<double, Dim, 1>::Constant(1e-3);
+
+    static Layout uniform(double maxError, int rotationRow = -1) {
+      Layout layout;
+      layout.rotationRow = rotationRow;
+      layout.maxError.setConstant(maxError);
+      return layout;
+    }
+
+    double rotationQuantum() const { return std::sqrt(0.5) / double((int64_t(1) << (quaternionBits - 1)) - 1); }
+  };
+
+  CompressedTrajectory(int nEnvs, const Layout &layout, int keyframeInterval = 32) :
+      nEnvs_(nEnvs), keyframeInterval_(keyframeInterval), layout_(layout), previous_(Dim, nEnvs) {
+    LOG_IF(FATAL, layout.rotationRow > std::max(Dim - 9, -1) || layout.quaternionBits < 2 || layout.quaternionBits > 30)
+    << "compressed trajectory: invalid rotation layout";
+    for (int i = 0; i < Dim; i++) {
+      if (isRotationRow(i)) continue;
+      LOG_IF(FATAL, !(layout.maxError(i) > 0.0)) << "compressed trajectory: every error bound has to be positive";
+      inverseQuantum_(i) = 0.5 / layout.maxError(i);
+    }
+  }
+
+  int nEnvs() const { return nEnvs_; }
+  int nSteps() const { return nSteps_; }
+  const Layout &layout() const { return layout_; }
+
+  /// memory held by the encoded steps, for comparison with nSteps() * nEnvs() * Dim * sizeof(Dtype)
+  size_t bytes() const { return bytes_.size() + keyframes_.size() * sizeof(size_t); }
+
+  void clear() {
+    bytes_.clear();
+    keyframes_.clear();
+    nSteps_ = 0;
+  }
+
+  /// appends whole steps, states holds nEnvs columns per step
+  void append(const Batch &states) {
+    LOG_IF(FATAL, states.cols() % nEnvs_ != 0) << "compressed trajectory: a batch has to hold whole steps";
+    Eigen::Matrix<int64_t, Dim, 1> codes;
+    for (long col = 0; col < states.cols(); col += nEnvs_) {
+      if (nSteps_ % keyframeInterval_ == 0) {
+        keyframes_.push_back(bytes_.size());
+        previous_.setZero();
+      }
+      for (int e = 0; e < nEnvs_; e++) {
+        quantize(states.col(col + e), codes);
+        writeCodes(codes, previous_.col(e));
+        previous_.col(e) = codes;
+      }
+      nSteps_++;
+    }
+  }
+
+  /// decodes the steps one after the other, starting at any step
+  class Reader {
+   public:
+    Reader(const CompressedTrajectory &trajectory, int beginStep) :
+        trajectory_(trajectory), previous_(Dim, trajectory.nEnvs_) {
+      LOG_IF(FATAL, beginStep < 0 || beginStep > trajectory.nSteps_) << "compressed trajectory: step out of range";
+      step_ = beginStep - beginStep % trajectory.keyframeInterval_;
+      if (step_ == trajectory.nSteps_) return;
+      ptr_ = trajectory.bytes_.data() + trajectory.keyframes_[step_ / trajectory.keyframeInterval_];
+      previous_.setZero();
+      Eigen::Matrix<int64_t, Dim, 1> codes;
+      while (step_ < beginStep) {
+        for (int e = 0; e < trajectory_.nEnvs_; e++) {
+          trajectory_.readCodes(ptr_, previous_.col(e), codes);
+          previous_.col(e) = codes;
+        }
+        step_++;
+      }
+    }
+
+    int step() const { return step_; }
+    bool done() const { return step_ == trajectory_.nSteps_; }
+
+    /// writes the next step to the nEnvs columns of out from column col on
+    void next(Batch &out, long col = 0) {
+      LOG_IF(FATAL, done()) << "compressed trajectory: read past the last step";
+      if (step_ % trajectory_.keyframeInterval_ == 0) previous_.setZero();
+      Eigen::Matrix<int64_t, Dim, 1> codes;
+      for (int e = 0; e < trajectory_.nEnvs_; e++) {
+        trajectory_.readCodes(ptr_, previous_.col(e), codes);
+        trajectory_.dequantize(codes, out.col(col + e));
+        previous_.col(e) = codes;
+      }
+      step_++;
+    }
+
+   private:
+    const CompressedTrajectory &trajectory_;
+    Codes previous_;
+    const uint8_t *ptr_ = nullptr;
+    int step_;
+  };
+
+  /// decodes nSteps steps from beginStep on into out, resized to nSteps * nEnvs columns
+  void decode(int beginStep, int nSteps, Batch &out) const {
+    LOG_IF(FATAL, nSteps < 0 || beginStep + nSteps > nSteps_) << "compressed trajectory: step out of range";
+    out.resize(Dim, long(nSteps) * nEnvs_);
+    Reader reader(*this, beginStep);
+    for (int t = 0; t < nSteps; t++)
+      reader.next(out, long(t) * nEnvs_);
+  }
+
+ private:
+  bool isRotationRow(int i) const {
+    return layout_.rotationRow >= 0 && i >= layout_.rotationRow && i < layout_.rotationRow + 9;
+  }
+
+  /// the first four rotation rows hold the three kept quaternion components and the index of the dropped one
+  template<typename Column>
+  void quantize(const Column &state, Eigen::Matrix<int64_t, Dim, 1> &codes) const {
+    for (int i = 0; i < Dim; i++)
+      codes(i) = isRotationRow(i) ? 0 : std::llround(double(state(i)) * inverseQuantum_(i));
+    if (layout_.rotationRow < 0) return;
+
+    const int r = layout_.rotationRow;
+    auto R = [&](int i, int j) { return double(state(r + 3 * j + i)); };
+    double q[4]; // w, x, y, z
+    const double trace = R(0, 0) + R(1, 1) + R(2, 2);
+    if (trace > 0.0) {
+      const double s = 2.0 * std::sqrt(trace + 1.0);
+      q[0] = 0.25 * s, q[1] = (R(2, 1) - R(1, 2)) / s, q[2] = (R(0, 2) - R(2, 0)) / s, q[3] = (R(1, 0) - R(0, 1)) / s;
+    } else if (R(0, 0) > R(1, 1) && R(0, 0) > R(2, 2)) {
+      const double s = 2.0 * std::sqrt(1.0 + R(0, 0) - R(1, 1) - R(2, 2));
+      q[0] = (R(2, 1) - R(1, 2)) / s, q[1] = 0.25 * s, q[2] = (R(0, 1) + R(1, 0)) / s, q[3] = (R(0, 2) + R(2, 0)) / s;
+    } else if (R(1, 1) > R(2, 2)) {
+      const double s = 2.0 * std::sqrt(1.0 + R(1, 1) - R(0, 0) - R(2, 2));
+      q[0] = (R(0, 2) - R(2, 0)) / s, q[1] = (R(0, 1) + R(1, 0)) / s, q[2] = 0.25 * s, q[3] = (R(1, 2) + R(2, 1)) / s;
+    } else {
+      const double s = 2.0 * std::sqrt(1.0 + R(2, 2) - R(0, 0) - R(1, 1));
+      q[0] = (R(1, 0) - R(0, 1)) / s, q[1] = (R(0, 2) + R(2, 0)) / s, q[2] = (R(1, 2) + R(2, 1)) / s, q[3] = 0.25 * s;
+    }
+
+    int largest = 0;
+    for (int k = 1; k < 4; k++)
+      if (std::abs(q[k]) > std::abs(q[largest])) largest = k;
+    /// q and -q are the same rotation, the dropped component is made positive
+    const double sign = q[largest] < 0.0 ? -1.0 : 1.0;
+    const double norm = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    const double scale = sign / (norm * layout_.rotationQuantum());
+    for (int k = 0, kept = 0; k < 4; k++)
+      if (k != largest) codes(r + kept++) = std::llround(q[k] * scale);
+    codes(r + 3) = largest;
+  }
+
+  template<typename Column>
+  void dequantize(const Eigen::Matrix<int64_t, Dim, 1> &codes, Column &&state) const {
+    for (int i = 0; i < Dim; i++)
+      if (!isRotationRow(i)) state(i) = Dtype(double(codes(i)) / inverseQuantum_(i));
+    if (layout_.rotationRow < 0) return;
+
+    const int r = layout_.rotationRow;
+    const int largest = int(codes(r + 3));
+    double q[4], squaredSum = 0.0;
+    for (int k = 0, kept = 0; k < 4; k++) {
+      if (k == largest) continue;
+      q[k] = double(codes(r + kept++)) * layout_.rotationQuantum();
+      squaredSum += q[k] * q[k];
+    }
+    q[largest] = std::sqrt(std::max(0.0, 1.0 - squaredSum));
+    const double w = q[0], x = q[1], y = q[2], z = q[3];
+    const double rotation[9] = {1.0 - 2.0 * (y * y + z * z), 2.0 * (x * y + w * z), 2.0 * (x * z - w * y),
+                                2.0 * (x * y - w * z), 1.0 - 2.0 * (x * x + z * z), 2.0 * (y * z + w * x),
+                                2.0 * (x * z + w * y), 2.0 * (y * z - w * x), 1.0 - 2.0 * (x * x + y * y)};
+    for (int k = 0; k < 9; k++)
+      state(r + k) = Dtype(rotation[k]);
+  }
+
+  /// the dropped component's index rides in the low two bits of the first delta
+  template<typename Previous>
+  void writeCodes(const Eigen::Matrix<int64_t, Dim, 1> &codes, const Previous &previous) {
+    const int r = layout_.rotationRow;
+    for (int i = 0; i < Dim; i++) {
+      if (isRotationRow(i) && i == r)
+        detail::writeVarint(bytes_, (codes(i) - previous(i)) * 4 + codes(r + 3));
+      else if (!isRotationRow(i) || i < r + 3)
+        detail::writeVarint(bytes_, codes(i) - previous(i));
+    }
+  }
+
+  template<typename Previous>
+  void readCodes(const uint8_t *&ptr, const Previous &previous, Eigen::Matrix<int64_t, Dim, 1> &codes) const {
+    const int r = layout_.rotationRow;
+    codes = previous;
+    for (int i = 0; i < Dim; i++) {
+      if (isRotationRow(i) && i == r) {
+        const int64_t value = detail::readVarint(ptr);
+        const int64_t index = value & 3;
+        codes(i) += (value - index) / 4;
+        codes(r + 3) = index;
+      } else if (!isRotationRow(i) || i < r + 3) {
+        codes(i) += detail::readVarint(ptr);
+      }
+    }
+  }
+
+  int nEnvs_, keyframeInterval_, nSteps_ = 0;
+  Layout layout_;
+  Eigen::Array<double, Dim, 1> inverseQuantum_ = Eigen::Array<double, Dim, 1>::Zero();
+  Codes previous_;
+  std::vector<uint8_t> bytes_;
+  std::vector<size_t> keyframes_;
+};
+
+}
+}
+
+#endif //RAI_COMPRESSION_COMPRESSEDTRAJECTORY_HPP
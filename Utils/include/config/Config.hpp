@@ -0,0 +1,162 @@
+//
+// Runtime configuration of the trainer and the sweep runner. A config is a
+// file of "key = value" lines, '#' starts a comment, and "key=value"
+// arguments on the command line override the file.
+//
+
+#ifndef RAI_CONFIG_CONFIG_HPP
+#define RAI_CONFIG_CONFIG_HPP
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "glog/logging.h"
+
+namespace rai {
+namespace Config {
+
+inline std::string trim(const std::string &text) {
+  auto begin = text.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) return "";
+  auto end = text.find_last_not_of(" \t\r\n");
+  return text.substr(begin, end - begin + 1);
+}
+
+inline std::vector<std::string> split(const std::string &text, char separator) {
+  std::vector<std::string> parts;
+  std::stringstream stream(text);
+  std::string part;
+  while (std::getline(stream, part, separator))
+    parts.push_back(trim(part));
+  return parts;
+}
+
+class Config {
+ public:
+
+  Config() = default;
+
+  explicit Config(const std::string &path) { load(path); }
+
+  void load(const std::string &path) {
+    std::ifstream file(path);
+    LOG_IF(FATAL, !file) << "config: cannot open " << path;
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); lineNumber++) {
+      line = trim(line.substr(0, line.find('#')));
+      if (line.empty()) continue;
+      LOG_IF(FATAL, !parseEntry(line)) << "config: " << path << ":" << lineNumber << " is not \"key = value\"";
+    }
+  }
+
+  /// reads "key=value" arguments from argv[first] on
+  void parseArguments(int argc, char *argv[], int first) {
+    for (int i = first; i < argc; i++)
+      LOG_IF(FATAL, !parseEntry(argv[i])) << "config: argument " << argv[i] << " is not key=value";
+  }
+
+  void set(const std::string &key, const std::string &value) { entries_[key] = value; }
+
+  void erase(const std::string &key) { entries_.erase(key); }
+
+  bool has(const std::string &key) const { return entries_.count(key) != 0; }
+
+  std::string get(const std::string &key) const {
+    auto entry = entries_.find(key);
+    LOG_IF(FATAL, entry == entries_.end()) << "config: missing " << key;
+    used_.insert(key);
+    return entry->second;
+  }
+
+  std::string get(const std::string &key, const std::string &fallback) const {
+    return has(key) ? get(key) : fallback;
+  }
+
+  std::string get(const std::string &key, const char *fallback) const {
+    return get(key, std::string(fallback));
+  }
+
+  double get(const std::string &key, double fallback) const {
+    return has(key) ? toNumber(key) : fallback;
+  }
+
+  int get(const std::string &key, int fallback) const {
+    return has(key) ? int(toNumber(key)) : fallback;
+  }
+
+  bool get(const std::string &key, bool fallback) const {
+    if (!has(key)) return fallback;
+    std::string value = get(key);
+    return value == "1" || value == "true" || value == "yes" || value == "on";
+  }
+
+  const std::map<std::string, std::string> &entries() const { return entries_; }
+
+  /// keys that were set but never read, a typo in a config file otherwise goes unnoticed
+  std::vector<std::string> unusedKeys() const {
+    std::vector<std::string> unused;
+    for (auto &entry : entries_)
+      if (!used_.count(entry.first)) unused.push_back(entry.first);
+    return unused;
+  }
+
+  std::string toString() const {
+    std::string text;
+    for (auto &entry : entries_)
+      text += entry.first + " = " + entry.second + "\n";
+    return text;
+  }
+
+  void save(const std::string &path) const {
+    std::ofstream file(path);
+    LOG_IF(FATAL, !file) << "config: cannot write " << path;
+    file << toString();
+  }
+
+ private:
+
+  bool parseEntry(const std::string &entry) {
+    auto separator = entry.find('=');
+    if (separator == std::string::npos) return false;
+    std::string key = trim(entry.substr(0, separator));
+    if (key.empty()) return false;
+    entries_[key] = trim(entry.substr(separator + 1));
+    return true;
+  }
+
+  double toNumber(const std::string &key) const {
+    std::string value = get(key);
+    char *end = nullptr;
+    double number = std::strtod(value.c_str(), &end);
+    LOG_IF(FATAL, value.empty() || end != value.c_str() + value.size())
+    << "config: " << key << " = " << value << " is not a number";
+    return number;
+  }
+
+  std::map<std::string, std::string> entries_;
+  mutable std::set<std::string> used_;
+};
+
+/// every combination of the comma separated values of a sweep spec, "lambda = 0.95, 0.97" gives two configs
+inline std::vector<Config> expandGrid(const Config &spec) {
+  std::vector<Config> grid(1);
+  for (auto &entry : spec.entries()) {
+    std::vector<Config> expanded;
+    for (auto &config : grid)
+      for (auto &value : split(entry.second, ',')) {
+        expanded.push_back(config);
+        expanded.back().set(entry.first, value);
+      }
+    grid.swap(expanded);
+  }
+  return grid;
+}
+
+}
+}
+
+#endif //RAI_CONFIG_CONFIG_HPP
@@ -0,0 +1,158 @@
+//
+// Binary payloads exchanged between the learner and the rollout workers.
+// Trajectory data travels as float32, policy parameters keep full precision
+// so that the workers act with exactly the learner's policy.
+//
+
+#ifndef RAI_DISTRIBUTED_ROLLOUTPROTOCOL_HPP
+#define RAI_DISTRIBUTED_ROLLOUTPROTOCOL_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <Eigen/Core>
+#include "glog/logging.h"
+#include "raiCommon/enumeration.hpp"
+
+namespace rai {
+namespace Distributed {
+
+struct HelloMsg {
+  uint32_t workerId;
+  uint32_t nEnvs;
+  uint32_t stateDim;
+  uint32_t actionDim;
+  uint32_t paramSize;
+};
+
+struct RequestMsg {
+  uint32_t stepsPerEnv; // total time steps each env of the worker should take
+  uint32_t chunkSteps;  // time steps per streamed chunk
+};
+
+/// a piece of experience from one worker. columns are time major: column t * nEnvs + e belongs to env e at step t.
+template<typename Dtype, int StateDim, int ActionDim>
+struct TrajectoryChunk {
+  using StateBatch = Eigen::Matrix<Dtype, StateDim, Eigen::Dynamic>;
+  using ActionBatch = Eigen::Matrix<Dtype, ActionDim, Eigen::Dynamic>;
+  using CostBatch = Eigen::Matrix<Dtype, 1, Eigen::Dynamic>;
+
+  uint32_t workerId = 0;
+  uint32_t version = 0;
+  uint32_t nEnvs = 0;
+  uint32_t nSteps = 0;
+
+  StateBatch states;          // s_t
+  ActionBatch actions;        // a_t including exploration noise
+  CostBatch costs;            // c_t
+  std::vector<uint8_t> termination; // TerminationType after a_t
+  StateBatch terminalStates;  // s_t+1 of every terminated column, in column order
+  StateBatch lastStates;      // s_t+1 of every env after the last step, for bootstrapping
+
+  int size() const { return int(nEnvs * nSteps); }
+
+  void resize(uint32_t envs, uint32_t steps) {
+    nEnvs = envs;
+    nSteps = steps;
+    states.resize(StateDim, envs * steps);
+    actions.resize(ActionDim, envs * steps);
+    costs.resize(envs * steps);
+    termination.assign(envs * steps, uint8_t(TerminationType::not_terminated));
+    terminalStates.resize(StateDim, 0);
+    lastStates.resize(StateDim, envs);
+  }
+};
+
+namespace detail {
+
+template<typename Derived>
+inline void writeAsFloat(std::vector<char> &buf, const Eigen::MatrixBase<Derived> &m) {
+  size_t offset = buf.size();
+  buf.resize(offset + m.size() * sizeof(float));
+  Eigen::Map<Eigen::Matrix<float, Derived::RowsAtCompileTime, Derived::ColsAtCompileTime> >
+      (reinterpret_cast<float *>(&buf[offset]), m.rows(), m.cols()) = m.template cast<float>();
+}
+
+template<typename Derived>
+inline const char *readAsFloat(const char *ptr, Eigen::MatrixBase<Derived> &m) {
+  using Scalar = typename Derived::Scalar;
+  m.derived() = Eigen::Map<const Eigen::Matrix<float, Derived::RowsAtCompileTime, Derived::ColsAtCompileTime> >
+      (reinterpret_cast<const float *>(ptr), m.rows(), m.cols()).template cast<Scalar>();
+  return ptr + m.size() * sizeof(float);
+}
+
+template<typename T>
+inline void writePod(std::vector<char> &buf, const T &value) {
+  size_t offset = buf.size();
+  buf.resize(offset + sizeof(T));
+  std::memcpy(&buf[offset], &value, sizeof(T));
+}
+
+template<typename T>
+inline const char *readPod(const char *ptr, T &value) {
+  std::memcpy(&value, ptr, sizeof(T));
+  return ptr + sizeof(T);
+}
+
+}
+
+template<typename Dtype, int StateDim, int ActionDim>
+void encodeChunk(const TrajectoryChunk<Dtype, StateDim, ActionDim> &chunk, std::vector<char> &buf) {
+  buf.clear();
+  const uint32_t nTerminal = uint32_t(chunk.terminalStates.cols());
+  detail::writePod(buf, chunk.workerId);
+  detail::writePod(buf, chunk.nEnvs);
+  detail::writePod(buf, chunk.nSteps);
+  detail::writePod(buf, nTerminal);
+  detail::writeAsFloat(buf, chunk.states);
+  detail::writeAsFloat(buf, chunk.actions);
+  detail::writeAsFloat(buf, chunk.costs);
+  buf.insert(buf.end(), chunk.termination.begin(), chunk.termination.end());
+  detail::writeAsFloat(buf, chunk.terminalStates);
+  detail::writeAsFloat(buf, chunk.lastStates);
+}
+
+template<typename Dtype, int StateDim, int ActionDim>
+void decodeChunk(const std::vector<char> &buf, uint32_t version, TrajectoryChunk<Dtype, StateDim, ActionDim> &chunk) {
+  const char *ptr = buf.data();
+  uint32_t workerId, nEnvs, nSteps, nTerminal;
+  ptr = detail::readPod(ptr, workerId);
+  ptr = detail::readPod(ptr, nEnvs);
+  ptr = detail::readPod(ptr, nSteps);
+  ptr = detail::readPod(ptr, nTerminal);
+
+  const size_t cols = size_t(nEnvs) * nSteps;
+  const size_t expected = 4 * sizeof(uint32_t)
+      + sizeof(float) * (cols * (StateDim + ActionDim + 1) + StateDim * (nTerminal + nEnvs)) + cols;
+  LOG_IF(FATAL, buf.size() != expected) << "chunk size mismatch: got " << buf.size() << " expected " << expected;
+
+  chunk.resize(nEnvs, nSteps);
+  chunk.workerId = workerId;
+  chunk.version = version;
+  chunk.terminalStates.resize(StateDim, nTerminal);
+  ptr = detail::readAsFloat(ptr, chunk.states);
+  ptr = detail::readAsFloat(ptr, chunk.actions);
+  ptr = detail::readAsFloat(ptr, chunk.costs);
+  std::memcpy(chunk.termination.data(), ptr, cols);
+  ptr += cols;
+  ptr = detail::readAsFloat(ptr, chunk.terminalStates);
+  detail::readAsFloat(ptr, chunk.lastStates);
+}
+
+template<typename Dtype>
+void encodeParameters(const Eigen::Matrix<Dtype, -1, 1> &param, std::vector<char> &buf) {
+  buf.resize(param.size() * sizeof(Dtype));
+  std::memcpy(buf.data(), param.data(), buf.size());
+}
+
+template<typename Dtype>
+void decodeParameters(const std::vector<char> &buf, Eigen::Matrix<Dtype, -1, 1> &param) {
+  LOG_IF(FATAL, buf.size() != param.size() * sizeof(Dtype))
+  << "parameter size mismatch: got " << buf.size() / sizeof(Dtype) << " expected " << param.size();
+  std::memcpy(param.data(), buf.data(), buf.size());
+}
+
+}
+}
+
+#endif //RAI_DISTRIBUTED_ROLLOUTPROTOCOL_HPP
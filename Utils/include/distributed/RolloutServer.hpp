@@ -0,0 +1,109 @@
+//
+// Learner side of the distributed rollout. Accepts a fixed number of workers,
+// broadcasts versioned policy parameters and gathers the streamed chunks.
+//
+
+#ifndef RAI_DISTRIBUTED_ROLLOUTSERVER_HPP
+#define RAI_DISTRIBUTED_ROLLOUTSERVER_HPP
+
+#include <poll.h>
+#include <string>
+#include <vector>
+#include "distributed/Socket.hpp"
+#include "distributed/RolloutProtocol.hpp"
+
+namespace rai {
+namespace Distributed {
+
+template<typename Dtype, int StateDim, int ActionDim>
+class RolloutServer {
+
+ public:
+  using Chunk = TrajectoryChunk<Dtype, StateDim, ActionDim>;
+  using Parameter = Eigen::Matrix<Dtype, -1, 1>;
+
+  /// blocks until nWorkers workers have connected and introduced themselves
+  RolloutServer(const std::string &host, int port, int nWorkers, int paramSize) :
+      listener_(Socket::listenOn(host, port)) {
+    LOG(INFO) << "waiting for " << nWorkers << " rollout workers on " << host << ":" << port;
+    std::vector<char> payload;
+    FrameHeader header;
+    for (int i = 0; i < nWorkers; i++) {
+      workers_.push_back(listener_.accept());
+      LOG_IF(FATAL, !workers_.back().recvFrame(header, payload) || header.type != uint16_t(MessageType::hello))
+      << "worker did not say hello";
+      HelloMsg hello;
+      std::memcpy(&hello, payload.data(), sizeof(hello));
+      LOG_IF(FATAL, hello.stateDim != StateDim || hello.actionDim != ActionDim || hello.paramSize != paramSize)
+      << "worker " << hello.workerId << " runs a different task or policy";
+      totalEnvs_ += hello.nEnvs;
+      LOG(INFO) << "worker " << hello.workerId << " connected with " << hello.nEnvs << " envs";
+    }
+  }
+
+  ~RolloutServer() {
+    for (auto &worker : workers_)
+      worker.sendFrame(MessageType::shutdown, version_, nullptr, 0);
+  }
+
+  void broadcastParameters(uint32_t version, const Parameter &param) {
+    version_ = version;
+    encodeParameters(param, buffer_);
+    for (auto &worker : workers_)
+      LOG_IF(FATAL, !worker.sendFrame(MessageType::parameters, version, buffer_.data(), uint32_t(buffer_.size())))
+      << "lost a rollout worker";
+  }
+
+  /// every env of every worker takes stepsPerEnv steps. chunks acting on an older parameter version are dropped
+  void collect(uint32_t stepsPerEnv, uint32_t chunkSteps, std::vector<Chunk> &chunks) {
+    chunks.clear();
+    RequestMsg request{stepsPerEnv, chunkSteps};
+    for (auto &worker : workers_)
+      LOG_IF(FATAL, !worker.sendFrame(MessageType::request, version_, &request, sizeof(request)))
+      << "lost a rollout worker";
+
+    std::vector<pollfd> fds(workers_.size());
+    for (size_t i = 0; i < workers_.size(); i++) {
+      fds[i].fd = workers_[i].fd();
+      fds[i].events = POLLIN;
+    }
+
+    size_t nDone = 0;
+    FrameHeader header;
+    while (nDone < workers_.size()) {
+      LOG_IF(FATAL, poll(fds.data(), fds.size(), -1) < 0) << "poll failed";
+      for (size_t i = 0; i < workers_.size(); i++) {
+        if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+        LOG_IF(FATAL, !workers_[i].recvFrame(header, buffer_)) << "lost a rollout worker";
+        if (header.type == uint16_t(MessageType::done)) {
+          fds[i].fd = -1; // poll ignores negative descriptors
+          nDone++;
+        } else if (header.type == uint16_t(MessageType::chunk)) {
+          if (header.version != version_) {
+            staleChunks_++;
+            continue;
+          }
+          chunks.emplace_back();
+          decodeChunk(buffer_, header.version, chunks.back());
+        }
+      }
+    }
+  }
+
+  int nWorkers() const { return int(workers_.size()); }
+  int totalEnvs() const { return totalEnvs_; }
+  long staleChunks() const { return staleChunks_; }
+
+ private:
+  Socket listener_;
+  std::vector<Socket> workers_;
+  std::vector<char> buffer_;
+  uint32_t version_ = 0;
+  int totalEnvs_ = 0;
+  long staleChunks_ = 0;
+};
+
+}
+}
+
+#endif //RAI_DISTRIBUTED_ROLLOUTSERVER_HPP
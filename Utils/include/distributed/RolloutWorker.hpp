@@ -0,0 +1,301 @@
+//
+// Worker side of the distributed rollout. Hosts a set of envs and a copy of
+// the policy, follows the parameter broadcasts of the learner and streams
+// the experience back in chunks.
+//
+
+#ifndef RAI_DISTRIBUTED_ROLLOUTWORKER_HPP
+#define RAI_DISTRIBUTED_ROLLOUTWORKER_HPP
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <omp.h>
+#include "rai/tasks/common/Task.hpp"
+#include "rai/function/common/StochasticPolicy.hpp"
+#include "rai/function/common/RecurrentStochasticPolicy.hpp"
+#include "distributed/Socket.hpp"
+#include "distributed/RolloutProtocol.hpp"
+#include "sharedMemory/ProcessEnvPool.hpp"
+#include "simd/BatchNoise.hpp"
+#include "simd/LstmPolicy.hpp"
+#include "simd/MlpPolicy.hpp"
+#include "trace/Trace.hpp"
+
+namespace rai {
+namespace Distributed {
+
+template<typename Dtype, int StateDim, int ActionDim>
+class RolloutWorker {
+
+ public:
+  using Task_ = Task::Task<Dtype, StateDim, ActionDim, 0>;
+  using Policy_ = FuncApprox::StochasticPolicy<Dtype, StateDim, ActionDim>;
+  using RecurrentPolicy_ = FuncApprox::RecurrentStochasticPolicy<Dtype, StateDim, ActionDim>;
+  using Noise_ = Simd::BatchNoise<Dtype, ActionDim>;
+  using Chunk = TrajectoryChunk<Dtype, StateDim, ActionDim>;
+  using State = Eigen::Matrix<Dtype, StateDim, 1>;
+  using StateBatch = Eigen::Matrix<Dtype, StateDim, Eigen::Dynamic>;
+  using Action = Eigen::Matrix<Dtype, ActionDim, 1>;
+  using ActionBatch = Eigen::Matrix<Dtype, ActionDim, Eigen::Dynamic>;
+  using Parameter = Eigen::Matrix<Dtype, -1, 1>;
+  using EnvPool_ = SharedMemory::ProcessEnvPool<Dtype, StateDim, ActionDim>;
+
+  /// simulates with OpenMP threads of this process. The exploration noise of all envs starts at
+  /// noiseStdev and follows the policy stdev after every parameter update
+  RolloutWorker(std::vector<Task_ *> &tasks, Policy_ *policy, const Action &noiseStdev, double controlUpdate_dt) :
+      task_(tasks), policy_(policy), noise_(noiseStdev), dt_(controlUpdate_dt), nEnvs_(int(tasks.size())) {
+    initialize();
+    for (int i = 0; i < nEnvs_; i++) {
+      State state;
+      task_[i]->getInitialState(state);
+      stateBat_.col(i) = state;
+    }
+  }
+
+  /// simulates in the forked processes of envPool
+  RolloutWorker(EnvPool_ *envPool, Policy_ *policy, const Action &noiseStdev) :
+      policy_(policy), noise_(noiseStdev), envPool_(envPool), nEnvs_(envPool->size()) {
+    initialize();
+    envPool_->resetAll(stateBat_);
+  }
+
+  /// computes the action means with the dispatched SIMD kernels instead of the TensorFlow policy.
+  /// layerSizes must describe the policy network, {StateDim, hidden..., ActionDim}. The first
+  /// parameter update is checked against the policy and falls back to it on a mismatch
+  void useCpuInference(const std::vector<int> &layerSizes, Simd::Activation hidden) {
+    static_assert(std::is_same<Dtype, double>::value, "the SIMD kernels are built for double");
+    mlp_.reset(new Simd::MlpPolicy(layerSizes, hidden));
+    mlpChecked_ = false;
+    LOG(INFO) << "cpu inference with " << Simd::isaName(Simd::kernels().isa) << " kernels";
+  }
+
+  /// the same for the recurrent "LSTM_merged" policy, which must also be the policy of this worker,
+  /// with a hiddenDim LSTM on the state and the MLP headSizes {hiddenDim, hidden..., ActionDim} on top.
+  /// Every step evaluates one timestep of all envs and carries each env's LSTM state to the next, an
+  /// env's state is cleared when its episode ends. The first parameter update is checked against the
+  /// first step of the policy. A recurrent policy has no stateless fallback, a mismatch is fatal
+  void useRecurrentCpuInference(RecurrentPolicy_ *policy, int hiddenDim, const std::vector<int> &headSizes,
+                                Simd::Activation headActivation) {
+    static_assert(std::is_same<Dtype, double>::value, "the SIMD kernels are built for double");
+    recurrentPolicy_ = policy;
+    lstm_.reset(new Simd::LstmPolicy(StateDim, hiddenDim, headSizes, headActivation));
+    recurrentState_.reset(new Simd::RecurrentStateCache(hiddenDim, nEnvs_));
+    lstmChecked_ = false;
+    LOG(INFO) << "recurrent cpu inference with " << Simd::isaName(Simd::kernels().isa) << " kernels";
+  }
+
+  /// runs until the learner sends shutdown or disconnects
+  void serve(const std::string &host, int port, uint32_t workerId) {
+    workerId_ = workerId;
+    Socket learner = Socket::connectTo(host, port);
+    HelloMsg hello{workerId, uint32_t(nEnvs_), StateDim, ActionDim, uint32_t(parameter_.size())};
+    learner.sendFrame(MessageType::hello, 0, &hello, sizeof(hello));
+
+    FrameHeader header;
+    std::vector<char> payload;
+    while (learner.recvFrame(header, payload)) {
+      switch (static_cast<MessageType>(header.type)) {
+        case MessageType::parameters:
+          decodeParameters(payload, parameter_);
+          policy_->setLP(parameter_);
+          updatePolicyVar();
+          if (mlp_) updateCpuInference();
+          if (lstm_) updateRecurrentInference();
+          version_ = header.version;
+          break;
+        case MessageType::request: {
+          RequestMsg request;
+          std::memcpy(&request, payload.data(), sizeof(request));
+          if (!rollout(learner, request)) return;
+          break;
+        }
+        case MessageType::shutdown:
+          return;
+        default:
+          LOG(WARNING) << "unexpected message " << header.type;
+      }
+    }
+  }
+
+ private:
+
+  void initialize() {
+    parameter_.setZero(policy_->getLPSize());
+    stateBat_.resize(StateDim, nEnvs_);
+    actionBat_.resize(ActionDim, nEnvs_);
+    noiseBat_.resize(ActionDim, nEnvs_);
+    episodeSteps_.assign(nEnvs_, 0);
+  }
+
+  bool rollout(Socket &learner, const RequestMsg &request) {
+    RAI_TRACE_SCOPE("acquisition");
+    const int nEnvs = nEnvs_;
+    uint32_t remaining = request.stepsPerEnv;
+
+    while (remaining > 0) {
+      const uint32_t nSteps = std::min(remaining, std::max(request.chunkSteps, 1u));
+      chunk_.resize(nEnvs, nSteps);
+      chunk_.workerId = workerId_;
+      std::vector<State, Eigen::aligned_allocator<State> > terminal;
+
+      for (uint32_t t = 0; t < nSteps; t++) {
+        {
+          RAI_TRACE_SCOPE("policy inference");
+          if (lstm_)
+            lstm_->step(stateBat_.data(), actionBat_.data(), *recurrentState_);
+          else if (mlp_)
+            mlp_->forward(stateBat_.data(), actionBat_.data(), nEnvs);
+          else
+            policy_->forward(stateBat_, actionBat_);
+        }
+        const int offset = int(t) * nEnvs;
+        chunk_.states.middleCols(offset, nEnvs) = stateBat_;
+        noise_.sample(noiseBat_);
+
+        if (envPool_)
+          stepEnvPool(offset);
+        else
+          stepThreads(offset);
+
+        /// resets are rare, handle them serially to keep the terminal states in column order
+        for (int e = 0; e < nEnvs; e++) {
+          if (chunk_.termination[offset + e] == uint8_t(TerminationType::not_terminated)) continue;
+          terminal.push_back(stateBat_.col(e));
+          State state;
+          if (envPool_)
+            envPool_->reset(e, state);
+          else
+            task_[e]->getInitialState(state);
+          stateBat_.col(e) = state;
+          episodeSteps_[e] = 0;
+          if (recurrentState_) recurrentState_->reset(e);
+        }
+      }
+
+      chunk_.terminalStates.resize(StateDim, terminal.size());
+      for (int i = 0; i < int(terminal.size()); i++)
+        chunk_.terminalStates.col(i) = terminal[i];
+      chunk_.lastStates = stateBat_;
+
+      encodeChunk(chunk_, buffer_);
+      if (!learner.sendFrame(MessageType::chunk, version_, buffer_.data(), uint32_t(buffer_.size())))
+        return false;
+      remaining -= nSteps;
+    }
+    return learner.sendFrame(MessageType::done, version_, nullptr, 0);
+  }
+
+  void stepThreads(int offset) {
+    const int maxSteps = int(task_[0]->timeLimit() / dt_ + 0.5);
+
+#pragma omp parallel for schedule(static)
+    for (int e = 0; e < nEnvs_; e++) {
+      Action action = actionBat_.col(e) + noiseBat_.col(e);
+      State next;
+      Dtype cost;
+      TerminationType termType = TerminationType::not_terminated;
+      task_[e]->step(action, next, termType, cost);
+      if (termType == TerminationType::not_terminated && ++episodeSteps_[e] >= maxSteps)
+        termType = TerminationType::timeout;
+
+      chunk_.actions.col(offset + e) = action;
+      chunk_.costs(offset + e) = cost;
+      chunk_.termination[offset + e] = uint8_t(termType);
+      stateBat_.col(e) = next;
+    }
+  }
+
+  /// the pool enforces the time limit itself
+  void stepEnvPool(int offset) {
+    actionBat_ += noiseBat_;
+    envPool_->step(actionBat_, stateBat_, costs_, termTypes_);
+
+    chunk_.actions.middleCols(offset, nEnvs_) = actionBat_;
+    chunk_.costs.segment(offset, nEnvs_) = costs_;
+    for (int e = 0; e < nEnvs_; e++)
+      chunk_.termination[offset + e] = uint8_t(termTypes_[e]);
+  }
+
+  void updateCpuInference() {
+    if (!mlp_->setParameters(parameter_.data(), parameter_.size())) {
+      LOG(WARNING) << "policy has " << parameter_.size() << " parameters, the cpu network needs "
+                   << mlp_->parameterSize() << ". Using the policy";
+      mlp_.reset();
+      return;
+    }
+    if (mlpChecked_) return;
+
+    ActionBatch expected(ActionDim, nEnvs_), actual(ActionDim, nEnvs_);
+    policy_->forward(stateBat_, expected);
+    mlp_->forward(stateBat_.data(), actual.data(), nEnvs_);
+    Dtype error = (expected - actual).cwiseAbs().maxCoeff();
+    if (error > 1e-6 * (1 + expected.cwiseAbs().maxCoeff())) {
+      LOG(WARNING) << "cpu inference differs from the policy by " << error
+                   << ", the layer sizes or parameter layout do not match. Using the policy";
+      mlp_.reset();
+      return;
+    }
+    mlpChecked_ = true;
+  }
+
+  /// the first step of an episode starts from a zero LSTM state in both networks, so one step of the
+  /// current states checks the gate order and the weight layout
+  void updateRecurrentInference() {
+    LOG_IF(FATAL, !lstm_->setParameters(parameter_.data(), parameter_.size()))
+    << "policy has " << parameter_.size() << " parameters, the recurrent cpu network needs " << lstm_->parameterSize();
+    if (lstmChecked_) return;
+
+    typename RecurrentPolicy_::Tensor3D states({StateDim, 1, nEnvs_}, "state");
+    typename RecurrentPolicy_::Tensor3D expected({ActionDim, 1, nEnvs_}, "action");
+    typename RecurrentPolicy_::Tensor2D hidden({recurrentPolicy_->getHiddenStatesize(), nEnvs_}, 0, "h_init");
+    std::copy_n(stateBat_.data(), stateBat_.size(), states.data());
+    recurrentPolicy_->forward(states, expected, hidden);
+
+    Simd::RecurrentStateCache start(lstm_->hiddenDim(), nEnvs_);
+    ActionBatch actual(ActionDim, nEnvs_);
+    lstm_->step(stateBat_.data(), actual.data(), start);
+    Eigen::Map<ActionBatch> expectedBat(expected.data(), ActionDim, nEnvs_);
+    Dtype error = (expectedBat - actual).cwiseAbs().maxCoeff();
+    LOG_IF(FATAL, error > 1e-6 * (1 + expectedBat.cwiseAbs().maxCoeff()))
+    << "recurrent cpu inference differs from the policy by " << error
+    << ", the gate order or parameter layout do not match the LSTM_merged graph";
+    lstmChecked_ = true;
+  }
+
+  void updatePolicyVar() {
+    Action stdev;
+    policy_->getStdev(stdev);
+    noise_.setStdev(stdev);
+  }
+
+  std::vector<Task_ *> task_;
+  Policy_ *policy_;
+  Noise_ noise_;
+  double dt_ = 0;
+  EnvPool_ *envPool_ = nullptr;
+  int nEnvs_;
+
+  Parameter parameter_;
+  StateBatch stateBat_;
+  ActionBatch actionBat_, noiseBat_;
+  std::vector<int> episodeSteps_;
+  Eigen::Matrix<Dtype, 1, Eigen::Dynamic> costs_;
+  std::vector<TerminationType> termTypes_;
+  Chunk chunk_;
+  std::vector<char> buffer_;
+  uint32_t version_ = 0;
+  uint32_t workerId_ = 0;
+  std::unique_ptr<Simd::MlpPolicy> mlp_;
+  bool mlpChecked_ = false;
+  RecurrentPolicy_ *recurrentPolicy_ = nullptr;
+  std::unique_ptr<Simd::LstmPolicy> lstm_;
+  bool lstmChecked_ = false;
+  std::unique_ptr<Simd::RecurrentStateCache> recurrentState_;
+};
+
+}
+}
+
+#endif //RAI_DISTRIBUTED_ROLLOUTWORKER_HPP
@@ -0,0 +1,73 @@
+//
+// Blocking TCP helpers used by the rollout workers and the learner.
+//
+
+#ifndef RAI_DISTRIBUTED_SOCKET_HPP
+#define RAI_DISTRIBUTED_SOCKET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rai {
+namespace Distributed {
+
+/// wire header of every message. all fields are little endian.
+struct FrameHeader {
+  uint32_t magic;
+  uint16_t type;
+  uint16_t reserved;
+  uint32_t version;      // parameter version the payload belongs to
+  uint32_t payloadBytes;
+};
+
+constexpr uint32_t FrameMagic = 0x52414931; // "RAI1"
+
+enum class MessageType : uint16_t {
+  hello = 1,      // worker -> learner
+  parameters = 2, // learner -> worker
+  request = 3,    // learner -> worker
+  chunk = 4,      // worker -> learner
+  done = 5,       // worker -> learner, end of one request
+  shutdown = 6    // learner -> worker
+};
+
+class Socket {
+
+ public:
+  Socket() = default;
+  explicit Socket(int fd) : fd_(fd) {}
+  Socket(const Socket &) = delete;
+  Socket &operator=(const Socket &) = delete;
+  Socket(Socket &&other) noexcept;
+  Socket &operator=(Socket &&other) noexcept;
+  ~Socket();
+
+  /// connects to host:port, retrying for up to timeoutSec so that workers can be started before the learner
+  static Socket connectTo(const std::string &host, int port, double timeoutSec = 30.0);
+
+  /// binds and listens on port. use host "127.0.0.1" for loopback-only testing
+  static Socket listenOn(const std::string &host, int port, int backlog = 64);
+
+  Socket accept();
+
+  bool isOpen() const { return fd_ >= 0; }
+  int fd() const { return fd_; }
+  void close();
+
+  /// false if the peer closed the connection
+  bool sendFrame(MessageType type, uint32_t version, const void *payload, uint32_t bytes);
+  bool recvFrame(FrameHeader &header, std::vector<char> &payload);
+
+ private:
+  bool sendAll(const void *data, size_t bytes);
+  bool recvAll(void *data, size_t bytes);
+
+  int fd_ = -1;
+};
+
+}
+}
+
+#endif //RAI_DISTRIBUTED_SOCKET_HPP
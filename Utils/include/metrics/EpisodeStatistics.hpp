@@ -0,0 +1,302 @@
+//
+// Per-episode statistics of the envs: return, length, how the episode ended
+// (terminal state, timeout, or cut short by a reset), which state bound a
+// terminal state violated, the final distance to the goal and how often
+// every actuator saturated. Every task owns one EpisodeStatistics and is its
+// only writer: step() only adds to plain members, and a finished episode is
+// published into monotonic counters with relaxed stores. Once per iteration
+// one thread merges the growth of all counters since the last merge into
+// EpisodeHistograms, without a lock and without stopping the envs:
+//   std::vector<EpisodeStatistics *> statistics;   // task->episodeStatistics() of every env
+//   EpisodeStatistics::collect(statistics, histograms);
+//   rai::Metrics::logEpisodes(histograms, &metrics);  // metrics/Metrics.hpp
+// A merge that runs while an env publishes may see that episode in some
+// counters only; the next merge accounts for the rest.
+//
+
+#ifndef RAI_METRICS_EPISODESTATISTICS_HPP
+#define RAI_METRICS_EPISODESTATISTICS_HPP
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "glog/logging.h"
+
+namespace rai {
+namespace Metrics {
+
+/// bins of equal width over [lower, upper], values outside fall into the first or the last bin
+struct HistogramRange {
+  double lower, upper;
+  int bins;
+
+  int bin(double value) const {
+    const int index = int((value - lower) / (upper - lower) * bins);
+    return std::min(std::max(index, 0), bins - 1);
+  }
+
+  double width() const { return (upper - lower) / bins; }
+};
+
+enum class EpisodeEnd { terminalState = 0, timeout, reset };
+
+/// what the episodes that ended between two merges did
+struct EpisodeHistograms {
+  HistogramRange returnRange, lengthRange, distanceRange;
+  std::vector<uint64_t> returns, lengths, distances;
+  uint64_t ends[3];
+  /// boundHits[2 * i] counts terminal states below the lower bound of state i, boundHits[2 * i + 1] above the upper
+  std::vector<uint64_t> boundHits;
+  /// steps in which actuator i was clipped
+  std::vector<uint64_t> saturatedSteps;
+  uint64_t episodes, steps;
+  double returnSum, lengthSum, distanceSum;
+
+  double meanReturn() const { return episodes ? returnSum / episodes : 0.0; }
+  double meanLength() const { return episodes ? lengthSum / episodes : 0.0; }
+  double meanDistance() const { return episodes ? distanceSum / episodes : 0.0; }
+  double fraction(EpisodeEnd end) const { return episodes ? double(ends[int(end)]) / episodes : 0.0; }
+  double saturation(int actuator) const { return steps ? double(saturatedSteps[actuator]) / steps : 0.0; }
+
+  /// the q-quantile of a histogram, interpolated linearly within its bin
+  static double quantile(const std::vector<uint64_t> &histogram, const HistogramRange &range, double q) {
+    uint64_t total = 0;
+    for (auto count : histogram) total += count;
+    if (total == 0) return 0.0;
+    const double target = q * total;
+    double below = 0.0;
+    for (int i = 0; i < range.bins; i++) {
+      if (histogram[i] > 0 && below + histogram[i] >= target)
+        return range.lower + (i + (target - below) / histogram[i]) * range.width();
+      below += histogram[i];
+    }
+    return range.upper;
+  }
+};
+
+/// the histogram bins of EpisodeStatistics
+struct EpisodeLayout {
+  HistogramRange returns{0.0, 5.0, 50};
+  HistogramRange lengths{0.0, 1500.0, 50};
+  HistogramRange distances{0.0, 5.0, 50};
+};
+
+class EpisodeStatistics {
+ public:
+  using Layout = EpisodeLayout;
+
+  EpisodeStatistics(int stateDim, int actuatorDim, const Layout &layout = Layout()) :
+      layout_(layout), stateDim_(stateDim), actuatorDim_(actuatorDim),
+      lower_(Eigen::VectorXd::Constant(stateDim, -1e300)), upper_(Eigen::VectorXd::Constant(stateDim, 1e300)),
+      saturated_(actuatorDim, 0) {
+    LOG_IF(FATAL, actuatorDim > 64) << "episode statistics: at most 64 actuators";
+    returnOffset_ = 0;
+    lengthOffset_ = returnOffset_ + layout_.returns.bins;
+    distanceOffset_ = lengthOffset_ + layout_.lengths.bins;
+    endOffset_ = distanceOffset_ + layout_.distances.bins;
+    boundOffset_ = endOffset_ + 3;
+    saturationOffset_ = boundOffset_ + 2 * stateDim;
+    stepsOffset_ = saturationOffset_ + actuatorDim;
+    nCounters_ = stepsOffset_ + 1;
+    counters_.reset(new std::atomic<uint64_t>[nCounters_]);
+    for (int i = 0; i < nCounters_; i++) counters_[i].store(0, std::memory_order_relaxed);
+    for (auto &sum : sums_) sum.store(0.0, std::memory_order_relaxed);
+    collected_.assign(nCounters_, 0);
+  }
+
+  /// a copy has the layout and bounds of other and starts without episodes, like a copied task
+  EpisodeStatistics(const EpisodeStatistics &other) :
+      EpisodeStatistics(other.stateDim_, other.actuatorDim_, other.layout_) {
+    lower_ = other.lower_;
+    upper_ = other.upper_;
+  }
+
+  EpisodeStatistics &operator=(const EpisodeStatistics &other) {
+    if (this != &other) {
+      EpisodeStatistics copy(other);
+      swap(copy);
+    }
+    return *this;
+  }
+
+  /// exchanges everything, the episodes and what has been collected of them included
+  void swap(EpisodeStatistics &other) {
+    std::swap(layout_, other.layout_);
+    std::swap(stateDim_, other.stateDim_);
+    std::swap(actuatorDim_, other.actuatorDim_);
+    std::swap(returnOffset_, other.returnOffset_);
+    std::swap(lengthOffset_, other.lengthOffset_);
+    std::swap(distanceOffset_, other.distanceOffset_);
+    std::swap(endOffset_, other.endOffset_);
+    std::swap(boundOffset_, other.boundOffset_);
+    std::swap(saturationOffset_, other.saturationOffset_);
+    std::swap(stepsOffset_, other.stepsOffset_);
+    std::swap(nCounters_, other.nCounters_);
+    lower_.swap(other.lower_);
+    upper_.swap(other.upper_);
+    std::swap(return_, other.return_);
+    std::swap(length_, other.length_);
+    saturated_.swap(other.saturated_);
+    counters_.swap(other.counters_);
+    for (int i = 0; i < 3; i++) {
+      const double sum = sums_[i].load(std::memory_order_relaxed);
+      sums_[i].store(other.sums_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+      other.sums_[i].store(sum, std::memory_order_relaxed);
+      std::swap(collectedSums_[i], other.collectedSums_[i]);
+    }
+    collected_.swap(other.collected_);
+  }
+
+  /// the box constraints of the task, a terminal state is attributed to the first bound it violates
+  template<typename Derived>
+  void setBounds(const Eigen::MatrixBase<Derived> &lower, const Eigen::MatrixBase<Derived> &upper) {
+    lower_ = lower.template cast<double>();
+    upper_ = upper.template cast<double>();
+  }
+
+  const Layout &layout() const { return layout_; }
+
+  /////////////////////////// the task's thread ///////////////////////////
+
+  /// bit i of saturatedMask is set if actuator i was clipped in this step
+  void step(double cost, uint64_t saturatedMask) {
+    return_ += cost;
+    length_++;
+    for (; saturatedMask; saturatedMask &= saturatedMask - 1)
+      saturated_[ctz(saturatedMask)]++;
+  }
+
+  /// state is the one the box constraints were checked on, before any normalization
+  template<typename Derived>
+  void endTerminalState(const Eigen::MatrixBase<Derived> &state, double goalDistance) {
+    for (int i = 0; i < stateDim_; i++) {
+      const double value = double(state(i));
+      if (value < lower_(i) || value > upper_(i)) {
+        increment(boundOffset_ + 2 * i + (value > upper_(i) ? 1 : 0));
+        break;
+      }
+    }
+    publish(EpisodeEnd::terminalState, goalDistance);
+  }
+
+  /// called where the task starts over, ends the running episode if it was not ended by a terminal state
+  void restart(double goalDistance, bool timedOut) {
+    if (length_ > 0) publish(timedOut ? EpisodeEnd::timeout : EpisodeEnd::reset, goalDistance);
+  }
+
+  /////////////////////////// the collecting thread ///////////////////////////
+
+  /// out describes the episodes published since the previous collect of the same statistics.
+  /// All statistics share the layout of the first one
+  static void collect(const std::vector<EpisodeStatistics *> &statistics, EpisodeHistograms &out) {
+    LOG_IF(FATAL, statistics.empty()) << "episode statistics: nothing to collect";
+    const EpisodeStatistics &first = *statistics[0];
+    out.returnRange = first.layout_.returns;
+    out.lengthRange = first.layout_.lengths;
+    out.distanceRange = first.layout_.distances;
+    out.returns.assign(out.returnRange.bins, 0);
+    out.lengths.assign(out.lengthRange.bins, 0);
+    out.distances.assign(out.distanceRange.bins, 0);
+    std::fill(out.ends, out.ends + 3, 0);
+    out.boundHits.assign(2 * first.stateDim_, 0);
+    out.saturatedSteps.assign(first.actuatorDim_, 0);
+    out.steps = 0;
+    out.returnSum = out.lengthSum = out.distanceSum = 0.0;
+
+    std::vector<uint64_t> delta;
+    for (auto worker : statistics) {
+      LOG_IF(FATAL, worker->nCounters_ != first.nCounters_)
+      << "episode statistics: collecting statistics of different layouts";
+      worker->takeDelta(delta);
+      auto add = [&](std::vector<uint64_t> &to, int offset) {
+        for (size_t i = 0; i < to.size(); i++) to[i] += delta[offset + i];
+      };
+      add(out.returns, first.returnOffset_);
+      add(out.lengths, first.lengthOffset_);
+      add(out.distances, first.distanceOffset_);
+      add(out.boundHits, first.boundOffset_);
+      add(out.saturatedSteps, first.saturationOffset_);
+      for (int i = 0; i < 3; i++) out.ends[i] += delta[first.endOffset_ + i];
+      out.steps += delta[first.stepsOffset_];
+      out.returnSum += worker->takeSum(0);
+      out.lengthSum += worker->takeSum(1);
+      out.distanceSum += worker->takeSum(2);
+    }
+    out.episodes = out.ends[0] + out.ends[1] + out.ends[2];
+  }
+
+ private:
+  static int ctz(uint64_t x) { return __builtin_ctzll(x); }
+
+  /// only the task's thread writes a counter, so a load and a store replace the read-modify-write
+  void increment(int counter, uint64_t n = 1) {
+    counters_[counter].store(counters_[counter].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+
+  void add(std::atomic<double> &sum, double value) {
+    sum.store(sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  void publish(EpisodeEnd end, double goalDistance) {
+    increment(returnOffset_ + layout_.returns.bin(return_));
+    increment(lengthOffset_ + layout_.lengths.bin(double(length_)));
+    increment(distanceOffset_ + layout_.distances.bin(goalDistance));
+    for (int i = 0; i < actuatorDim_; i++) {
+      if (saturated_[i]) increment(saturationOffset_ + i, saturated_[i]);
+      saturated_[i] = 0;
+    }
+    increment(stepsOffset_, uint64_t(length_));
+    add(sums_[0], return_);
+    add(sums_[1], double(length_));
+    add(sums_[2], goalDistance);
+    /// the episode counts once its end is visible
+    std::atomic_thread_fence(std::memory_order_release);
+    increment(endOffset_ + int(end));
+    return_ = 0.0;
+    length_ = 0;
+  }
+
+  void takeDelta(std::vector<uint64_t> &delta) {
+    delta.resize(nCounters_);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    for (int i = 0; i < nCounters_; i++) {
+      const uint64_t value = counters_[i].load(std::memory_order_relaxed);
+      delta[i] = value - collected_[i];
+      collected_[i] = value;
+    }
+  }
+
+  double takeSum(int i) {
+    const double sum = sums_[i].load(std::memory_order_relaxed);
+    const double delta = sum - collectedSums_[i];
+    collectedSums_[i] = sum;
+    return delta;
+  }
+
+  Layout layout_;
+  int stateDim_, actuatorDim_;
+  int returnOffset_, lengthOffset_, distanceOffset_, endOffset_, boundOffset_, saturationOffset_, stepsOffset_;
+  int nCounters_;
+  Eigen::VectorXd lower_, upper_;
+
+  // the task's thread only
+  double return_ = 0.0;
+  long length_ = 0;
+  std::vector<uint64_t> saturated_;
+
+  // published, monotonic
+  std::unique_ptr<std::atomic<uint64_t>[]> counters_;
+  std::atomic<double> sums_[3];
+
+  // the collecting thread only
+  std::vector<uint64_t> collected_;
+  double collectedSums_[3] = {0.0, 0.0, 0.0};
+};
+
+}
+}
+
+#endif //RAI_METRICS_EPISODESTATISTICS_HPP
@@ -0,0 +1,89 @@
+//
+// Exports per-iteration training metrics without stalling the training loop.
+// The loop only fills a row and hands it over; a background thread appends it
+// to <directory>/metrics.csv and rewrites <directory>/metrics.prom in the
+// Prometheus text format, so a running job can be watched with tail, a
+// scraper's textfile collector or tools/plot_metrics.py.
+//
+
+#ifndef RAI_METRICS_EXPORTER_HPP
+#define RAI_METRICS_EXPORTER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace rai {
+namespace Metrics {
+
+class Exporter {
+ public:
+
+  /// metrics.csv is appended to, so restarting a run into the same directory keeps its history
+  explicit Exporter(const std::string &directory, const std::string &runName = "rai");
+  ~Exporter();
+
+  Exporter(const Exporter &) = delete;
+  Exporter &operator=(const Exporter &) = delete;
+
+  /// sets a value of the current iteration
+  void set(const std::string &name, double value);
+
+  /// sets the number of steps sampled so far, commit derives steps_per_second from it
+  void setSteps(double stepsTaken);
+
+  /// closes the current iteration. Adds wall time, steps per second and the
+  /// time spent in every update phase of rai::Utils::timer since the last commit
+  void commit(long iteration);
+
+  /// blocks until every committed row is on disk
+  void flush();
+
+  const std::string &csvPath() const { return csvPath_; }
+  const std::string &prometheusPath() const { return promPath_; }
+
+ private:
+
+  struct Row {
+    long iteration;
+    double seconds;
+    std::vector<std::pair<std::string, double>> values;
+  };
+
+  void writerLoop();
+  void write(const Row &row);
+  void writePrometheus();
+
+  std::string csvPath_, promPath_, runName_;
+  std::FILE *csv_ = nullptr;
+
+  // training thread only
+  Row current_;
+  std::chrono::steady_clock::time_point start_, lastCommit_;
+  std::map<std::string, double> lastTimer_;
+  double steps_ = -1, lastSteps_ = -1;
+
+  // shared with the writer
+  std::mutex mutex_;
+  std::condition_variable wake_, idle_;
+  std::deque<Row> queue_;
+  bool writing_ = false, stop_ = false;
+
+  // writer thread only
+  std::map<std::string, double> latest_;
+  long latestIteration_ = 0;
+
+  std::thread writer_;
+};
+
+}
+}
+
+#endif //RAI_METRICS_EXPORTER_HPP
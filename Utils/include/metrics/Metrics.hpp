@@ -0,0 +1,75 @@
+//
+// What the training applications include to export their metrics
+//
+
+#ifndef RAI_METRICS_METRICS_HPP
+#define RAI_METRICS_METRICS_HPP
+
+#include <cstdio>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "rai/RAI_core"
+#include "metrics/EpisodeStatistics.hpp"
+#include "metrics/Exporter.hpp"
+#include "metrics/TimerPhases.hpp"
+
+namespace rai {
+namespace Metrics {
+
+/// newest value of a variable of rai::Utils::logger, e.g. "PerformanceTester/performance"
+inline double lastLogged(const std::string &variable) {
+  auto size = Utils::logger->getDataSize(variable);
+  if (size == 0) return 0;
+  return double(Utils::logger->getData(variable, 1)[size - 1]);
+}
+
+/// appends the summary of one iteration's episodes to rai::Utils::logger under "Episodes/...",
+/// and, given an exporter, the summary and the histograms to the current row of its metrics
+inline void logEpisodes(const EpisodeHistograms &episodes, Exporter *exporter = nullptr) {
+  std::vector<std::pair<std::string, double>> values = {
+      {"episodes", double(episodes.episodes)},
+      {"return_mean", episodes.meanReturn()},
+      {"return_p10", EpisodeHistograms::quantile(episodes.returns, episodes.returnRange, 0.1)},
+      {"return_p50", EpisodeHistograms::quantile(episodes.returns, episodes.returnRange, 0.5)},
+      {"return_p90", EpisodeHistograms::quantile(episodes.returns, episodes.returnRange, 0.9)},
+      {"length_mean", episodes.meanLength()},
+      {"goal_distance_mean", episodes.meanDistance()},
+      {"goal_distance_p90", EpisodeHistograms::quantile(episodes.distances, episodes.distanceRange, 0.9)},
+      {"terminal_fraction", episodes.fraction(EpisodeEnd::terminalState)},
+      {"timeout_fraction", episodes.fraction(EpisodeEnd::timeout)},
+      {"reset_fraction", episodes.fraction(EpisodeEnd::reset)}};
+  for (size_t i = 0; i < episodes.saturatedSteps.size(); i++)
+    values.emplace_back("saturation_" + std::to_string(i), episodes.saturation(int(i)));
+  for (size_t i = 0; i < episodes.boundHits.size(); i++)
+    values.emplace_back("bound_" + std::to_string(i / 2) + (i % 2 ? "_upper" : "_lower"),
+                        double(episodes.boundHits[i]));
+
+  /// the logger needs every variable registered before its first value
+  static std::set<std::string> registered;
+  for (auto &value : values) {
+    const std::string name = "Episodes/" + value.first;
+    if (registered.insert(name).second) Utils::logger->addVariableToLog(1, name, "");
+    Utils::logger->appendData(name, value.second);
+  }
+  if (!exporter) return;
+
+  for (auto &value : values)
+    exporter->set("episode_" + value.first, value.second);
+  auto histogram = [&](const std::string &name, const std::vector<uint64_t> &counts) {
+    char bin[8];
+    for (size_t i = 0; i < counts.size(); i++) {
+      std::snprintf(bin, sizeof(bin), "%02d", int(i));
+      exporter->set("episode_" + name + "_bin" + bin, double(counts[i]));
+    }
+  };
+  histogram("return", episodes.returns);
+  histogram("length", episodes.lengths);
+  histogram("goal_distance", episodes.distances);
+}
+
+}
+}
+
+#endif //RAI_METRICS_METRICS_HPP
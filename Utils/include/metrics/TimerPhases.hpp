@@ -0,0 +1,54 @@
+//
+// Reads rai::Utils::timer and groups its items into the update phases that
+// the benchmarks and the metrics exporter report.
+//
+
+#ifndef RAI_METRICS_TIMERPHASES_HPP
+#define RAI_METRICS_TIMERPHASES_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <string>
+#include "rai/RAI_core"
+
+namespace rai {
+namespace Metrics {
+
+/// maps the timer names used by the algorithms onto the reported phases, "" if the item is not one of them
+inline std::string phaseOf(std::string timerName) {
+  std::transform(timerName.begin(), timerName.end(), timerName.begin(), ::tolower);
+  auto has = [&](const char *word) { return timerName.find(word) != std::string::npos; };
+  if (has("simulation") || has("acqui")) return "acquisition";
+  if (has("vfunction") || has("value")) return "value_fit";
+  if (has("conjugate")) return "cg";
+  if (has("gradient")) return "gradient";
+  if (has("line")) return "line_search";
+  return "";
+}
+
+/// accumulated time of every timer item
+inline std::map<std::string, double> readTimer() {
+  std::map<std::string, double> items;
+  for (auto &item : Utils::timer->getTimedItems())
+    items[item.first] += item.second;
+  return items;
+}
+
+/// time spent per phase between two readings
+inline std::map<std::string, double> phaseDeltas(const std::map<std::string, double> &before,
+                                                 const std::map<std::string, double> &after) {
+  std::map<std::string, double> phases;
+  for (auto &item : after) {
+    std::string phase = phaseOf(item.first);
+    if (phase.empty()) continue;
+    auto previous = before.find(item.first);
+    phases[phase] += item.second - (previous == before.end() ? 0.0 : previous->second);
+  }
+  return phases;
+}
+
+}
+}
+
+#endif //RAI_METRICS_TIMERPHASES_HPP
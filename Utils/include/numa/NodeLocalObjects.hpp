@@ -0,0 +1,75 @@
+//
+// One object per worker, each constructed by its pinned thread so that the
+// kernel's first-touch policy puts the object, and whatever it allocates in
+// its constructor, on the worker's NUMA node.
+//
+
+#ifndef RAI_NUMA_NODELOCALOBJECTS_HPP
+#define RAI_NUMA_NODELOCALOBJECTS_HPP
+
+#include <sys/mman.h>
+#include <vector>
+#include <omp.h>
+#include "glog/logging.h"
+#include "numa/WorkerPlacement.hpp"
+
+namespace rai {
+namespace Numa {
+
+/// untouched anonymous memory. pages get their node when they are first written
+inline void *mapUntouched(size_t bytes) {
+  void *ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  LOG_IF(FATAL, ptr == MAP_FAILED) << "cannot map " << bytes << " bytes";
+  return ptr;
+}
+
+template<typename T>
+class NodeLocalObjects {
+
+ public:
+  /// every object is constructed as T(args...) on the thread of its worker. pins the OpenMP threads as a side effect.
+  /// OpenMP may grant fewer threads than asked for (OMP_THREAD_LIMIT, OMP_DYNAMIC, nesting), which leaves workers
+  /// without an object, so that is fatal
+  template<typename... Args>
+  explicit NodeLocalObjects(WorkerPlacement &placement, const Args &... args) :
+      objects_(placement.nWorkers(), nullptr), bytes_(sizeof(T)) {
+    int nThreads = 0;
+#pragma omp parallel num_threads(placement.nWorkers())
+    {
+#pragma omp single
+      nThreads = omp_get_num_threads();
+      const int worker = omp_get_thread_num();
+      placement.pinCurrentThread(worker);
+      objects_[worker] = new(mapUntouched(bytes_)) T(args...);
+    }
+    LOG_IF(FATAL, nThreads != placement.nWorkers())
+    << "OpenMP granted " << nThreads << " of " << placement.nWorkers() << " threads, "
+    << placement.nWorkers() - nThreads << " workers have no object";
+    for (int worker = 0; worker < placement.nWorkers(); worker++)
+      placement.checkPages(worker, objects_[worker], bytes_);
+  }
+
+  NodeLocalObjects(const NodeLocalObjects &) = delete;
+  NodeLocalObjects &operator=(const NodeLocalObjects &) = delete;
+
+  ~NodeLocalObjects() {
+    for (T *object : objects_) {
+      object->~T();
+      munmap(object, bytes_);
+    }
+  }
+
+  int size() const { return int(objects_.size()); }
+  T &operator[](int worker) { return *objects_[worker]; }
+  typename std::vector<T *>::iterator begin() { return objects_.begin(); }
+  typename std::vector<T *>::iterator end() { return objects_.end(); }
+
+ private:
+  std::vector<T *> objects_;
+  size_t bytes_;
+};
+
+}
+}
+
+#endif //RAI_NUMA_NODELOCALOBJECTS_HPP
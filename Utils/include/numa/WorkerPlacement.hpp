@@ -0,0 +1,71 @@
+//
+// Pins rollout workers to cores and keeps their memory on the local NUMA node.
+// Topology is read from sysfs, machines without NUMA information are treated
+// as a single node.
+//
+
+#ifndef RAI_NUMA_WORKERPLACEMENT_HPP
+#define RAI_NUMA_WORKERPLACEMENT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace rai {
+namespace Numa {
+
+struct NumaTopology {
+  std::vector<std::vector<int> > cpusOfNode;
+  std::vector<int> nodeOfCpu; // -1 for offline cpus
+
+  static NumaTopology detect();
+  int nNodes() const { return int(cpusOfNode.size()); }
+};
+
+/// node currently backing each page of [ptr, ptr + bytes), -1 for pages that were never touched
+std::vector<int> nodesOfPages(const void *ptr, size_t bytes);
+
+class WorkerPlacement {
+
+ public:
+  enum class Policy {
+    compact,   // fill one node before using the next
+    scatter    // round robin over the nodes
+  };
+
+  explicit WorkerPlacement(int nWorkers, Policy policy = Policy::compact);
+
+  int nWorkers() const { return int(cpu_.size()); }
+  int cpuOf(int worker) const { return cpu_[worker]; }
+  int nodeOf(int worker) const { return node_[worker]; }
+  const NumaTopology &topology() const { return topology_; }
+
+  /// pins the calling thread to the core of worker
+  void pinCurrentThread(int worker) const;
+
+  /// counts pages of [ptr, ptr + bytes) that are not on the node of worker
+  void checkPages(int worker, const void *ptr, size_t bytes);
+
+  /// samples on which node each OpenMP thread currently runs and counts those off their worker's node.
+  /// call it once per iteration to detect threads that got migrated
+  void checkThreads();
+
+  long remotePages() const { return remotePages_.load(); }
+  long checkedPages() const { return checkedPages_.load(); }
+  long remoteThreadSamples() const { return remoteThreadSamples_.load(); }
+  long threadSamples() const { return threadSamples_.load(); }
+
+  std::string report() const;
+
+ private:
+  NumaTopology topology_;
+  std::vector<int> cpu_, node_;
+  std::atomic<long> remotePages_{0}, checkedPages_{0};
+  std::atomic<long> remoteThreadSamples_{0}, threadSamples_{0};
+};
+
+}
+}
+
+#endif //RAI_NUMA_WORKERPLACEMENT_HPP
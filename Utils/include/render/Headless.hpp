@@ -0,0 +1,27 @@
+//
+// Whether the tasks render their videos offscreen. Header only, so builds
+// without EGL, which have no offscreen rendering, share the same switch:
+//   if (rai::Render::headlessByDefault()) ...
+//
+
+#ifndef RAI_RENDER_HEADLESS_HPP
+#define RAI_RENDER_HEADLESS_HPP
+
+#include <cstdlib>
+#include <string>
+
+namespace rai {
+namespace Render {
+
+/// true when RAI_HEADLESS is set to anything but 0 or when there is no DISPLAY, the default of the tasks' headless switch
+inline bool headlessByDefault() {
+  const char *headless = std::getenv("RAI_HEADLESS");
+  if (headless && *headless) return std::string(headless) != "0";
+  const char *display = std::getenv("DISPLAY");
+  return !display || !*display;
+}
+
+}
+}
+
+#endif //RAI_RENDER_HEADLESS_HPP
@@ -0,0 +1,73 @@
+//
+// Rendering without a window, for the evaluation videos of training hosts
+// that have no X server. An EGL context draws into a pbuffer of a fixed size,
+// on the GPU through the device platform or in software through Mesa when
+// there is none, and every frame is read back as rgb rows from the top:
+//   OffscreenRenderer renderer(1280, 720);
+//   renderer.setCamera(eye, target);
+//   renderer.beginFrame();
+//   renderer.drawQuadrotor(pose, 0.15, {0.3f, 0.3f, 0.3f});
+//   renderer.endFrame(rgb);
+// The frames are as fast as the drawing, nothing waits for a display. The
+// context is current from beginFrame to endFrame only, so any thread may draw
+// a frame but one at a time.
+//
+
+#ifndef RAI_RENDER_OFFSCREENRENDERER_HPP
+#define RAI_RENDER_OFFSCREENRENDERER_HPP
+
+#include <Eigen/Core>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include "render/Headless.hpp"
+
+namespace rai {
+namespace Render {
+
+using Color = std::array<float, 3>;
+
+class OffscreenRenderer {
+
+ public:
+  OffscreenRenderer(int width, int height);
+  ~OffscreenRenderer();
+  OffscreenRenderer(const OffscreenRenderer &) = delete;
+  OffscreenRenderer &operator=(const OffscreenRenderer &) = delete;
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  /// e.g. "Mesa Project, llvmpipe" for software rendering
+  const std::string &device() const;
+
+  /// z is up, fovY in degrees
+  void setCamera(const Eigen::Vector3d &eye, const Eigen::Vector3d &target, double fovY = 45.0);
+  void setBackground(const Color &color) { background_ = color; }
+
+  /// clears the frame, everything drawn until endFrame ends up in it
+  void beginFrame();
+  /// pose is the body frame in the world, x forward and z up, the front arm is drawn red
+  void drawQuadrotor(const Eigen::Matrix4d &pose, double armLength, const Color &color);
+  void drawSphere(const Eigen::Vector3d &center, double radius, const Color &color);
+  void drawSegment(const Eigen::Vector3d &from, const Eigen::Vector3d &to, double radius, const Color &color);
+  /// lines every spacing on the plane z = height, up to halfSize from the origin
+  void drawGrid(double height, double halfSize, double spacing, const Color &color);
+  /// width * height * 3 bytes of rgb, the top row first
+  void endFrame(std::vector<unsigned char> &rgb);
+
+ private:
+  struct Context;
+
+  int width_, height_;
+  std::unique_ptr<Context> context_;
+  Eigen::Vector3d eye_, target_;
+  double fovY_ = 45.0;
+  Color background_ = {{0.62f, 0.78f, 0.92f}};
+  std::vector<unsigned char> rows_;
+};
+
+}
+}
+
+#endif //RAI_RENDER_OFFSCREENRENDERER_HPP
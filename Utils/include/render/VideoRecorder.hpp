@@ -0,0 +1,51 @@
+//
+// Writes the frames of an OffscreenRenderer to a video file. The raw rgb
+// frames are piped into ffmpeg, which encodes them while the rollout goes
+// on; hosts without ffmpeg on the PATH get numbered PPM images next to the
+// requested file instead, e.g. run_00042.ppm for run.mp4:
+//   VideoRecorder video(dir + "/run.mp4", 1280, 720, 100.0);
+//   video.write(rgb);
+//   video.close();
+//
+
+#ifndef RAI_RENDER_VIDEORECORDER_HPP
+#define RAI_RENDER_VIDEORECORDER_HPP
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace rai {
+namespace Render {
+
+class VideoRecorder {
+
+ public:
+  /// fps is the playback rate, 1 / dt plays a rollout in real time
+  VideoRecorder(const std::string &path, int width, int height, double fps);
+  ~VideoRecorder();
+  VideoRecorder(const VideoRecorder &) = delete;
+  VideoRecorder &operator=(const VideoRecorder &) = delete;
+
+  /// width * height * 3 bytes of rgb, the top row first
+  void write(const std::vector<unsigned char> &rgb);
+  /// waits for the encoder, the file is complete afterwards
+  void close();
+
+  const std::string &path() const { return path_; }
+  long frames() const { return frames_; }
+  /// false when the frames go to PPM images
+  bool encoding() const { return encoding_; }
+
+ private:
+  std::string path_;
+  int width_, height_;
+  FILE *pipe_ = nullptr;
+  long frames_ = 0;
+  bool encoding_ = false, closed_ = false;
+};
+
+}
+}
+
+#endif //RAI_RENDER_VIDEORECORDER_HPP
@@ -0,0 +1,135 @@
+//
+// Fixed-capacity replay buffer of (state, action, cost, next state,
+// termination) transitions for off-policy learning. Every field is one
+// column-major matrix with a column per slot, so a transition is a few
+// contiguous columns and a minibatch gathers whole columns. Any number of
+// actor threads push at once: a push claims its slot with one fetch_add and
+// the oldest transition is overwritten once the ring is full. Sampling takes
+// no lock either. Every slot carries a sequence number that is odd while the
+// slot is written; a sampler copies the slot and keeps the copy only if the
+// number was even and unchanged across the copy, otherwise it draws again.
+//   ReplayRing<double, 24, 4> replay(1 << 20);
+//   replay.push(state, action, cost, nextState, termType);   // from any thread
+//   replay.sample(256, states, actions, costs, nextStates, terminations, seed);
+//
+
+#ifndef RAI_REPLAY_REPLAYRING_HPP
+#define RAI_REPLAY_REPLAYRING_HPP
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "glog/logging.h"
+
+namespace rai {
+namespace Replay {
+
+template<typename Dtype, int StateDim, int ActionDim>
+class ReplayRing {
+ public:
+  using State = Eigen::Matrix<Dtype, StateDim, 1>;
+  using StateBatch = Eigen::Matrix<Dtype, StateDim, Eigen::Dynamic>;
+  using Action = Eigen::Matrix<Dtype, ActionDim, 1>;
+  using ActionBatch = Eigen::Matrix<Dtype, ActionDim, Eigen::Dynamic>;
+  using CostBatch = Eigen::Matrix<Dtype, 1, Eigen::Dynamic>;
+  using TerminationBatch = Eigen::Matrix<int8_t, 1, Eigen::Dynamic>;
+
+  /// a push may only be overtaken by capacity other pushes, so capacity has to exceed the number of actor threads
+  explicit ReplayRing(long capacity) :
+      capacity_(capacity), states_(StateDim, capacity), nextStates_(StateDim, capacity), actions_(ActionDim, capacity),
+      costs_(1, capacity), terminations_(1, capacity), sequence_(new std::atomic<uint64_t>[capacity]) {
+    LOG_IF(FATAL, capacity <= 0) << "replay ring: capacity has to be positive";
+    for (long i = 0; i < capacity; i++)
+      sequence_[i].store(0, std::memory_order_relaxed);
+  }
+
+  long capacity() const { return capacity_; }
+
+  /// one past the highest ticket of a finished push. Slower pushes with lower tickets may still be writing,
+  /// so this can run ahead of the number of finished pushes; samplers skip the slots of unfinished pushes
+  /// by their sequence numbers. Once every push has finished the ring holds the last min(pushed(), capacity())
+  uint64_t pushed() const { return published_.load(std::memory_order_acquire); }
+  long size() const { return long(std::min<uint64_t>(pushed(), uint64_t(capacity_))); }
+
+  void clear() {
+    head_.store(0);
+    published_.store(0);
+    for (long i = 0; i < capacity_; i++)
+      sequence_[i].store(0, std::memory_order_relaxed);
+  }
+
+  /// termination is a TerminationType stored as its value
+  template<typename Termination>
+  void push(const State &state, const Action &action, Dtype cost, const State &nextState, Termination termination) {
+    const uint64_t ticket = head_.fetch_add(1, std::memory_order_relaxed);
+    const long slot = long(ticket % uint64_t(capacity_));
+    sequence_[slot].store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    states_.col(slot) = state;
+    actions_.col(slot) = action;
+    costs_(slot) = cost;
+    nextStates_.col(slot) = nextState;
+    terminations_(slot) = int8_t(termination);
+    sequence_[slot].store(2 * ticket + 2, std::memory_order_release);
+
+    /// raise pushed() to this ticket, a sampler never draws beyond the highest finished push
+    uint64_t published = published_.load(std::memory_order_relaxed);
+    while (published < ticket + 1 &&
+        !published_.compare_exchange_weak(published, ticket + 1, std::memory_order_release)) {}
+  }
+
+  /// batchSize transitions drawn uniformly with replacement, in parallel over the batch.
+  /// seed makes the draw reproducible when no push runs concurrently
+  void sample(int batchSize, StateBatch &states, ActionBatch &actions, CostBatch &costs, StateBatch &nextStates,
+              TerminationBatch &terminations, uint64_t seed) const {
+    const long n = size();
+    LOG_IF(FATAL, n == 0) << "replay ring: sampling from an empty ring";
+    states.resize(StateDim, batchSize);
+    actions.resize(ActionDim, batchSize);
+    costs.resize(1, batchSize);
+    nextStates.resize(StateDim, batchSize);
+    terminations.resize(1, batchSize);
+
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < batchSize; i++) {
+      uint64_t random = seed * 0x9e3779b97f4a7c15ull + uint64_t(i);
+      random = splitmix(random);
+      while (true) {
+        const long slot = long(splitmix(random) % uint64_t(n));
+        const uint64_t before = sequence_[slot].load(std::memory_order_acquire);
+        if (before == 0 || (before & 1)) continue;
+        states.col(i) = states_.col(slot);
+        actions.col(i) = actions_.col(slot);
+        costs(i) = costs_(slot);
+        nextStates.col(i) = nextStates_.col(slot);
+        terminations(i) = terminations_(slot);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_[slot].load(std::memory_order_relaxed) == before) break;
+      }
+    }
+  }
+
+ private:
+  static uint64_t splitmix(uint64_t &state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+
+  long capacity_;
+  StateBatch states_, nextStates_;
+  ActionBatch actions_;
+  CostBatch costs_;
+  TerminationBatch terminations_;
+  std::unique_ptr<std::atomic<uint64_t>[]> sequence_;
+  alignas(64) std::atomic<uint64_t> head_{0};
+  alignas(64) std::atomic<uint64_t> published_{0};
+};
+
+}
+}
+
+#endif //RAI_REPLAY_REPLAYRING_HPP
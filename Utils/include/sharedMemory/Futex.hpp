@@ -0,0 +1,33 @@
+//
+// Thin wrappers around the linux futex syscall. The words live in memory shared
+// between processes, so the non-private operations are used.
+//
+
+#ifndef RAI_SHAREDMEMORY_FUTEX_HPP
+#define RAI_SHAREDMEMORY_FUTEX_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace rai {
+namespace SharedMemory {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex words must be plain 32 bit integers");
+
+/// sleeps while *word == expected. spurious wakeups are possible, callers re-check their condition
+inline void futexWait(std::atomic<uint32_t> *word, uint32_t expected) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+}
+
+inline void futexWakeAll(std::atomic<uint32_t> *word) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+}
+}
+
+#endif //RAI_SHAREDMEMORY_FUTEX_HPP
@@ -0,0 +1,198 @@
+//
+// Runs the envs in forked simulator processes instead of OpenMP threads of the
+// learner. Every process owns a contiguous block of envs on its own heap and
+// exchanges fixed-size records with the learner through two shared memory
+// rings (commands in, transitions out).
+//
+
+#ifndef RAI_SHAREDMEMORY_PROCESSENVPOOL_HPP
+#define RAI_SHAREDMEMORY_PROCESSENVPOOL_HPP
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <memory>
+#include <vector>
+#include <Eigen/Core>
+#include "rai/tasks/common/Task.hpp"
+#include "sharedMemory/ShmRing.hpp"
+
+namespace rai {
+namespace SharedMemory {
+
+template<typename Dtype, int StateDim, int ActionDim>
+struct EnvRecord {
+  enum Command : int32_t { step = 0, reset = 1, shutdown = 2 };
+
+  int32_t env;   // index within the pool
+  int32_t code;  // Command for the simulator, TerminationType for the learner
+  Dtype cost;
+  Dtype action[ActionDim];
+  Dtype state[StateDim];
+};
+
+template<typename Dtype, int StateDim, int ActionDim>
+class ProcessEnvPool {
+
+ public:
+  using Task_ = Task::Task<Dtype, StateDim, ActionDim, 0>;
+  using Record = EnvRecord<Dtype, StateDim, ActionDim>;
+  using Ring = ShmRing<Record>;
+  using State = Eigen::Matrix<Dtype, StateDim, 1>;
+  using StateBatch = Eigen::Matrix<Dtype, StateDim, Eigen::Dynamic>;
+  using Action = Eigen::Matrix<Dtype, ActionDim, 1>;
+  using ActionBatch = Eigen::Matrix<Dtype, ActionDim, Eigen::Dynamic>;
+  using CostBatch = Eigen::Matrix<Dtype, 1, Eigen::Dynamic>;
+
+  /// makeTask is called in the child processes only and must return a configured, heap allocated task.
+  /// episodes longer than timeLimit / controlUpdate_dt steps end with TerminationType::timeout
+  template<typename TaskFactory>
+  ProcessEnvPool(int nProcesses, int envsPerProcess, TaskFactory makeTask, double controlUpdate_dt) :
+      nProcesses_(nProcesses), envsPerProcess_(envsPerProcess) {
+    uint32_t capacity = 1;
+    while (capacity < uint32_t(envsPerProcess)) capacity <<= 1;
+    ringBytes_ = (Ring::requiredBytes(capacity) + 63) / 64 * 64;
+    mappedBytes_ = ringBytes_ * 2 * nProcesses;
+
+    /// anonymous shared mappings survive fork, so no names have to be managed
+    shm_ = mmap(nullptr, mappedBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    LOG_IF(FATAL, shm_ == MAP_FAILED) << "cannot map " << mappedBytes_ << " bytes of shared memory";
+
+    for (int p = 0; p < nProcesses; p++) {
+      commands_.emplace_back(ringAt(2 * p), capacity, true);
+      results_.emplace_back(ringAt(2 * p + 1), capacity, true);
+    }
+
+    for (int p = 0; p < nProcesses; p++) {
+      pid_t pid = fork();
+      LOG_IF(FATAL, pid < 0) << "fork failed";
+      if (pid == 0) {
+        simulate(p, makeTask, controlUpdate_dt);
+        _exit(0);
+      }
+      children_.push_back(pid);
+    }
+  }
+
+  /// owns the shared mapping and the child processes
+  ProcessEnvPool(const ProcessEnvPool &) = delete;
+  ProcessEnvPool &operator=(const ProcessEnvPool &) = delete;
+
+  ~ProcessEnvPool() {
+    Record record;
+    record.code = Record::shutdown;
+    for (int p = 0; p < nProcesses_; p++) {
+      record.env = p * envsPerProcess_;
+      commands_[p].push(record);
+    }
+    for (pid_t pid : children_)
+      waitpid(pid, nullptr, 0);
+    munmap(shm_, mappedBytes_);
+  }
+
+  int size() const { return nProcesses_ * envsPerProcess_; }
+
+  /// initial states of every env, one column per env
+  void resetAll(StateBatch &states) {
+    states.resize(StateDim, size());
+    Record record;
+    record.code = Record::reset;
+    for (int env = 0; env < size(); env++) {
+      record.env = env;
+      commands_[env / envsPerProcess_].push(record);
+    }
+    for (int p = 0; p < nProcesses_; p++)
+      for (int i = 0; i < envsPerProcess_; i++) {
+        results_[p].pop(record);
+        states.col(record.env) = Eigen::Map<State>(record.state);
+      }
+  }
+
+  /// restarts a single env, e.g. after it terminated
+  void reset(int env, State &state) {
+    Record record;
+    record.env = env;
+    record.code = Record::reset;
+    commands_[env / envsPerProcess_].push(record);
+    results_[env / envsPerProcess_].pop(record);
+    state = Eigen::Map<State>(record.state);
+  }
+
+  /// steps every env once. the processes work concurrently while the learner waits for the results
+  void step(const ActionBatch &actions,
+            StateBatch &nextStates,
+            CostBatch &costs,
+            std::vector<TerminationType> &termTypes) {
+    nextStates.resize(StateDim, size());
+    costs.resize(size());
+    termTypes.resize(size());
+
+    Record record;
+    record.code = Record::step;
+    for (int env = 0; env < size(); env++) {
+      record.env = env;
+      Eigen::Map<Action>(record.action) = actions.col(env);
+      commands_[env / envsPerProcess_].push(record);
+    }
+
+    for (int p = 0; p < nProcesses_; p++)
+      for (int i = 0; i < envsPerProcess_; i++) {
+        results_[p].pop(record);
+        nextStates.col(record.env) = Eigen::Map<State>(record.state);
+        costs(record.env) = record.cost;
+        termTypes[record.env] = TerminationType(record.code);
+      }
+  }
+
+ private:
+
+  void *ringAt(int index) {
+    return static_cast<char *>(shm_) + ringBytes_ * index;
+  }
+
+  template<typename TaskFactory>
+  void simulate(int process, TaskFactory &makeTask, double controlUpdate_dt) {
+    std::vector<std::unique_ptr<Task_> > tasks;
+    for (int i = 0; i < envsPerProcess_; i++)
+      tasks.emplace_back(makeTask());
+    const int maxSteps = int(tasks[0]->timeLimit() / controlUpdate_dt + 0.5);
+    std::vector<int> episodeSteps(envsPerProcess_, 0);
+    const int firstEnv = process * envsPerProcess_;
+
+    Record record;
+    State state;
+    Action action;
+    while (true) {
+      commands_[process].pop(record);
+      if (record.code == Record::shutdown) return;
+      const int local = record.env - firstEnv;
+
+      if (record.code == Record::reset) {
+        tasks[local]->getInitialState(state);
+        episodeSteps[local] = 0;
+        record.code = int32_t(TerminationType::not_terminated);
+        record.cost = 0;
+      } else {
+        action = Eigen::Map<Action>(record.action);
+        TerminationType termType = TerminationType::not_terminated;
+        tasks[local]->step(action, state, termType, record.cost);
+        if (termType == TerminationType::not_terminated && ++episodeSteps[local] >= maxSteps)
+          termType = TerminationType::timeout;
+        record.code = int32_t(termType);
+      }
+      Eigen::Map<State>(record.state) = state;
+      results_[process].push(record);
+    }
+  }
+
+  int nProcesses_, envsPerProcess_;
+  size_t ringBytes_, mappedBytes_;
+  void *shm_;
+  std::vector<Ring> commands_, results_;
+  std::vector<pid_t> children_;
+};
+
+}
+}
+
+#endif //RAI_SHAREDMEMORY_PROCESSENVPOOL_HPP
@@ -0,0 +1,90 @@
+//
+// Single producer, single consumer ring of fixed-size records placed in a
+// memory region shared between processes. Both sides spin briefly and then
+// sleep on a futex, the other side only issues a wake syscall when somebody
+// is actually asleep.
+//
+
+#ifndef RAI_SHAREDMEMORY_SHMRING_HPP
+#define RAI_SHAREDMEMORY_SHMRING_HPP
+
+#include <new>
+#include <type_traits>
+#include "glog/logging.h"
+#include "sharedMemory/Futex.hpp"
+
+namespace rai {
+namespace SharedMemory {
+
+template<typename Record>
+class ShmRing {
+  static_assert(std::is_trivially_copyable<Record>::value, "records are copied between processes byte by byte");
+
+ public:
+  static constexpr int spinCount = 2000;
+
+  /// bytes of shared memory needed for a ring of the given capacity
+  static size_t requiredBytes(uint32_t capacity) {
+    return sizeof(Header) + sizeof(Record) * capacity;
+  }
+
+  /// constructs the ring in memory, which must stay mapped in every process using it. capacity must be a power of 2
+  ShmRing(void *memory, uint32_t capacity, bool initialize) :
+      header_(static_cast<Header *>(memory)),
+      slots_(reinterpret_cast<Record *>(static_cast<char *>(memory) + sizeof(Header))),
+      mask_(capacity - 1) {
+    LOG_IF(FATAL, capacity == 0 || (capacity & (capacity - 1)) != 0) << "ring capacity must be a power of 2";
+    if (initialize) new(header_) Header();
+  }
+
+  void push(const Record &record) {
+    const uint32_t tail = header_->tail.load(std::memory_order_relaxed);
+    waitWhile(header_->head, header_->producerSleeping, [&](uint32_t head) { return tail - head > mask_; });
+    slots_[tail & mask_] = record;
+    header_->tail.store(tail + 1, std::memory_order_seq_cst);
+    if (header_->consumerSleeping.load(std::memory_order_seq_cst))
+      futexWakeAll(&header_->tail);
+  }
+
+  void pop(Record &record) {
+    const uint32_t head = header_->head.load(std::memory_order_relaxed);
+    waitWhile(header_->tail, header_->consumerSleeping, [&](uint32_t tail) { return tail == head; });
+    record = slots_[head & mask_];
+    header_->head.store(head + 1, std::memory_order_seq_cst);
+    if (header_->producerSleeping.load(std::memory_order_seq_cst))
+      futexWakeAll(&header_->head);
+  }
+
+ private:
+  struct Header {
+    alignas(64) std::atomic<uint32_t> head{0};
+    alignas(64) std::atomic<uint32_t> tail{0};
+    alignas(64) std::atomic<uint32_t> producerSleeping{0};
+    alignas(64) std::atomic<uint32_t> consumerSleeping{0};
+  };
+
+  /// blocks while blocked(word) holds. word is the counter owned by the other side
+  template<typename Condition>
+  static void waitWhile(std::atomic<uint32_t> &word, std::atomic<uint32_t> &sleeping, Condition blocked) {
+    uint32_t value = word.load(std::memory_order_acquire);
+    for (int i = 0; i < spinCount && blocked(value); i++)
+      value = word.load(std::memory_order_acquire);
+
+    while (blocked(value)) {
+      sleeping.store(1, std::memory_order_seq_cst);
+      value = word.load(std::memory_order_seq_cst);
+      if (blocked(value)) futexWait(&word, value);
+      sleeping.store(0, std::memory_order_seq_cst);
+      value = word.load(std::memory_order_acquire);
+    }
+  }
+
+  Header *header_;
+  Record *slots_;
+  uint32_t mask_;
+};
+
+}
+}
+
+#endif //RAI_SHAREDMEMORY_SHMRING_HPP
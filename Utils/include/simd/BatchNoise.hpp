@@ -0,0 +1,65 @@
+//
+// Exploration noise of every env in one call of the dispatched gaussian
+// kernel. The envs share one diagonal covariance, so a policy update sets it
+// once instead of copying it into a noise object per env.
+//   BatchNoise<double, 4> noise(stdev);
+//   noise.sample(noiseBatch);     // ActionDim x nEnvs
+//
+
+#ifndef RAI_SIMD_BATCHNOISE_HPP
+#define RAI_SIMD_BATCHNOISE_HPP
+
+#include <Eigen/Core>
+#include <cstdint>
+#include <random>
+#include "simd/Kernels.hpp"
+
+namespace rai {
+namespace Simd {
+
+template<typename Dtype, int ActionDim>
+class BatchNoise {
+ public:
+  using Action = Eigen::Matrix<Dtype, ActionDim, 1>;
+  using ActionBatch = Eigen::Matrix<Dtype, ActionDim, Eigen::Dynamic>;
+  using Covariance = Eigen::Matrix<Dtype, ActionDim, ActionDim>;
+
+  explicit BatchNoise(const Action &stdev, uint64_t seed = std::random_device()()) :
+      stdev_(stdev), key_(seed) {}
+
+  /// only the diagonal is used
+  void updateCovariance(const Covariance &covariance) {
+    stdev_ = covariance.diagonal().cwiseSqrt();
+  }
+
+  void setStdev(const Action &stdev) { stdev_ = stdev; }
+
+  const Action &stdev() const { return stdev_; }
+
+  /// restarts the stream, the same seed gives the same noise
+  void seed(uint64_t seed) {
+    key_ = seed;
+    counter_ = 0;
+  }
+
+  /// one column of zero mean noise per env
+  void sample(ActionBatch &noise, int nEnvs) {
+    const int n = ActionDim * nEnvs;
+    raw_.resize(ActionDim, nEnvs);
+    kernels().gaussian(key_, counter_, raw_.data(), n);
+    counter_ += uint64_t(n + 1) / 2;
+    noise = (stdev_.template cast<double>().asDiagonal() * raw_).template cast<Dtype>();
+  }
+
+  void sample(ActionBatch &noise) { sample(noise, int(noise.cols())); }
+
+ private:
+  Action stdev_;
+  uint64_t key_, counter_ = 0;
+  Eigen::Matrix<double, ActionDim, Eigen::Dynamic> raw_;
+};
+
+}
+}
+
+#endif //RAI_SIMD_BATCHNOISE_HPP
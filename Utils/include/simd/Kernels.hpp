@@ -0,0 +1,51 @@
+//
+// Vectorized kernels built once per instruction set and picked at runtime,
+// so one binary uses AVX2 or AVX-512 where the machine has it and still runs
+// on older hardware. kernels() dispatches on the cpu, kernelsFor() gives
+// every variant this machine can run to benchmark and cross-check them.
+//
+
+#ifndef RAI_SIMD_KERNELS_HPP
+#define RAI_SIMD_KERNELS_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace rai {
+namespace Simd {
+
+enum class Isa { generic, sse42, avx2, avx512 };
+
+enum class Activation { linear, tanh, relu };
+
+const char *isaName(Isa isa);
+
+/// best instruction set of this cpu. RAI_SIMD_ISA=generic|sse42|avx2|avx512 caps it
+Isa detectIsa();
+
+struct Kernels {
+  Isa isa;
+
+  /// fully connected layer over nBatch samples stored one after the other:
+  /// out[b * nOut + o] = act(bias[o] + sum_i in[b * nIn + i] * weight[i * nOut + o])
+  void (*dense)(const double *in, const double *weight, const double *bias, double *out,
+                int nIn, int nOut, int nBatch, Activation activation);
+
+  /// n standard normal samples, Box-Muller over the splitmix64 stream of key. Uses the
+  /// (n + 1) / 2 pairs starting at counter, so the next call continues at counter + (n + 1) / 2
+  void (*gaussian)(uint64_t key, uint64_t counter, double *out, int n);
+};
+
+/// kernels of detectIsa(), selected on the first call
+const Kernels &kernels();
+
+/// nullptr if this cpu cannot run isa or the variant was not built
+const Kernels *kernelsFor(Isa isa);
+
+/// every variant this cpu can run, generic first
+std::vector<const Kernels *> availableKernels();
+
+}
+}
+
+#endif //RAI_SIMD_KERNELS_HPP
@@ -0,0 +1,130 @@
+//
+// CPU evaluation of a recurrent "LSTM_merged" policy, one timestep of every
+// env per call. The LSTM state of each env lives in a RecurrentStateCache
+// and is carried from step to step, so a step costs one gate layer and the
+// MLP head instead of a pass over the episode so far. The cache holds two
+// hiddenDim vectors per env, whatever the episode length; reset an env's
+// entry when its episode ends.
+//   LstmPolicy policy(12, 128, {128, 64, 4}, Activation::relu);
+//   RecurrentStateCache cache(128, nEnvs);
+//   policy.step(states, actions, cache);
+//   cache.reset(env);
+//
+
+#ifndef RAI_SIMD_LSTMPOLICY_HPP
+#define RAI_SIMD_LSTMPOLICY_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "simd/Kernels.hpp"
+#include "simd/MlpPolicy.hpp"
+
+namespace rai {
+namespace Simd {
+
+/// hidden and cell state of every env, stored env after env
+class RecurrentStateCache {
+ public:
+  RecurrentStateCache(int hiddenDim, int nEnvs) { resize(hiddenDim, nEnvs); }
+
+  /// clears every env
+  void resize(int hiddenDim, int nEnvs) {
+    hiddenDim_ = hiddenDim;
+    nEnvs_ = nEnvs;
+    hidden_.assign(size_t(hiddenDim) * nEnvs, 0.0);
+    cell_.assign(hidden_.size(), 0.0);
+  }
+
+  /// the next step of env starts a new episode
+  void reset(int env) {
+    std::fill_n(hidden_.begin() + size_t(env) * hiddenDim_, hiddenDim_, 0.0);
+    std::fill_n(cell_.begin() + size_t(env) * hiddenDim_, hiddenDim_, 0.0);
+  }
+
+  void resetAll() {
+    std::fill(hidden_.begin(), hidden_.end(), 0.0);
+    std::fill(cell_.begin(), cell_.end(), 0.0);
+  }
+
+  int hiddenDim() const { return hiddenDim_; }
+  int nEnvs() const { return nEnvs_; }
+  double *hidden(int env = 0) { return hidden_.data() + size_t(env) * hiddenDim_; }
+  double *cell(int env = 0) { return cell_.data() + size_t(env) * hiddenDim_; }
+
+ private:
+  int hiddenDim_ = 0, nEnvs_ = 0;
+  std::vector<double> hidden_, cell_;
+};
+
+class LstmPolicy {
+ public:
+
+  /// headSizes {hiddenDim, hidden..., ActionDim} of the MLP on top of the LSTM, its output layer is linear
+  LstmPolicy(int inputDim, int hiddenDim, const std::vector<int> &headSizes, Activation headActivation,
+             double forgetBias = 1.0) :
+      inputDim_(inputDim), hiddenDim_(hiddenDim), forgetBias_(forgetBias), head_(headSizes, headActivation) {}
+
+  int hiddenDim() const { return hiddenDim_; }
+
+  long parameterSize() const {
+    return long(inputDim_ + hiddenDim_) * 4 * hiddenDim_ + 4 * hiddenDim_ + head_.parameterSize();
+  }
+
+  /// expects the TensorFlow LSTM cell first: the row major [(input + hidden) x 4 hidden] kernel
+  /// with the gates in the order input, candidate, forget, output and its bias, then the head
+  /// as in MlpPolicy. Returns false unless there are exactly parameterSize() parameters, a network
+  /// of another shape would be read with shifted weights
+  bool setParameters(const double *parameter, long size) {
+    if (size != parameterSize()) return false;
+    const long cellSize = long(inputDim_ + hiddenDim_) * 4 * hiddenDim_ + 4 * hiddenDim_;
+    cell_.assign(parameter, parameter + cellSize);
+    return head_.setParameters(parameter + cellSize, size - cellSize);
+  }
+
+  /// one timestep of nBatch = cache.nEnvs() envs, states and actions stored env after env.
+  /// Updates the cache to the state after this step
+  void step(const double *states, double *actions, RecurrentStateCache &cache) {
+    const int nBatch = cache.nEnvs(), nIn = inputDim_ + hiddenDim_, nGates = 4 * hiddenDim_;
+
+    /// [x, h] of every env, then all gate pre-activations in one layer call
+    input_.resize(size_t(nIn) * nBatch);
+    for (int b = 0; b < nBatch; b++) {
+      std::copy_n(states + size_t(b) * inputDim_, inputDim_, input_.begin() + size_t(b) * nIn);
+      std::copy_n(cache.hidden(b), hiddenDim_, input_.begin() + size_t(b) * nIn + inputDim_);
+    }
+    gates_.resize(size_t(nGates) * nBatch);
+    const double *kernel = cell_.data();
+    kernels().dense(input_.data(), kernel, kernel + long(nIn) * nGates, gates_.data(), nIn, nGates, nBatch,
+                    Activation::linear);
+
+    for (int b = 0; b < nBatch; b++) {
+      const double *gate = gates_.data() + size_t(b) * nGates;
+      double *h = cache.hidden(b), *c = cache.cell(b);
+      for (int k = 0; k < hiddenDim_; k++) {
+        const double input = sigmoid(gate[k]);
+        const double candidate = std::tanh(gate[hiddenDim_ + k]);
+        const double forget = sigmoid(gate[2 * hiddenDim_ + k] + forgetBias_);
+        const double output = sigmoid(gate[3 * hiddenDim_ + k]);
+        c[k] = forget * c[k] + input * candidate;
+        h[k] = output * std::tanh(c[k]);
+      }
+    }
+
+    head_.forward(cache.hidden(), actions, nBatch);
+  }
+
+ private:
+  static double sigmoid(double x) { return 0.5 + 0.5 * std::tanh(0.5 * x); }
+
+  int inputDim_, hiddenDim_;
+  double forgetBias_;
+  MlpPolicy head_;
+  std::vector<double> cell_;
+  std::vector<double> input_, gates_;
+};
+
+}
+}
+
+#endif //RAI_SIMD_LSTMPOLICY_HPP
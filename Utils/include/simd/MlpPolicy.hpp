@@ -0,0 +1,71 @@
+//
+// CPU evaluation of an MLP policy from its flat parameter vector (getLP),
+// through the dispatched dense kernel. Saves the TensorFlow session call per
+// step where only the action means are needed, e.g. on rollout workers.
+//
+
+#ifndef RAI_SIMD_MLPPOLICY_HPP
+#define RAI_SIMD_MLPPOLICY_HPP
+
+#include <vector>
+#include "simd/Kernels.hpp"
+
+namespace rai {
+namespace Simd {
+
+class MlpPolicy {
+ public:
+
+  /// layerSizes {StateDim, hidden..., ActionDim}, the output layer is linear
+  MlpPolicy(const std::vector<int> &layerSizes, Activation hidden) :
+      sizes_(layerSizes), hidden_(hidden) {}
+
+  /// weights and biases of all layers, without the trailing parameters such as the action stdev
+  long parameterSize() const {
+    long size = 0;
+    for (size_t l = 1; l < sizes_.size(); l++)
+      size += long(sizes_[l - 1]) * sizes_[l] + sizes_[l];
+    return size;
+  }
+
+  /// expects the TensorFlow layout: per layer the row major [in x out] weight followed by the bias.
+  /// returns false if the parameter vector is too short
+  bool setParameters(const double *parameter, long size) {
+    if (size < parameterSize()) return false;
+    parameter_.assign(parameter, parameter + parameterSize());
+    return true;
+  }
+
+  /// states and actions are stored sample after sample, as in Eigen column major batches
+  void forward(const double *states, double *actions, int nBatch) {
+    const Kernels &kernels = Simd::kernels();
+    const double *in = states;
+    const double *parameter = parameter_.data();
+    const int nLayers = int(sizes_.size()) - 1;
+
+    for (int l = 0; l < nLayers; l++) {
+      const int nIn = sizes_[l], nOut = sizes_[l + 1];
+      double *out = actions;
+      if (l < nLayers - 1) {
+        auto &buffer = buffers_[l % 2];
+        buffer.resize(size_t(nOut) * nBatch);
+        out = buffer.data();
+      }
+      kernels.dense(in, parameter, parameter + long(nIn) * nOut, out, nIn, nOut, nBatch,
+                    l < nLayers - 1 ? hidden_ : Activation::linear);
+      parameter += long(nIn) * nOut + nOut;
+      in = out;
+    }
+  }
+
+ private:
+  std::vector<int> sizes_;
+  Activation hidden_;
+  std::vector<double> parameter_;
+  std::vector<double> buffers_[2];
+};
+
+}
+}
+
+#endif //RAI_SIMD_MLPPOLICY_HPP
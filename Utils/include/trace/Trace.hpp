@@ -0,0 +1,194 @@
+//
+// Scoped tracing with per-thread event buffers and Chrome/Perfetto trace export.
+//
+// RAI_TRACE_SCOPE("name") records the lifetime of the enclosing scope on the
+// calling thread. Names must be string literals: the literal's address is the
+// interned id, so recording never hashes or copies strings. Every thread
+// appends to its own buffer without locks, the time stamps come from the TSC
+// on x86, so a span costs a few ns. Without -DRAI_TRACE the macro compiles to
+// nothing.
+//
+
+#ifndef RAI_TRACE_TRACE_HPP
+#define RAI_TRACE_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/syscall.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace rai {
+namespace Trace {
+
+struct Event {
+  const char *name;
+  uint64_t begin, end; // ticks
+};
+
+/// written by its owner thread only. count is published with release so the exporter can read concurrently
+struct ThreadBuffer {
+  explicit ThreadBuffer(size_t capacity) :
+      events(new Event[capacity]), capacity(capacity), tid(long(syscall(SYS_gettid))) {}
+
+  std::unique_ptr<Event[]> events;
+  const size_t capacity;
+  const long tid;
+  std::atomic<size_t> count{0};
+  std::atomic<size_t> dropped{0};
+};
+
+inline uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+class Tracer {
+
+ public:
+  static Tracer &instance() {
+    static Tracer tracer;
+    return tracer;
+  }
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+  /// events per thread, applies to threads that record their first event afterwards
+  void setCapacityPerThread(size_t capacity) { capacity_ = capacity; }
+
+  void record(const char *name, uint64_t begin, uint64_t end) {
+    ThreadBuffer &buffer = threadBuffer();
+    const size_t index = buffer.count.load(std::memory_order_relaxed);
+    if (index == buffer.capacity) {
+      buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    buffer.events[index] = Event{name, begin, end};
+    buffer.count.store(index + 1, std::memory_order_release);
+  }
+
+  /// writes every recorded event as a Chrome trace (chrome://tracing, ui.perfetto.dev)
+  void writeChromeTrace(const std::string &path) {
+    const double usPerTick = 1e-3 * nsPerTick();
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ofstream out(path);
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+    bool first = true;
+    const long pid = long(getpid());
+    for (auto &buffer : buffers_) {
+      out << (first ? "" : ",\n") << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": " << pid
+          << ", \"tid\": " << buffer->tid << ", \"args\": {\"name\": \"thread " << buffer->tid << "\"}}";
+      first = false;
+      const size_t count = buffer->count.load(std::memory_order_acquire);
+      for (size_t i = 0; i < count; i++) {
+        const Event &event = buffer->events[i];
+        out << ",\n{\"ph\": \"X\", \"name\": \"" << event.name << "\", \"pid\": " << pid
+            << ", \"tid\": " << buffer->tid
+            << ", \"ts\": " << (event.begin - epoch_) * usPerTick
+            << ", \"dur\": " << (event.end - event.begin) * usPerTick << "}";
+      }
+    }
+    out << "\n]}\n";
+  }
+
+  /// discards the recorded events. only call it while no thread is recording
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &buffer : buffers_) {
+      buffer->count.store(0);
+      buffer->dropped.store(0);
+    }
+    /// both ends of the calibration move together, or nsPerTick mixes the old and the new epoch
+    epoch_ = ticks();
+    epochTime_ = std::chrono::steady_clock::now();
+  }
+
+  size_t droppedEvents() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t dropped = 0;
+    for (auto &buffer : buffers_) dropped += buffer->dropped.load();
+    return dropped;
+  }
+
+ private:
+  Tracer() : epoch_(ticks()), epochTime_(std::chrono::steady_clock::now()) {}
+
+  ThreadBuffer &threadBuffer() {
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (!buffer) {
+      /// buffers outlive their threads so that the events stay exportable
+      std::lock_guard<std::mutex> lock(mutex_);
+      buffers_.emplace_back(new ThreadBuffer(capacity_));
+      buffer = buffers_.back().get();
+    }
+    return *buffer;
+  }
+
+  /// calibrates the tick rate against the steady clock over the time since construction or the last clear()
+  double nsPerTick() {
+#if defined(__x86_64__) || defined(__i386__)
+    auto sinceEpoch = [&]() { return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - epochTime_).count(); };
+    if (sinceEpoch() < 1e7) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const uint64_t tickNow = ticks();
+    return sinceEpoch() / double(tickNow - epoch_);
+#else
+    return 1e9 * std::chrono::steady_clock::period::num / std::chrono::steady_clock::period::den;
+#endif
+  }
+
+  std::atomic<bool> enabled_{true};
+  size_t capacity_ = size_t(1) << 20;
+  uint64_t epoch_;
+  std::chrono::steady_clock::time_point epochTime_;
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<ThreadBuffer> > buffers_;
+};
+
+class Scope {
+
+ public:
+  explicit Scope(const char *name) : name_(name), begin_(Tracer::instance().enabled() ? ticks() : 0) {}
+
+  ~Scope() {
+    if (begin_) Tracer::instance().record(name_, begin_, ticks());
+  }
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+ private:
+  const char *name_;
+  uint64_t begin_;
+};
+
+inline void writeChromeTrace(const std::string &path) {
+  Tracer::instance().writeChromeTrace(path);
+}
+
+}
+}
+
+#define RAI_TRACE_CONCAT_(a, b) a##b
+#define RAI_TRACE_CONCAT(a, b) RAI_TRACE_CONCAT_(a, b)
+
+#ifdef RAI_TRACE
+/// the "" name "" concatenation only compiles for string literals
+#define RAI_TRACE_SCOPE(name) ::rai::Trace::Scope RAI_TRACE_CONCAT(raiTraceScope_, __LINE__)("" name "")
+#else
+#define RAI_TRACE_SCOPE(name)
+#endif
+
+#endif //RAI_TRACE_TRACE_HPP
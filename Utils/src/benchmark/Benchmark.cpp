@@ -0,0 +1,131 @@
+#include "benchmark/Benchmark.hpp"
+
+#include <sys/utsname.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include "glog/logging.h"
+
+namespace rai {
+namespace Bench {
+
+Runner::Runner(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    auto next = [&]() -> std::string {
+      LOG_IF(FATAL, i + 1 >= argc) << arg << " needs a value";
+      return argv[++i];
+    };
+    if (arg == "--reps") options_.repetitions = std::max(2, std::atoi(next().c_str()));
+    else if (arg == "--min-time") options_.minBatchSeconds = std::atof(next().c_str());
+    else if (arg == "--filter") options_.filter = next();
+    else if (arg == "--json") options_.jsonPath = next();
+    else if (arg == "--no-vis") options_.visualization = false;
+    else
+      LOG(FATAL) << "unknown option " << arg
+                 << "\nusage: " << argv[0] << " [--reps N] [--min-time SEC] [--filter STR] [--json PATH] [--no-vis]";
+  }
+}
+
+bool Runner::enabled(const std::string &group, const std::string &name) const {
+  return options_.filter.empty() || (group + "/" + name).find(options_.filter) != std::string::npos;
+}
+
+/// two sided 95% quantile of student's t distribution
+static double tQuantile95(int dof) {
+  static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  return dof <= 30 ? table[std::max(dof, 1) - 1] : 1.96;
+}
+
+static double median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  const size_t n = values.size();
+  return n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+void Runner::record(const std::string &group, const std::string &name, long iterations, std::vector<double> &nsPerOp) {
+  Result result;
+  result.group = group;
+  result.name = name;
+  result.repetitions = int(nsPerOp.size());
+  result.iterationsPerRepetition = iterations;
+
+  const double n = double(nsPerOp.size());
+  result.nsMean = std::accumulate(nsPerOp.begin(), nsPerOp.end(), 0.0) / n;
+  double squares = 0;
+  for (double ns : nsPerOp) squares += (ns - result.nsMean) * (ns - result.nsMean);
+  result.nsStddev = std::sqrt(squares / std::max(n - 1, 1.0));
+  result.nsCi95 = tQuantile95(int(n) - 1) * result.nsStddev / std::sqrt(n);
+  result.nsMedian = median(nsPerOp);
+  result.nsMin = *std::min_element(nsPerOp.begin(), nsPerOp.end());
+  result.nsMax = *std::max_element(nsPerOp.begin(), nsPerOp.end());
+
+  std::vector<double> deviations;
+  for (double ns : nsPerOp) deviations.push_back(std::abs(ns - result.nsMedian));
+  result.nsMad = median(deviations);
+
+  results_.push_back(result);
+  std::printf("%-28s %-28s %12.1f ns/op  +-%5.1f%%  %14.0f ops/s\n",
+              group.c_str(), name.c_str(), result.nsMedian,
+              100.0 * result.nsCi95 / result.nsMean, result.opsPerSecond());
+  std::fflush(stdout);
+}
+
+std::string jsonString(const std::string &str) {
+  std::string out = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\') out += '\\';
+    if (c == '\n') {
+      out += "\\n";
+      continue;
+    }
+    out += c;
+  }
+  return out + "\"";
+}
+
+void Runner::report() const {
+  if (options_.jsonPath.empty()) return;
+  std::ofstream out(options_.jsonPath);
+  LOG_IF(FATAL, !out.good()) << "cannot write " << options_.jsonPath;
+
+  utsname host;
+  uname(&host);
+  char date[64];
+  std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+  out << "{\n  \"context\": {\"date\": " << jsonString(date)
+      << ", \"host\": " << jsonString(host.nodename)
+      << ", \"machine\": " << jsonString(host.machine)
+      << ", \"repetitions\": " << options_.repetitions
+      << ", \"min_batch_seconds\": " << options_.minBatchSeconds << "},\n  \"benchmarks\": [\n";
+  for (size_t i = 0; i < results_.size(); i++) {
+    const Result &r = results_[i];
+    out << "    {\"group\": " << jsonString(r.group) << ", \"name\": " << jsonString(r.name)
+        << ", \"repetitions\": " << r.repetitions
+        << ", \"iterations_per_repetition\": " << r.iterationsPerRepetition
+        << ", \"ns_per_op_median\": " << r.nsMedian
+        << ", \"ns_per_op_mean\": " << r.nsMean
+        << ", \"ns_per_op_stddev\": " << r.nsStddev
+        << ", \"ns_per_op_ci95\": " << r.nsCi95
+        << ", \"ns_per_op_mad\": " << r.nsMad
+        << ", \"ns_per_op_min\": " << r.nsMin
+        << ", \"ns_per_op_max\": " << r.nsMax
+        << ", \"ops_per_second\": " << r.opsPerSecond() << "}"
+        << (i + 1 < results_.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+  std::cout << "wrote " << options_.jsonPath << std::endl;
+}
+
+}
+}
@@ -0,0 +1,135 @@
+#include "distributed/Socket.hpp"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include "glog/logging.h"
+
+namespace rai {
+namespace Distributed {
+
+Socket::Socket(Socket &&other) noexcept : fd_(other.fd_) {
+  other.fd_ = -1;
+}
+
+Socket &Socket::operator=(Socket &&other) noexcept {
+  if (this != &other) {
+    close();
+    fd_ = other.fd_;
+    other.fd_ = -1;
+  }
+  return *this;
+}
+
+Socket::~Socket() {
+  close();
+}
+
+void Socket::close() {
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+}
+
+static void setNoDelay(int fd) {
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+Socket Socket::connectTo(const std::string &host, int port, double timeoutSec) {
+  addrinfo hints, *res = nullptr;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  LOG_IF(FATAL, getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &res) != 0)
+  << "cannot resolve " << host;
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeoutSec);
+  int fd = -1;
+  while (true) {
+    fd = ::socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (::connect(fd, res->ai_addr, res->ai_addrlen) == 0) break;
+    ::close(fd);
+    fd = -1;
+    if (std::chrono::steady_clock::now() > deadline) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  }
+  freeaddrinfo(res);
+  LOG_IF(FATAL, fd < 0) << "cannot connect to " << host << ":" << port;
+  setNoDelay(fd);
+  return Socket(fd);
+}
+
+Socket Socket::listenOn(const std::string &host, int port, int backlog) {
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  LOG_IF(FATAL, inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) << "invalid address " << host;
+  LOG_IF(FATAL, ::bind(fd, (sockaddr *) &addr, sizeof(addr)) != 0)
+  << "cannot bind " << host << ":" << port << " (" << std::strerror(errno) << ")";
+  LOG_IF(FATAL, ::listen(fd, backlog) != 0) << "cannot listen on " << port;
+  return Socket(fd);
+}
+
+Socket Socket::accept() {
+  int fd = ::accept(fd_, nullptr, nullptr);
+  LOG_IF(FATAL, fd < 0) << "accept failed (" << std::strerror(errno) << ")";
+  setNoDelay(fd);
+  return Socket(fd);
+}
+
+bool Socket::sendAll(const void *data, size_t bytes) {
+  const char *ptr = static_cast<const char *>(data);
+  while (bytes > 0) {
+    ssize_t n = ::send(fd_, ptr, bytes, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    ptr += n;
+    bytes -= n;
+  }
+  return true;
+}
+
+bool Socket::recvAll(void *data, size_t bytes) {
+  char *ptr = static_cast<char *>(data);
+  while (bytes > 0) {
+    ssize_t n = ::recv(fd_, ptr, bytes, 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    ptr += n;
+    bytes -= n;
+  }
+  return true;
+}
+
+bool Socket::sendFrame(MessageType type, uint32_t version, const void *payload, uint32_t bytes) {
+  FrameHeader header;
+  header.magic = FrameMagic;
+  header.type = static_cast<uint16_t>(type);
+  header.reserved = 0;
+  header.version = version;
+  header.payloadBytes = bytes;
+  if (!sendAll(&header, sizeof(header))) return false;
+  return bytes == 0 || sendAll(payload, bytes);
+}
+
+bool Socket::recvFrame(FrameHeader &header, std::vector<char> &payload) {
+  if (!recvAll(&header, sizeof(header))) return false;
+  LOG_IF(FATAL, header.magic != FrameMagic) << "corrupted frame";
+  payload.resize(header.payloadBytes);
+  return header.payloadBytes == 0 || recvAll(payload.data(), header.payloadBytes);
+}
+
+}
+}
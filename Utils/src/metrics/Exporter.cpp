@@ -0,0 +1,134 @@
+//
+// Background writer of the training metrics, see metrics/Exporter.hpp
+//
+
+#include "metrics/Exporter.hpp"
+#include "metrics/TimerPhases.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include "glog/logging.h"
+
+namespace rai {
+namespace Metrics {
+
+namespace {
+
+std::string prometheusName(const std::string &name) {
+  std::string out = "rai_";
+  for (char c : name)
+    out += std::isalnum(static_cast<unsigned char>(c)) ? char(std::tolower(c)) : '_';
+  return out;
+}
+
+}
+
+Exporter::Exporter(const std::string &directory, const std::string &runName) :
+    csvPath_(directory + "/metrics.csv"),
+    promPath_(directory + "/metrics.prom"),
+    runName_(runName) {
+  csv_ = std::fopen(csvPath_.c_str(), "a");
+  LOG_IF(FATAL, !csv_) << "metrics: cannot open " << csvPath_;
+  if (std::ftell(csv_) == 0) std::fputs("run,iteration,seconds,name,value\n", csv_);
+  std::fflush(csv_);
+
+  start_ = lastCommit_ = std::chrono::steady_clock::now();
+  lastTimer_ = readTimer();
+  writer_ = std::thread(&Exporter::writerLoop, this);
+}
+
+Exporter::~Exporter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_one();
+  writer_.join();
+  std::fclose(csv_);
+}
+
+void Exporter::set(const std::string &name, double value) {
+  current_.values.emplace_back(name, value);
+}
+
+void Exporter::setSteps(double stepsTaken) {
+  steps_ = stepsTaken;
+}
+
+void Exporter::commit(long iteration) {
+  auto now = std::chrono::steady_clock::now();
+  double iterationSeconds = std::chrono::duration<double>(now - lastCommit_).count();
+
+  current_.iteration = iteration;
+  current_.seconds = std::chrono::duration<double>(now - start_).count();
+  set("iteration_seconds", iterationSeconds);
+  if (steps_ >= 0) {
+    set("steps", steps_);
+    if (lastSteps_ >= 0 && iterationSeconds > 0) set("steps_per_second", (steps_ - lastSteps_) / iterationSeconds);
+    lastSteps_ = steps_;
+  }
+
+  auto timer = readTimer();
+  for (auto &phase : phaseDeltas(lastTimer_, timer))
+    set("phase_" + phase.first + "_seconds", phase.second);
+  lastTimer_ = std::move(timer);
+  lastCommit_ = now;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(current_));
+  }
+  wake_.notify_one();
+  current_ = Row();
+}
+
+void Exporter::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return queue_.empty() && !writing_; });
+}
+
+void Exporter::writerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) break;
+
+    std::deque<Row> rows;
+    rows.swap(queue_);
+    writing_ = true;
+    lock.unlock();
+
+    for (auto &row : rows) write(row);
+    std::fflush(csv_);
+    writePrometheus();
+
+    lock.lock();
+    writing_ = false;
+    idle_.notify_all();
+  }
+}
+
+void Exporter::write(const Row &row) {
+  for (auto &value : row.values) {
+    std::fprintf(csv_, "%s,%ld,%.3f,%s,%.9g\n",
+                 runName_.c_str(), row.iteration, row.seconds, value.first.c_str(), value.second);
+    latest_[value.first] = value.second;
+  }
+  latestIteration_ = row.iteration;
+}
+
+/// written next to the target and renamed over it, a scraper never reads a partial file
+void Exporter::writePrometheus() {
+  std::string tmpPath = promPath_ + ".tmp";
+  std::FILE *prom = std::fopen(tmpPath.c_str(), "w");
+  if (!prom) return;
+  std::fprintf(prom, "rai_iteration{run=\"%s\"} %ld\n", runName_.c_str(), latestIteration_);
+  for (auto &value : latest_)
+    std::fprintf(prom, "%s{run=\"%s\"} %.9g\n",
+                 prometheusName(value.first).c_str(), runName_.c_str(), value.second);
+  std::fclose(prom);
+  std::rename(tmpPath.c_str(), promPath_.c_str());
+}
+
+}
+}
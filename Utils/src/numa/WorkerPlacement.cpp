@@ -0,0 +1,138 @@
+#include "numa/WorkerPlacement.hpp"
+
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+#include <omp.h>
+#include "glog/logging.h"
+
+namespace rai {
+namespace Numa {
+
+/// parses lists such as "0-3,8-11"
+static std::vector<int> parseCpuList(const std::string &list) {
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n") continue;
+    size_t dash = range.find('-');
+    int first = std::stoi(range.substr(0, dash));
+    int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last; cpu++)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+NumaTopology NumaTopology::detect() {
+  NumaTopology topology;
+  for (int node = 0;; node++) {
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    if (!file.good()) break;
+    std::string list;
+    std::getline(file, list);
+    topology.cpusOfNode.push_back(parseCpuList(list));
+  }
+
+  if (topology.cpusOfNode.empty()) {
+    topology.cpusOfNode.emplace_back();
+    for (int cpu = 0; cpu < int(sysconf(_SC_NPROCESSORS_ONLN)); cpu++)
+      topology.cpusOfNode[0].push_back(cpu);
+  }
+
+  for (int node = 0; node < topology.nNodes(); node++)
+    for (int cpu : topology.cpusOfNode[node]) {
+      if (cpu >= int(topology.nodeOfCpu.size())) topology.nodeOfCpu.resize(cpu + 1, -1);
+      topology.nodeOfCpu[cpu] = node;
+    }
+  return topology;
+}
+
+std::vector<int> nodesOfPages(const void *ptr, size_t bytes) {
+  const uintptr_t pageSize = uintptr_t(sysconf(_SC_PAGESIZE));
+  const uintptr_t first = uintptr_t(ptr) & ~(pageSize - 1);
+  const uintptr_t last = (uintptr_t(ptr) + bytes + pageSize - 1) & ~(pageSize - 1);
+
+  std::vector<void *> pages;
+  for (uintptr_t page = first; page < last; page += pageSize)
+    pages.push_back(reinterpret_cast<void *>(page));
+  std::vector<int> status(pages.size(), -1);
+
+  /// move_pages without target nodes only reports where the pages are
+  if (!pages.empty() && syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0)
+    std::fill(status.begin(), status.end(), -1);
+  for (auto &node : status)
+    if (node < 0) node = -1;
+  return status;
+}
+
+WorkerPlacement::WorkerPlacement(int nWorkers, Policy policy) :
+    topology_(NumaTopology::detect()) {
+  std::vector<std::pair<int, int> > slots; // (cpu, node) in the order they are handed out
+  if (policy == Policy::compact) {
+    for (int node = 0; node < topology_.nNodes(); node++)
+      for (int cpu : topology_.cpusOfNode[node])
+        slots.emplace_back(cpu, node);
+  } else {
+    for (size_t i = 0;; i++) {
+      bool added = false;
+      for (int node = 0; node < topology_.nNodes(); node++)
+        if (i < topology_.cpusOfNode[node].size()) {
+          slots.emplace_back(topology_.cpusOfNode[node][i], node);
+          added = true;
+        }
+      if (!added) break;
+    }
+  }
+  LOG_IF(FATAL, slots.empty()) << "no online cpus found";
+
+  for (int worker = 0; worker < nWorkers; worker++) {
+    /// oversubscription wraps around, the workers then share cores
+    cpu_.push_back(slots[worker % slots.size()].first);
+    node_.push_back(slots[worker % slots.size()].second);
+  }
+}
+
+void WorkerPlacement::pinCurrentThread(int worker) const {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu_[worker], &set);
+  LOG_IF(WARNING, sched_setaffinity(0, sizeof(set), &set) != 0)
+  << "cannot pin worker " << worker << " to cpu " << cpu_[worker];
+}
+
+void WorkerPlacement::checkPages(int worker, const void *ptr, size_t bytes) {
+  long remote = 0, checked = 0;
+  for (int node : nodesOfPages(ptr, bytes)) {
+    if (node < 0) continue;
+    checked++;
+    remote += node != node_[worker];
+  }
+  remotePages_ += remote;
+  checkedPages_ += checked;
+}
+
+void WorkerPlacement::checkThreads() {
+#pragma omp parallel num_threads(nWorkers())
+  {
+    const int cpu = sched_getcpu();
+    const int worker = omp_get_thread_num();
+    const int node = cpu >= 0 && cpu < int(topology_.nodeOfCpu.size()) ? topology_.nodeOfCpu[cpu] : -1;
+    threadSamples_++;
+    if (node != node_[worker]) remoteThreadSamples_++;
+  }
+}
+
+std::string WorkerPlacement::report() const {
+  std::stringstream ss;
+  ss << nWorkers() << " workers on " << topology_.nNodes() << " numa nodes, "
+     << remotePages() << "/" << checkedPages() << " pages on a remote node, "
+     << remoteThreadSamples() << "/" << threadSamples() << " thread samples off their node";
+  return ss.str();
+}
+
+}
+}
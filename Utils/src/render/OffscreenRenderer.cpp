@@ -0,0 +1,221 @@
+#include "render/OffscreenRenderer.hpp"
+
+#include <Eigen/Geometry>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <GL/glu.h>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "glog/logging.h"
+
+namespace rai {
+namespace Render {
+
+struct OffscreenRenderer::Context {
+  EGLDisplay display = EGL_NO_DISPLAY;
+  EGLConfig config = nullptr;
+  EGLSurface surface = EGL_NO_SURFACE;
+  EGLContext context = EGL_NO_CONTEXT;
+  GLUquadric *quadric = nullptr;
+  std::string device;
+};
+
+/// an rgb pbuffer config with depth. No multisampling, in software it would double the cost of a frame
+static bool chooseConfig(EGLDisplay display, EGLConfig &config) {
+  const EGLint attributes[] = {
+      EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+      EGL_DEPTH_SIZE, 24,
+      EGL_NONE};
+  EGLint nConfigs = 0;
+  return eglChooseConfig(display, attributes, &config, 1, &nConfigs) && nConfigs > 0;
+}
+
+static bool initializeDisplay(EGLDisplay display, EGLConfig &config) {
+  if (display == EGL_NO_DISPLAY) return false;
+  EGLint major, minor;
+  if (!eglInitialize(display, &major, &minor)) return false;
+  return chooseConfig(display, config);
+}
+
+/// the first display that renders to a pbuffer: a GPU or software device without any window system,
+/// then Mesa's surfaceless platform, then the default display
+static void openDisplay(EGLDisplay &display, EGLConfig &config) {
+  auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+  auto queryDevices = (PFNEGLQUERYDEVICESEXTPROC) eglGetProcAddress("eglQueryDevicesEXT");
+
+  if (getPlatformDisplay && queryDevices) {
+    EGLDeviceEXT devices[16];
+    EGLint nDevices = 0;
+    if (queryDevices(16, devices, &nDevices)) {
+      for (int i = 0; i < nDevices; i++) {
+        display = getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, devices[i], nullptr);
+        if (initializeDisplay(display, config)) return;
+      }
+    }
+  }
+  if (getPlatformDisplay) {
+    display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (initializeDisplay(display, config)) return;
+  }
+  display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (initializeDisplay(display, config)) return;
+  LOG(FATAL) << "no EGL display renders offscreen, EGL error 0x" << std::hex << eglGetError();
+}
+
+OffscreenRenderer::OffscreenRenderer(int width, int height) :
+    width_(width), height_(height), context_(new Context), eye_(-3.0, 0.0, 1.0), target_(0.0, 0.0, 0.0),
+    rows_(size_t(width) * height * 3) {
+  LOG_IF(FATAL, width <= 0 || height <= 0) << "offscreen frames need a size, got " << width << "x" << height;
+  openDisplay(context_->display, context_->config);
+
+  const EGLint surfaceAttributes[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+  context_->surface = eglCreatePbufferSurface(context_->display, context_->config, surfaceAttributes);
+  LOG_IF(FATAL, context_->surface == EGL_NO_SURFACE)
+  << "could not create a " << width << "x" << height << " pbuffer, EGL error 0x" << std::hex << eglGetError();
+
+  eglBindAPI(EGL_OPENGL_API);
+  context_->context = eglCreateContext(context_->display, context_->config, EGL_NO_CONTEXT, nullptr);
+  LOG_IF(FATAL, context_->context == EGL_NO_CONTEXT)
+  << "could not create an OpenGL context, EGL error 0x" << std::hex << eglGetError();
+  context_->quadric = gluNewQuadric();
+
+  const char *vendor = eglQueryString(context_->display, EGL_VENDOR);
+  context_->device = vendor ? vendor : "unknown";
+  if (eglMakeCurrent(context_->display, context_->surface, context_->surface, context_->context)) {
+    const GLubyte *renderer = glGetString(GL_RENDERER);
+    if (renderer) context_->device += std::string(", ") + reinterpret_cast<const char *>(renderer);
+    eglMakeCurrent(context_->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  }
+}
+
+/// the display stays initialized, other renderers of the process share it
+OffscreenRenderer::~OffscreenRenderer() {
+  if (context_->quadric) gluDeleteQuadric(context_->quadric);
+  eglMakeCurrent(context_->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  if (context_->context != EGL_NO_CONTEXT) eglDestroyContext(context_->display, context_->context);
+  if (context_->surface != EGL_NO_SURFACE) eglDestroySurface(context_->display, context_->surface);
+}
+
+const std::string &OffscreenRenderer::device() const {
+  return context_->device;
+}
+
+void OffscreenRenderer::setCamera(const Eigen::Vector3d &eye, const Eigen::Vector3d &target, double fovY) {
+  eye_ = eye;
+  target_ = target;
+  fovY_ = fovY;
+}
+
+void OffscreenRenderer::beginFrame() {
+  LOG_IF(FATAL, !eglMakeCurrent(context_->display, context_->surface, context_->surface, context_->context))
+  << "could not make the offscreen context current, EGL error 0x" << std::hex << eglGetError();
+
+  glViewport(0, 0, width_, height_);
+  glClearColor(background_[0], background_[1], background_[2], 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  glMatrixMode(GL_PROJECTION);
+  glLoadIdentity();
+  gluPerspective(fovY_, double(width_) / height_, 0.05, 100.0);
+  glMatrixMode(GL_MODELVIEW);
+  glLoadIdentity();
+  gluLookAt(eye_(0), eye_(1), eye_(2), target_(0), target_(1), target_(2), 0.0, 0.0, 1.0);
+
+  /// a sun above and behind the camera, in world coordinates
+  const GLfloat sun[] = {-0.4f, 0.3f, 1.0f, 0.0f};
+  const GLfloat ambient[] = {0.35f, 0.35f, 0.35f, 1.0f}, diffuse[] = {0.7f, 0.7f, 0.7f, 1.0f};
+  glEnable(GL_DEPTH_TEST);
+  glEnable(GL_LIGHTING);
+  glEnable(GL_LIGHT0);
+  glEnable(GL_NORMALIZE);
+  glEnable(GL_COLOR_MATERIAL);
+  glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
+  glLightfv(GL_LIGHT0, GL_POSITION, sun);
+  glLightfv(GL_LIGHT0, GL_AMBIENT, ambient);
+  glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuse);
+}
+
+void OffscreenRenderer::drawQuadrotor(const Eigen::Matrix4d &pose, double armLength, const Color &color) {
+  const Color front = {{0.9f, 0.1f, 0.1f}}, rotor = {{0.15f, 0.15f, 0.15f}};
+  const double armRadius = 0.06 * armLength, rotorRadius = 0.45 * armLength;
+  glPushMatrix();
+  glMultMatrixd(pose.data());
+
+  drawSphere(Eigen::Vector3d::Zero(), 0.25 * armLength, color);
+  drawSegment(Eigen::Vector3d::Zero(), Eigen::Vector3d(armLength, 0, 0), armRadius, front);
+  drawSegment(Eigen::Vector3d::Zero(), Eigen::Vector3d(-armLength, 0, 0), armRadius, color);
+  drawSegment(Eigen::Vector3d(0, -armLength, 0), Eigen::Vector3d(0, armLength, 0), armRadius, color);
+
+  glColor3fv(rotor.data());
+  const double tips[4][2] = {{armLength, 0}, {-armLength, 0}, {0, armLength}, {0, -armLength}};
+  for (const auto &tip : tips) {
+    glPushMatrix();
+    glTranslated(tip[0], tip[1], armRadius);
+    gluDisk(context_->quadric, 0.0, rotorRadius, 20, 1);
+    glPopMatrix();
+  }
+  glPopMatrix();
+}
+
+void OffscreenRenderer::drawSphere(const Eigen::Vector3d &center, double radius, const Color &color) {
+  glPushMatrix();
+  glTranslated(center(0), center(1), center(2));
+  glColor3fv(color.data());
+  gluSphere(context_->quadric, radius, 20, 14);
+  glPopMatrix();
+}
+
+void OffscreenRenderer::drawSegment(const Eigen::Vector3d &from, const Eigen::Vector3d &to, double radius,
+                                    const Color &color) {
+  const Eigen::Vector3d direction = to - from;
+  const double length = direction.norm();
+  if (length < 1e-9) return;
+
+  /// a GLU cylinder runs along z, turned onto the direction of the segment
+  const Eigen::Vector3d axis = Eigen::Vector3d::UnitZ().cross(direction);
+  const double angle = std::atan2(axis.norm(), direction(2)) * 180.0 / M_PI;
+  glPushMatrix();
+  glTranslated(from(0), from(1), from(2));
+  if (axis.norm() > 1e-9 * length)
+    glRotated(angle, axis(0), axis(1), axis(2));
+  else if (direction(2) < 0.0)
+    glRotated(180.0, 1.0, 0.0, 0.0);
+  glColor3fv(color.data());
+  gluCylinder(context_->quadric, radius, radius, length, 12, 1);
+  glPopMatrix();
+}
+
+void OffscreenRenderer::drawGrid(double height, double halfSize, double spacing, const Color &color) {
+  const int nLines = int(halfSize / spacing);
+  glDisable(GL_LIGHTING);
+  glColor3fv(color.data());
+  glBegin(GL_LINES);
+  for (int i = -nLines; i <= nLines; i++) {
+    glVertex3d(i * spacing, -halfSize, height);
+    glVertex3d(i * spacing, halfSize, height);
+    glVertex3d(-halfSize, i * spacing, height);
+    glVertex3d(halfSize, i * spacing, height);
+  }
+  glEnd();
+  glEnable(GL_LIGHTING);
+}
+
+void OffscreenRenderer::endFrame(std::vector<unsigned char> &rgb) {
+  const size_t rowBytes = size_t(width_) * 3;
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, width_, height_, GL_RGB, GL_UNSIGNED_BYTE, rows_.data());
+  /// released, the next frame may be drawn by another thread
+  eglMakeCurrent(context_->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+  /// OpenGL reads the bottom row first
+  rgb.resize(rows_.size());
+  for (int row = 0; row < height_; row++)
+    std::memcpy(&rgb[row * rowBytes], &rows_[(height_ - 1 - row) * rowBytes], rowBytes);
+}
+
+}
+}
@@ -0,0 +1,67 @@
+#include "render/VideoRecorder.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include "glog/logging.h"
+
+namespace rai {
+namespace Render {
+
+static bool ffmpegAvailable() {
+  return std::system("command -v ffmpeg > /dev/null 2>&1") == 0;
+}
+
+VideoRecorder::VideoRecorder(const std::string &path, int width, int height, double fps) :
+    path_(path), width_(width), height_(height) {
+  LOG_IF(FATAL, fps <= 0.0) << "a video needs a positive frame rate, got " << fps;
+  if (!ffmpegAvailable()) {
+    LOG(WARNING) << "ffmpeg is not on the PATH, the frames of " << path_ << " are written as PPM images";
+    return;
+  }
+  /// yuv420p plays everywhere but needs even sizes, the filter pads odd ones by a pixel
+  std::ostringstream command;
+  command << "ffmpeg -loglevel error -y -f rawvideo -pix_fmt rgb24 -s " << width << "x" << height
+          << " -r " << fps << " -i - -vf 'pad=ceil(iw/2)*2:ceil(ih/2)*2'"
+          << " -c:v libx264 -preset veryfast -pix_fmt yuv420p '" << path_ << "'";
+  pipe_ = popen(command.str().c_str(), "w");
+  encoding_ = pipe_ != nullptr;
+  LOG_IF(WARNING, !pipe_) << "could not start ffmpeg, the frames of " << path_ << " are written as PPM images";
+}
+
+VideoRecorder::~VideoRecorder() {
+  close();
+}
+
+void VideoRecorder::write(const std::vector<unsigned char> &rgb) {
+  LOG_IF(FATAL, closed_) << path_ << " is closed";
+  LOG_IF(FATAL, rgb.size() != size_t(width_) * height_ * 3)
+  << "expected a " << width_ << "x" << height_ << " rgb frame, got " << rgb.size() << " bytes";
+
+  if (pipe_) {
+    LOG_IF(ERROR, std::fwrite(rgb.data(), 1, rgb.size(), pipe_) != rgb.size())
+    << "ffmpeg stopped taking frames of " << path_;
+  } else {
+    const size_t dot = path_.rfind('.');
+    std::ostringstream image;
+    image << path_.substr(0, dot == std::string::npos || dot < path_.rfind('/') + 1 ? path_.size() : dot)
+          << "_" << std::setw(5) << std::setfill('0') << frames_ << ".ppm";
+    std::ofstream file(image.str(), std::ios::binary);
+    file << "P6\n" << width_ << " " << height_ << "\n255\n";
+    file.write(reinterpret_cast<const char *>(rgb.data()), rgb.size());
+  }
+  frames_++;
+}
+
+void VideoRecorder::close() {
+  if (closed_) return;
+  closed_ = true;
+  if (!pipe_) return;
+  const int status = pclose(pipe_);
+  pipe_ = nullptr;
+  LOG_IF(ERROR, status != 0) << "ffmpeg failed on " << path_ << " with status " << status;
+}
+
+}
+}
@@ -0,0 +1,102 @@
+//
+// Runtime selection of the kernel variants, see simd/Kernels.hpp
+//
+
+#include "simd/Kernels.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__)
+#define RAI_SIMD_X86
+#endif
+
+namespace rai {
+namespace Simd {
+
+#define RAI_SIMD_DECLARE(variant) \
+  namespace variant { \
+  void dense(const double *in, const double *weight, const double *bias, double *out, \
+             int nIn, int nOut, int nBatch, Activation activation); \
+  void gaussian(uint64_t key, uint64_t counter, double *out, int n); \
+  }
+
+RAI_SIMD_DECLARE(generic)
+#ifdef RAI_SIMD_X86
+RAI_SIMD_DECLARE(sse42)
+RAI_SIMD_DECLARE(avx2)
+RAI_SIMD_DECLARE(avx512)
+#endif
+
+#undef RAI_SIMD_DECLARE
+
+namespace {
+
+const Kernels variants[] = {
+    {Isa::generic, generic::dense, generic::gaussian},
+#ifdef RAI_SIMD_X86
+    {Isa::sse42, sse42::dense, sse42::gaussian},
+    {Isa::avx2, avx2::dense, avx2::gaussian},
+    {Isa::avx512, avx512::dense, avx512::gaussian},
+#endif
+};
+
+bool cpuSupports(Isa isa) {
+#ifdef RAI_SIMD_X86
+  __builtin_cpu_init();
+  switch (isa) {
+    case Isa::generic: return true;
+    case Isa::sse42: return __builtin_cpu_supports("sse4.2");
+    case Isa::avx2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case Isa::avx512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq");
+  }
+  return false;
+#else
+  return isa == Isa::generic;
+#endif
+}
+
+}
+
+const char *isaName(Isa isa) {
+  switch (isa) {
+    case Isa::generic: return "generic";
+    case Isa::sse42: return "sse42";
+    case Isa::avx2: return "avx2";
+    case Isa::avx512: return "avx512";
+  }
+  return "unknown";
+}
+
+Isa detectIsa() {
+  Isa cap = Isa::avx512;
+  if (const char *requested = std::getenv("RAI_SIMD_ISA"))
+    for (Isa isa : {Isa::generic, Isa::sse42, Isa::avx2, Isa::avx512})
+      if (std::strcmp(requested, isaName(isa)) == 0) cap = isa;
+
+  Isa best = Isa::generic;
+  for (auto &variant : variants)
+    if (variant.isa <= cap && cpuSupports(variant.isa)) best = variant.isa;
+  return best;
+}
+
+const Kernels &kernels() {
+  static const Kernels *selected = kernelsFor(detectIsa());
+  return *selected;
+}
+
+const Kernels *kernelsFor(Isa isa) {
+  for (auto &variant : variants)
+    if (variant.isa == isa) return cpuSupports(isa) ? &variant : nullptr;
+  return nullptr;
+}
+
+std::vector<const Kernels *> availableKernels() {
+  std::vector<const Kernels *> available;
+  for (auto &variant : variants)
+    if (cpuSupports(variant.isa)) available.push_back(&variant);
+  return available;
+}
+
+}
+}
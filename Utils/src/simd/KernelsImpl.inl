@@ -0,0 +1,237 @@
+//
+// Kernel bodies, included by one source file per instruction set with
+// RAI_SIMD_VARIANT set to its namespace. They are written as plain loops for
+// the compiler to vectorize for that file's target. Helpers must have
+// internal linkage: an inline function shared between variants could be
+// merged by the linker into the AVX-512 copy and run on a cpu without it.
+//
+
+#include <cstdint>
+#include <cstring>
+#include "simd/Kernels.hpp"
+
+#ifndef RAI_SIMD_VARIANT
+#error "define RAI_SIMD_VARIANT before including KernelsImpl.inl"
+#endif
+
+
+namespace rai {
+namespace Simd {
+namespace RAI_SIMD_VARIANT {
+
+namespace {
+
+/// exp(x) for x in [-709, 0] without a library call, so the loop around it vectorizes
+inline double expNonPositive(double x) {
+  const double log2e = 1.4426950408889634, ln2 = 0.6931471805599453;
+  const double round = 6755399441055744.0;  // 1.5 * 2^52, adding it rounds to an integer
+  double t = x * log2e;
+  double n = (t + round) - round;
+  double f = (t - n) * ln2;                 // |f| <= ln2 / 2
+
+  double p = 1.0 / 39916800.0;
+  p = p * f + 1.0 / 3628800.0;
+  p = p * f + 1.0 / 362880.0;
+  p = p * f + 1.0 / 40320.0;
+  p = p * f + 1.0 / 5040.0;
+  p = p * f + 1.0 / 720.0;
+  p = p * f + 1.0 / 120.0;
+  p = p * f + 1.0 / 24.0;
+  p = p * f + 1.0 / 6.0;
+  p = p * f + 0.5;
+  p = p * f + 1.0;
+  p = p * f + 1.0;
+
+  /// 2^n through the exponent bits
+  double shifted = n + round;
+  int64_t bits;
+  std::memcpy(&bits, &shifted, sizeof(bits));
+  bits = (bits + 1023) << 52;
+  double scale;
+  std::memcpy(&scale, &bits, sizeof(scale));
+  return p * scale;
+}
+
+/// double with the given bits and the other way round, both vectorize to plain register moves
+inline double asDouble(uint64_t bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+inline uint64_t asBits(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+/// output k of the splitmix64 stream seeded with key
+inline uint64_t splitmix64(uint64_t key, uint64_t k) {
+  uint64_t z = key + k * 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/// log(x) for x in (0, 1]. The exponent is read from the bits, log of the mantissa m in
+/// [sqrt(1/2), sqrt(2)) is 2 atanh((m - 1) / (m + 1)) as a series
+inline double logPositive(double x) {
+  const uint64_t bits = asBits(x);
+  const uint64_t mantissaMask = (uint64_t(1) << 52) - 1, one = uint64_t(1023) << 52;
+  /// 2^52 + biased exponent, read back as a double, avoids an int64 conversion
+  double exponent = asDouble((bits >> 52) | (uint64_t(0x433) << 52)) - (4503599627370496.0 + 1023.0);
+  double m = asDouble((bits & mantissaMask) | one);
+  /// arithmetic instead of a branch on high, so the caller's loop stays straight line code
+  const bool high = m > 1.4142135623730951;
+  m = m * (1.0 - 0.5 * high);
+  exponent += high;
+
+  const double s = (m - 1.0) / (m + 1.0), s2 = s * s;
+  double p = 1.0 / 21.0;
+  p = p * s2 + 1.0 / 19.0;
+  p = p * s2 + 1.0 / 17.0;
+  p = p * s2 + 1.0 / 15.0;
+  p = p * s2 + 1.0 / 13.0;
+  p = p * s2 + 1.0 / 11.0;
+  p = p * s2 + 1.0 / 9.0;
+  p = p * s2 + 1.0 / 7.0;
+  p = p * s2 + 1.0 / 5.0;
+  p = p * s2 + 1.0 / 3.0;
+  p = p * s2 + 1.0;
+  return exponent * 0.6931471805599453 + 2.0 * s * p;
+}
+
+/// sqrt(x) for x >= 0 through Newton steps on 1 / sqrt(x). std::sqrt may set errno, and the
+/// check for that keeps the calling loop scalar unless the build passes -fno-math-errno
+inline double sqrtNonNegative(double x) {
+  const double y = x + 1e-300;  // keeps r finite at x = 0, the smallest other input is about 4e-16
+  double r = asDouble(0x5fe6eb50c7b537a9ULL - (asBits(y) >> 1));  // within 4% of 1 / sqrt(y)
+  r = r * (1.5 - 0.5 * y * r * r);
+  r = r * (1.5 - 0.5 * y * r * r);
+  r = r * (1.5 - 0.5 * y * r * r);
+  r = r * (1.5 - 0.5 * y * r * r);
+  return x * r;
+}
+
+/// one Box-Muller pair from two random words. The first gives the radius, the second a
+/// uniform angle as a quadrant (two low bits) plus an offset in [-pi/4, pi/4) (the high bits)
+inline void boxMuller(uint64_t radiusBits, uint64_t angleBits, double &z0, double &z1) {
+  const uint64_t one = uint64_t(1023) << 52;
+  const double u = 2.0 - asDouble((radiusBits >> 12) | one);  // (0, 1]
+  const double r = sqrtNonNegative(-2.0 * logPositive(u));
+  const double f = (asDouble((angleBits >> 12) | one) - 1.5) * 1.5707963267948966;
+
+  const double f2 = f * f;
+  double sp = -1.0 / 1307674368000.0;
+  sp = sp * f2 + 1.0 / 6227020800.0;
+  sp = sp * f2 - 1.0 / 39916800.0;
+  sp = sp * f2 + 1.0 / 362880.0;
+  sp = sp * f2 - 1.0 / 5040.0;
+  sp = sp * f2 + 1.0 / 120.0;
+  sp = sp * f2 - 1.0 / 6.0;
+  sp = sp * f2 + 1.0;
+  const double sinF = f * sp;
+  double cp = 1.0 / 20922789888000.0;
+  cp = cp * f2 - 1.0 / 87178291200.0;
+  cp = cp * f2 + 1.0 / 479001600.0;
+  cp = cp * f2 - 1.0 / 3628800.0;
+  cp = cp * f2 + 1.0 / 40320.0;
+  cp = cp * f2 - 1.0 / 720.0;
+  cp = cp * f2 + 1.0 / 24.0;
+  cp = cp * f2 - 0.5;
+  cp = cp * f2 + 1.0;
+  const double cosF = cp;
+
+  /// rotate by the quadrant q: (cos, sin) of f + q pi / 2 is (c, s), (-s, c), (-c, -s), (s, -c)
+  const uint64_t q = angleBits & 3, swap = uint64_t(0) - (q & 1);
+  const uint64_t sinBits = asBits(sinF), cosBits = asBits(cosF);
+  const uint64_t cosOut = ((cosBits & ~swap) | (sinBits & swap)) ^ (((q ^ (q >> 1)) & 1) << 63);
+  const uint64_t sinOut = ((sinBits & ~swap) | (cosBits & swap)) ^ ((q >> 1) << 63);
+  z0 = r * asDouble(cosOut);
+  z1 = r * asDouble(sinOut);
+}
+
+void activate(double *out, int n, Activation activation) {
+  switch (activation) {
+    case Activation::linear:
+      break;
+    case Activation::tanh:
+      for (int o = 0; o < n; o++) {
+        double x = out[o];
+        double a = x < 0 ? -x : x;
+        a = a > 20.0 ? 20.0 : a;
+        double e = expNonPositive(-2.0 * a);
+        double y = (1.0 - e) / (1.0 + e);
+        out[o] = x < 0 ? -y : y;
+      }
+      break;
+    case Activation::relu:
+      for (int o = 0; o < n; o++)
+        out[o] = out[o] > 0 ? out[o] : 0.0;
+      break;
+  }
+}
+
+/// y_s += a_s * w for four samples, restrict parameters tell the compiler the rows do not overlap
+inline void axpy4(int n, double a0, double a1, double a2, double a3, const double *__restrict w,
+                  double *__restrict y0, double *__restrict y1, double *__restrict y2, double *__restrict y3) {
+  for (int o = 0; o < n; o++) {
+    const double wo = w[o];
+    y0[o] += a0 * wo;
+    y1[o] += a1 * wo;
+    y2[o] += a2 * wo;
+    y3[o] += a3 * wo;
+  }
+}
+
+inline void axpy(int n, double a, const double *__restrict w, double *__restrict y) {
+  for (int o = 0; o < n; o++) y[o] += a * w[o];
+}
+
+}
+
+/// four samples share every weight row, so the weights are streamed from cache once per four samples
+void dense(const double *in, const double *weight, const double *bias, double *out,
+           int nIn, int nOut, int nBatch, Activation activation) {
+  int b = 0;
+  for (; b + 4 <= nBatch; b += 4) {
+    const double *x = in + long(b) * nIn;
+    double *y = out + long(b) * nOut;
+    for (int s = 0; s < 4; s++)
+      std::memcpy(y + s * nOut, bias, sizeof(double) * nOut);
+    for (int i = 0; i < nIn; i++)
+      axpy4(nOut, x[i], x[nIn + i], x[2 * nIn + i], x[3 * nIn + i], weight + long(i) * nOut,
+            y, y + nOut, y + 2 * nOut, y + 3 * nOut);
+    activate(y, 4 * nOut, activation);
+  }
+
+  for (; b < nBatch; b++) {
+    const double *x = in + long(b) * nIn;
+    double *y = out + long(b) * nOut;
+    std::memcpy(y, bias, sizeof(double) * nOut);
+    for (int i = 0; i < nIn; i++)
+      axpy(nOut, x[i], weight + long(i) * nOut, y);
+    activate(y, nOut, activation);
+  }
+}
+
+/// pair j comes from stream words 2 (counter + j) and 2 (counter + j) + 1. Its two samples go to
+/// out[j] and out[n / 2 + j], so both halves are written with contiguous stores
+void gaussian(uint64_t key, uint64_t counter, double *out, int n) {
+  const int half = n / 2;
+  double *__restrict first = out;
+  double *__restrict second = out + half;
+  for (int j = 0; j < half; j++) {
+    const uint64_t k = 2 * (counter + uint64_t(j));
+    boxMuller(splitmix64(key, k), splitmix64(key, k + 1), first[j], second[j]);
+  }
+  if (n & 1) {
+    const uint64_t k = 2 * (counter + uint64_t(half));
+    double unused;
+    boxMuller(splitmix64(key, k), splitmix64(key, k + 1), out[n - 1], unused);
+  }
+}
+
+}
+}
+}
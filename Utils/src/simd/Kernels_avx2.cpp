@@ -0,0 +1,14 @@
+//
+// avx2 variant of the kernels. The headers are included before the target
+// pragma so that only the kernels themselves are built for avx2.
+//
+
+#include <cstdint>
+#include <cstring>
+#include "simd/Kernels.hpp"
+
+#if defined(__x86_64__)
+#pragma GCC target("avx2,fma")
+#define RAI_SIMD_VARIANT avx2
+#include "KernelsImpl.inl"
+#endif
@@ -0,0 +1,19 @@
+//
+// avx512 variant of the kernels. The headers are included before the target
+// pragma so that only the kernels themselves are built for avx512.
+//
+
+#include <cstdint>
+#include <cstring>
+#include "simd/Kernels.hpp"
+
+#if defined(__x86_64__)
+/// prefer-vector-width needs GCC 8, older compilers keep their default width
+#if __GNUC__ >= 8
+#pragma GCC target("avx512f,avx512dq,avx512vl,fma,prefer-vector-width=512")
+#else
+#pragma GCC target("avx512f,avx512dq,avx512vl,fma")
+#endif
+#define RAI_SIMD_VARIANT avx512
+#include "KernelsImpl.inl"
+#endif
@@ -0,0 +1,6 @@
+//
+// generic variant of the kernels, built for the baseline instruction set
+//
+
+#define RAI_SIMD_VARIANT generic
+#include "KernelsImpl.inl"
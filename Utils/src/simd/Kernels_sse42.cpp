@@ -0,0 +1,14 @@
+//
+// sse42 variant of the kernels. The headers are included before the target
+// pragma so that only the kernels themselves are built for sse42.
+//
+
+#include <cstdint>
+#include <cstring>
+#include "simd/Kernels.hpp"
+
+#if defined(__x86_64__)
+#pragma GCC target("sse4.2")
+#define RAI_SIMD_VARIANT sse42
+#include "KernelsImpl.inl"
+#endif
@@ -31,6 +31,7 @@
 
 
 #include <Eigen/StdVector>
+#include "trace/Trace.hpp"
 
 namespace rai {
 namespace Algorithm {
@@ -115,14 +116,19 @@ class Algo {
                             vis_lv_,
                             std::to_string(iterNumber_));
     LOG(INFO) << "Simulation";
-    ld_.acquireVineTrajForNTimeSteps(task_,
-                                     noiseBasePtr_,
-                                     policy_,
-                                     numOfSteps,
-                                     numOfJunct_,
-                                     numOfBranchPerJunct_,
-                                     vfunction_,
-                                     vis_lv_);
+    Utils::timer->startTimer("Simulation");
+    {
+      RAI_TRACE_SCOPE("acquisition");
+      ld_.acquireVineTrajForNTimeSteps(task_,
+                                       noiseBasePtr_,
+                                       policy_,
+                                       numOfSteps,
+                                       numOfJunct_,
+                                       numOfBranchPerJunct_,
+                                       vfunction_,
+                                       vis_lv_);
+    }
+    Utils::timer->stopTimer("Simulation");
     LOG(INFO) << "Vfunction update";
     VFupdate();
     LOG(INFO) << "Policy update";
@@ -136,6 +142,7 @@ class Algo {
  private:
 
   void VFupdate() {
+    RAI_TRACE_SCOPE("VFupdate");
     ValueBatch valuePrev(ld_.stateBat.cols());
     Dtype loss;
     vfunction_->forward(ld_.stateBat, valuePrev);
@@ -149,6 +156,7 @@ class Algo {
   }
 
   void TRPOUpdater() {
+    RAI_TRACE_SCOPE("TRPOUpdater");
     Utils::timer->startTimer("policy Training");
     /// Update Advantage
     ld_.computeAdvantage(task_[0],vfunction_,lambda_);
@@ -201,6 +209,7 @@ class Algo {
   }
 
   inline VectorXD line_search(VectorXD &initialUpdate, Dtype &expected_improve) {
+    RAI_TRACE_SCOPE("line_search");
 
     int max_shrinks = 20;
     Dtype shrink_multiplier = 0.7;
@@ -8,6 +8,7 @@
 #include <rai/noiseModel/NormalDistributionNoise.hpp>
 #include "rai/function/common/StochasticPolicy.hpp"
 #include "rai/function/tensorflow/common/ParameterizedFunction_TensorFlow.hpp"
+#include "trace/Trace.hpp"
 
 template<typename Dtype, int stateDim, int actionDim>
 class customPolicy : public virtual rai::FuncApprox::StochasticPolicy<Dtype, stateDim, actionDim>,
@@ -111,6 +112,7 @@ class customPolicy : public virtual rai::FuncApprox::StochasticPolicy<Dtype, sta
   }
 
   virtual void forward(State &state, Action &action) {
+    RAI_TRACE_SCOPE("policy inference");
     std::vector<MatrixXD> vectorOfOutputs;
     this->tf_->forward({{"state", state}},
                        {"action"}, vectorOfOutputs);
@@ -118,6 +120,7 @@ class customPolicy : public virtual rai::FuncApprox::StochasticPolicy<Dtype, sta
     action = vectorOfOutputs[0];
   }
   virtual void forward(StateBatch &state, ActionBatch &action) {
+    RAI_TRACE_SCOPE("policy inference");
     std::vector<MatrixXD> vectorOfOutputs;
     this->tf_->forward({{"state", state}},
                        {"action"}, vectorOfOutputs);
@@ -125,6 +128,7 @@ class customPolicy : public virtual rai::FuncApprox::StochasticPolicy<Dtype, sta
   }
 
   virtual void forward(Tensor3D &states, Tensor3D &actions) {
+    RAI_TRACE_SCOPE("policy inference");
     std::vector<tensorflow::Tensor> vectorOfOutputs;
     this->tf_->forward({states}, {"action"}, vectorOfOutputs);
     actions.copyDataFrom(vectorOfOutputs[0]);
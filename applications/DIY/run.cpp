@@ -22,6 +22,12 @@
 #include <rai/experienceAcquisitor/TrajectoryAcquisitor_MultiThreadBatch.hpp>
 #include <rai/experienceAcquisitor/TrajectoryAcquisitor_SingleThreadBatch.hpp>
 
+// training metrics
+#include "metrics/Metrics.hpp"
+
+// tracing
+#include "trace/Trace.hpp"
+
 using namespace std;
 using namespace boost;
 
@@ -108,9 +114,12 @@ int main(int argc, char *argv[]) {
   algorithm.setVisualizationLevel(0);
 
   /////////////////////// Plotting properties ////////////////////////
-  rai::Utils::Graph::FigProp2D
-      figurePropertiesEVP("N. Steps Taken", "Performance", "Number of Steps Taken vs Performance");
   rai::Utils::Graph::FigPropPieChart propChart;
+
+  /////////////////////// Metrics //////////////////////////////////////
+  /// written by a background thread, plot them with tools/plot_metrics.py
+  rai::Metrics::Exporter metrics(RAI_LOG_PATH, "DIY");
+
   constexpr int loggingInterval = 50;
 
   ////////////////////////// Learning /////////////////////////////////
@@ -122,23 +131,20 @@ int main(int argc, char *argv[]) {
     }
     LOG(INFO) << iterationNumber << "th Iteration";
     algorithm.runOneLoop(5000);
+    metrics.set("performance", rai::Metrics::lastLogged("PerformanceTester/performance"));
+    metrics.setSteps(acquisitor.stepsTaken());
+    metrics.commit(iterationNumber);
 
     if (iterationNumber % loggingInterval == 0) {
       algorithm.setVisualizationLevel(0);
       taskVector[0]->disableRecording();
-      graph->figure(1, figurePropertiesEVP);
-      graph->appendData(1, logger->getData("PerformanceTester/performance", 0),
-                        logger->getData("PerformanceTester/performance", 1),
-                        logger->getDataSize("PerformanceTester/performance"),
-                        rai::Utils::Graph::PlotMethods2D::linespoints,
-                        "performance",
-                        "lw 2 lc 4 pi 1 pt 5 ps 1");
-      graph->drawFigure(1);
-
     }
   }
 
   policy.dumpParam(RAI_LOG_PATH + "/policy.txt");
+#ifdef RAI_TRACE
+  rai::Trace::writeChromeTrace(RAI_LOG_PATH + "/trace.json");
+#endif
   graph->drawPieChartWith_RAI_Timer(5, timer->getTimedItems(), propChart);
   graph->drawFigure(5, rai::Utils::Graph::OutputFormat::pdf);
   graph->waitForEnter();
@@ -0,0 +1,99 @@
+//
+// Learner side of the distributed rollout. Broadcasts the policy to the
+// connected workers every iteration and gathers their experience.
+// usage: <task>_rollout_learner [nWorkers=2] [port=5555] [host=127.0.0.1]
+//
+
+#include "rai/RAI_core"
+
+// Eigen
+#include <Eigen/Dense>
+
+// task
+#if defined(ROLLOUT_POLICY_RECURRENT)
+#include "rai/tasks/quadrotor/QuadrotorControl_PO.hpp"
+#elif defined(ROLLOUT_TASK_QUADROTOR)
+#include "quadrotor/QuadrotorControl.hpp"
+#else
+#include "slungload/slungloadControl.hpp"
+#endif
+
+// Neural network
+#ifdef ROLLOUT_POLICY_RECURRENT
+#include "rai/function/tensorflow/RecurrentStochasticPolicyValue_TensorFlow.hpp"
+#else
+#include "rai/function/tensorflow/StochasticPolicy_TensorFlow.hpp"
+#endif
+
+// distributed rollout
+#include "distributed/RolloutServer.hpp"
+
+using namespace std;
+
+/// learning states
+using Dtype = double;
+
+/// shortcuts
+#if defined(ROLLOUT_POLICY_RECURRENT)
+constexpr int StateDim = rai::Task::StateDim;
+constexpr int ActionDim = rai::Task::ActionDim;
+#else
+#ifdef ROLLOUT_TASK_QUADROTOR
+using TaskTraits = rai::Task::TaskTraits<rai::Task::QuadrotorControl>;
+#else
+using TaskTraits = rai::Task::TaskTraits<rai::Task::slungloadControl>;
+#endif
+constexpr int StateDim = TaskTraits::StateDim;
+constexpr int ActionDim = TaskTraits::ActionDim;
+#endif
+#ifdef ROLLOUT_POLICY_RECURRENT
+using Policy_TensorFlow = rai::FuncApprox::RecurrentStochasticPolicyValue_Tensorflow<Dtype, StateDim, ActionDim>;
+#else
+using Policy_TensorFlow = rai::FuncApprox::StochasticPolicy_TensorFlow<Dtype, StateDim, ActionDim>;
+#endif
+using Server = rai::Distributed::RolloutServer<Dtype, StateDim, ActionDim>;
+
+int main(int argc, char *argv[]) {
+
+  int nWorkers = argc > 1 ? std::atoi(argv[1]) : 2;
+  int port = argc > 2 ? std::atoi(argv[2]) : 5555;
+  std::string host = argc > 3 ? argv[3] : "127.0.0.1";
+
+  RAI_init();
+
+  ////////////////////////// Define Function approximations //////////
+#ifdef ROLLOUT_POLICY_RECURRENT
+  Policy_TensorFlow policy("gpu,0", "LSTM_merged", "relu 1e-3 " + std::to_string(StateDim) + " 128 / 128 64 4", 1e-4);
+#else
+  Policy_TensorFlow policy("gpu,0", "MLP", "tanh 3e-3 " + std::to_string(StateDim) + " 128 128 4", 1e-3);
+#endif
+  Server::Parameter parameter(policy.getLPSize());
+
+  ////////////////////////// Workers //////////////////////////////
+  Server server(host, port, nWorkers, int(parameter.size()));
+  LOG(INFO) << server.nWorkers() << " workers with " << server.totalEnvs() << " envs in total";
+
+  constexpr uint32_t stepsPerEnv = 500, chunkSteps = 50;
+  std::vector<Server::Chunk> chunks;
+
+  ////////////////////////// Learning /////////////////////////////////
+  for (uint32_t iterationNumber = 0; iterationNumber < 101; iterationNumber++) {
+    policy.getLP(parameter);
+    server.broadcastParameters(iterationNumber, parameter);
+
+    rai::Utils::timer->startTimer("distributed acquisition");
+    server.collect(stepsPerEnv, chunkSteps, chunks);
+    rai::Utils::timer->stopTimer("distributed acquisition");
+
+    long nSamples = 0, nTerminal = 0;
+    Dtype costSum = 0;
+    for (auto &chunk : chunks) {
+      nSamples += chunk.size();
+      nTerminal += chunk.terminalStates.cols();
+      costSum += chunk.costs.sum();
+    }
+    LOG(INFO) << iterationNumber << "th loop: " << nSamples << " samples in " << chunks.size() << " chunks, "
+              << nTerminal << " episode ends, average cost " << costSum / std::max(nSamples, 1l)
+              << ", stale chunks " << server.staleChunks();
+  }
+}
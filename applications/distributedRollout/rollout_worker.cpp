@@ -0,0 +1,133 @@
+//
+// Rollout worker. Connects to a rollout_learner and simulates on its behalf.
+// usage: <task>_rollout_worker [host=127.0.0.1] [port=5555] [workerId=0] [nEnvs=10] [nProcesses=0]
+// with nProcesses > 0 the envs are simulated in that many forked processes
+// instead of OpenMP threads, which keeps physics away from TensorFlow's heap and thread pools.
+// The slungload_rppo worker rolls out the recurrent LSTM_merged policy of slungload_RPPO on its
+// task, the partially observed QuadrotorControl_PO, so the parameters of either can be loaded by the other.
+//
+
+#include "rai/RAI_core"
+
+// Eigen
+#include <Eigen/Dense>
+
+// task
+#if defined(ROLLOUT_POLICY_RECURRENT)
+#include "rai/tasks/quadrotor/QuadrotorControl_PO.hpp"
+#elif defined(ROLLOUT_TASK_QUADROTOR)
+#include "quadrotor/QuadrotorControl.hpp"
+#else
+#include "slungload/slungloadControl.hpp"
+#endif
+
+// Neural network
+#ifdef ROLLOUT_POLICY_RECURRENT
+#include "rai/function/tensorflow/RecurrentStochasticPolicyValue_TensorFlow.hpp"
+#else
+#include "rai/function/tensorflow/StochasticPolicy_TensorFlow.hpp"
+#endif
+
+// distributed rollout
+#include "distributed/RolloutWorker.hpp"
+
+using namespace std;
+
+/// learning states
+using Dtype = double;
+
+/// shortcuts
+#if defined(ROLLOUT_POLICY_RECURRENT)
+using Task = rai::Task::QuadrotorControl_PO<Dtype>;
+constexpr int StateDim = rai::Task::StateDim;
+constexpr int ActionDim = rai::Task::ActionDim;
+#else
+#ifdef ROLLOUT_TASK_QUADROTOR
+using TaskTraits = rai::Task::TaskTraits<rai::Task::QuadrotorControl>;
+using Task = rai::Task::QuadrotorControl<Dtype>;
+#else
+using TaskTraits = rai::Task::TaskTraits<rai::Task::slungloadControl>;
+using Task = rai::Task::slungloadControl<Dtype>;
+#endif
+constexpr int StateDim = TaskTraits::StateDim;
+constexpr int ActionDim = TaskTraits::ActionDim;
+#endif
+using Action = Eigen::Matrix<Dtype, ActionDim, 1>;
+#ifdef ROLLOUT_POLICY_RECURRENT
+using Policy_TensorFlow = rai::FuncApprox::RecurrentStochasticPolicyValue_Tensorflow<Dtype, StateDim, ActionDim>;
+#else
+using Policy_TensorFlow = rai::FuncApprox::StochasticPolicy_TensorFlow<Dtype, StateDim, ActionDim>;
+#endif
+using Worker = rai::Distributed::RolloutWorker<Dtype, StateDim, ActionDim>;
+using EnvPool = rai::SharedMemory::ProcessEnvPool<Dtype, StateDim, ActionDim>;
+
+int main(int argc, char *argv[]) {
+
+  std::string host = argc > 1 ? argv[1] : "127.0.0.1";
+  int port = argc > 2 ? std::atoi(argv[2]) : 5555;
+  int workerId = argc > 3 ? std::atoi(argv[3]) : 0;
+  int nEnvs = argc > 4 ? std::atoi(argv[4]) : 10;
+  int nProcesses = argc > 5 ? std::atoi(argv[5]) : 0;
+  LOG_IF(FATAL, nProcesses > 0 && nEnvs % nProcesses != 0) << "nEnvs must be a multiple of nProcesses";
+
+  RAI_init();
+  omp_set_num_threads(nProcesses > 0 ? 1 : nEnvs);
+
+  ////////////////////////// Define task ////////////////////////////
+  constexpr double dt = 0.01;
+  auto configure = [dt](Task &task) {
+    task.setControlUpdate_dt(dt);
+    task.setDiscountFactor(0.99);
+#ifdef ROLLOUT_POLICY_RECURRENT
+    /// as in slungload_RPPO
+    task.setTimeLimitPerEpisode(8.0);
+#else
+    task.setTimeLimitPerEpisode(5.0);
+    task.setValueAtTerminalState(1.5);
+#endif
+  };
+
+  std::vector<Task> taskVec(nProcesses > 0 ? 0 : nEnvs, Task());
+  std::vector<rai::Task::Task<Dtype, StateDim, ActionDim, 0> *> taskVector;
+
+  for (auto &task : taskVec) {
+    configure(task);
+    taskVector.push_back(&task);
+  }
+
+  /// fork before TensorFlow creates its threads
+  std::unique_ptr<EnvPool> envPool;
+  if (nProcesses > 0)
+    envPool.reset(new EnvPool(nProcesses, nEnvs / nProcesses, [&configure]() {
+      Task *task = new Task();
+      configure(*task);
+      return task;
+    }, dt));
+
+  ////////////////////////// Define Function approximations //////////
+  /// must match the learner's policy
+#ifdef ROLLOUT_POLICY_RECURRENT
+  Policy_TensorFlow policy("cpu", "LSTM_merged", "relu 1e-3 " + std::to_string(StateDim) + " 128 / 128 64 4", 1e-4);
+#else
+  Policy_TensorFlow policy("cpu", "MLP", "tanh 3e-3 " + std::to_string(StateDim) + " 128 128 4", 1e-3);
+#endif
+
+  ////////////////////////// Define Noise Model //////////////////////
+  /// shared by all envs, follows the policy stdev once the first parameters arrive
+  Action noiseStdev = Action::Ones();
+
+  ////////////////////////// Serve /////////////////////////////////
+  std::unique_ptr<Worker> worker;
+  if (envPool)
+    worker.reset(new Worker(envPool.get(), &policy, noiseStdev));
+  else
+    worker.reset(new Worker(taskVector, &policy, noiseStdev, dt));
+  /// the action means only need the network, evaluate it without a TensorFlow session call
+#ifdef ROLLOUT_POLICY_RECURRENT
+  worker->useRecurrentCpuInference(&policy, 128, {128, 64, ActionDim}, rai::Simd::Activation::relu);
+#else
+  worker->useCpuInference({StateDim, 128, 128, ActionDim}, rai::Simd::Activation::tanh);
+#endif
+  worker->serve(host, port, workerId);
+  LOG(INFO) << "worker " << workerId << " finished";
+}
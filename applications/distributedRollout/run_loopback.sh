@@ -0,0 +1,16 @@
+#!/usr/bin/env bash
+# Starts a learner and N rollout workers on the loopback interface.
+# usage: ./run_loopback.sh <build dir> [task=slungload|quadrotor|slungload_rppo] [nWorkers=2] [nEnvsPerWorker=4] [port=5555]
+
+BUILD_DIR=$1
+TASK=${2:-slungload}
+N_WORKERS=${3:-2}
+N_ENVS=${4:-4}
+PORT=${5:-5555}
+
+for ((i = 0; i < N_WORKERS; i++)); do
+  "$BUILD_DIR/${TASK}_rollout_worker" 127.0.0.1 "$PORT" "$i" "$N_ENVS" &
+done
+
+"$BUILD_DIR/${TASK}_rollout_learner" "$N_WORKERS" "$PORT" 127.0.0.1
+wait
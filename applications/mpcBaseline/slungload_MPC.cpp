@@ -0,0 +1,94 @@
+//
+// Sampling MPC on slungloadControl, a model-based baseline for the learned
+// policies and a source of expert data. Every control step plans from a
+// snapshot of the controlled task and writes the state and the chosen
+// action to RAI_LOG_PATH/mpc_expert.txt, one line per step.
+// usage: slungload_MPC [method=mppi|cem] [budgetMs=10] [nThreads=8] [episodes=5]
+//
+
+#include "rai/RAI_core"
+
+// Eigen
+#include <Eigen/Dense>
+
+#include <fstream>
+
+// task
+#include "slungload/slungloadControl.hpp"
+#include "common/SamplingMpc.hpp"
+
+using namespace std;
+
+/// learning states
+using Dtype = double;
+
+/// shortcuts
+using Task = rai::Task::slungloadControl<Dtype>;
+using State = Task::State;
+using Action = Task::Action;
+using Mpc = rai::Task::SamplingMpc<Task>;
+
+int main(int argc, char *argv[]) {
+
+  std::string method = argc > 1 ? argv[1] : "mppi";
+  double budgetMs = argc > 2 ? std::atof(argv[2]) : 10.0;
+  int nThreads = argc > 3 ? std::atoi(argv[3]) : 8;
+  int episodes = argc > 4 ? std::atoi(argv[4]) : 5;
+  LOG_IF(FATAL, method != "mppi" && method != "cem") << "unknown method " << method;
+
+  RAI_init();
+
+  ////////////////////////// Define task ////////////////////////////
+  constexpr double dt = 0.01;
+  auto configure = [dt](Task &task) {
+    task.setControlUpdate_dt(dt);
+    task.setDiscountFactor(0.99);
+    task.setTimeLimitPerEpisode(5.0);
+    task.setValueAtTerminalState(1.5);
+  };
+
+  Task task;
+  configure(task);
+  std::vector<Task> workerTasks(nThreads);
+  std::vector<Task *> workers;
+  for (auto &worker : workerTasks) {
+    configure(worker);
+    workers.push_back(&worker);
+  }
+
+  ////////////////////////// Define MPC ////////////////////////////
+  rai::Task::MpcParameters parameters;
+  parameters.method = method == "cem" ? rai::Task::MpcMethod::cem : rai::Task::MpcMethod::mppi;
+  parameters.timeBudget = budgetMs * 1e-3;
+  Mpc mpc(workers, parameters);
+
+  std::ofstream expert(RAI_LOG_PATH + "/mpc_expert.txt");
+  const int stepsPerEpisode = int(task.timeLimit() / dt + 0.5);
+
+  ////////////////////////// Control /////////////////////////////////
+  for (int episode = 0; episode < episodes; episode++) {
+    State state;
+    Action action;
+    Task::Snapshot snapshot;
+    rai::TerminationType termType = rai::TerminationType::not_terminated;
+    Dtype cost, costSum = 0;
+    int steps = 0;
+
+    task.getInitialState(state);
+    mpc.reset();
+    mpc.clearStatistics();
+    for (; steps < stepsPerEpisode && termType == rai::TerminationType::not_terminated; steps++) {
+      task.saveState(snapshot);
+      mpc.act(snapshot, action);
+      expert << state.transpose() << " " << action.transpose() << "\n";
+      task.step(action, state, termType, cost);
+      costSum += cost;
+    }
+
+    const Mpc::Statistics &statistics = mpc.statistics();
+    LOG(INFO) << episode << "th episode: " << steps << " steps, average cost " << costSum / steps
+              << ", control rate " << statistics.controlRate() << " Hz (" << 1.0 / dt << " Hz needed), "
+              << double(statistics.iterations) / statistics.controlSteps << " iterations per step, "
+              << statistics.rolloutsPerSecond() << " rollouts/s";
+  }
+}
@@ -19,6 +19,9 @@
 // acquisitor
 #include "rai/experienceAcquisitor/TrajectoryAcquisitor_Parallel.hpp"
 
+// training metrics
+#include "metrics/Metrics.hpp"
+
 using namespace std;
 using namespace boost;
 
@@ -26,9 +29,10 @@ using namespace boost;
 using Dtype = double;
 
 /// shortcuts
-using rai::Task::ActionDim;
-using rai::Task::StateDim;
-using rai::Task::CommandDim;
+using TaskTraits = rai::Task::TaskTraits<rai::Task::QuadrotorControl>;
+constexpr int StateDim = TaskTraits::StateDim;
+constexpr int ActionDim = TaskTraits::ActionDim;
+constexpr int CommandDim = TaskTraits::CommandDim;
 using Task = rai::Task::QuadrotorControl<Dtype>;
 using Noise = rai::Noise::NormalDistributionNoise<Dtype, ActionDim>;
 using NoiseCovariance = Eigen::Matrix<Dtype, ActionDim, ActionDim>;
@@ -77,12 +81,13 @@ int main(int argc, char *argv[]) {
   algorithm.setVisualizationLevel(0);
 
   /////////////////////// Plotting properties ////////////////////////
-  rai::Utils::Graph::FigProp2D
-      figurePropertiesEVP("N. Steps Taken", "Performance", "Number of Episodes vs Performance");
-
   rai::Utils::Graph::FigPropPieChart propChart;
   rai::Utils::logger->addVariableToLog(1, "process time", "");
 
+  /////////////////////// Metrics //////////////////////////////////////
+  /// written by a background thread, plot them with tools/plot_metrics.py
+  rai::Metrics::Exporter metrics(RAI_LOG_PATH, "quadrotor_PPO");
+
   constexpr int loggingInterval = 50;
 
   ////////////////////////// Learning /////////////////////////////////
@@ -94,20 +99,14 @@ int main(int argc, char *argv[]) {
       taskVector[0]->enableVideoRecording();
     }
     algorithm.runOneLoop(2000);
+    metrics.set("performance", rai::Metrics::lastLogged("PerformanceTester/performance"));
+    metrics.setSteps(acquisitor.stepsTaken());
+    metrics.commit(iterationNumber);
 
     if (iterationNumber % loggingInterval == 0) {
       algorithm.setVisualizationLevel(0);
       taskVector[0]->disableRecording();
 
-      graph->figure(1, figurePropertiesEVP);
-      graph->appendData(1, logger->getData("PerformanceTester/performance", 0),
-                        logger->getData("PerformanceTester/performance", 1),
-                        logger->getDataSize("PerformanceTester/performance"),
-                        rai::Utils::Graph::PlotMethods2D::linespoints,
-                        "performance",
-                        "lw 2 lc 4 pi 1 pt 5 ps 1");
-      graph->drawFigure(1, rai::Utils::Graph::OutputFormat::pdf);
-
       if (iterationNumber % 200 == 49) {
         policy.dumpParam(RAI_LOG_PATH + "/policy_" + std::to_string(iterationNumber) + ".txt");
         vfunction.dumpParam(RAI_LOG_PATH + "/value_" + std::to_string(iterationNumber) + ".txt");
@@ -3,8 +3,15 @@
 // Eigen
 #include <Eigen/Dense>
 
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+
 // task
 #include "slungload/slungloadControl.hpp"
+#include "slungload/visualizer/slungload_GridVisualizer.hpp"
+#include "render/Headless.hpp"
 
 // noise model
 #include "rai/noiseModel/NormalDistributionNoise.hpp"
@@ -19,6 +26,15 @@
 // acquisitor
 #include "rai/experienceAcquisitor/TrajectoryAcquisitor_Parallel.hpp"
 
+// training metrics
+#include "metrics/Metrics.hpp"
+
+// thread and memory placement
+#include "numa/NodeLocalObjects.hpp"
+
+// tracing
+#include "trace/Trace.hpp"
+
 using namespace std;
 using namespace boost;
 
@@ -26,9 +42,10 @@ using namespace boost;
 using Dtype = double;
 
 /// shortcuts
-using rai::Task::ActionDim;
-using rai::Task::StateDim;
-using rai::Task::CommandDim;
+using TaskTraits = rai::Task::TaskTraits<rai::Task::slungloadControl>;
+constexpr int StateDim = TaskTraits::StateDim;
+constexpr int ActionDim = TaskTraits::ActionDim;
+constexpr int CommandDim = TaskTraits::CommandDim;
 using Task = rai::Task::slungloadControl<Dtype>;
 using Noise = rai::Noise::NormalDistributionNoise<Dtype, ActionDim>;
 using NoiseCovariance = Eigen::Matrix<Dtype, ActionDim, ActionDim>;
@@ -38,23 +55,102 @@ using Acquisitor = rai::ExpAcq::TrajectoryAcquisitor_Parallel<Dtype, StateDim, A
 
 #define nThread 10
 
+/// the policy on 64 fresh envs side by side in one window, recorded to RAI_LOG_PATH/grid.
+/// An env that reaches a terminal state stops where it failed and shows a red load.
+/// Opt-in with --grid, the envs and the window are built once and reused by every recording
+class GridRecorder {
+
+ public:
+  static constexpr int nEnvs = 64, nSteps = 500;
+  static constexpr double dt = 0.01;
+
+  GridRecorder() : envs_(nEnvs), grid_(nEnvs), q_(10, nEnvs) {
+    auto resetPool = rai::Task::slungloadResetPool();
+    for (auto &env : envs_) {
+      env.setControlUpdate_dt(dt);
+      env.setResetPool(resetPool);
+    }
+  }
+
+  /// paced to real time, about 5 s. The recorded frames are the ones the window's render thread draws,
+  /// an unpaced rollout would be over after a handful of them
+  void record(Policy_TensorFlow &policy, int iterationNumber) {
+    Task::StateBatch states(StateDim, nEnvs);
+    Task::ActionBatch actions(ActionDim, nEnvs);
+    std::vector<char> failed(nEnvs, 0);
+    for (int i = 0; i < nEnvs; i++) {
+      Task::State state;
+      envs_[i].getInitialState(state);
+      states.col(i) = state;
+    }
+
+    Task::Snapshot snapshot;
+    const std::string dir = RAI_LOG_PATH + "/grid";
+    mkdir(dir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    grid_.getGraphics()->savingSnapshots(dir, "grid_" + std::to_string(iterationNumber));
+
+    auto frame = std::chrono::steady_clock::now();
+    for (int t = 0; t < nSteps; t++) {
+      policy.forward(states, actions);
+#pragma omp parallel for schedule(static)
+      for (int i = 0; i < nEnvs; i++) {
+        if (failed[i]) continue;
+        Task::State next;
+        Dtype cost;
+        rai::TerminationType termType = rai::TerminationType::not_terminated;
+        envs_[i].step(actions.col(i), next, termType, cost);
+        states.col(i) = next;
+        failed[i] = termType == rai::TerminationType::terminalState;
+      }
+      for (int i = 0; i < nEnvs; i++) {
+        envs_[i].saveState(snapshot);
+        q_.col(i) = snapshot.coordinate();
+        grid_.setFailed(i, failed[i]);
+      }
+      grid_.drawWorld(q_);
+      frame += std::chrono::microseconds(long(dt * 1e6));
+      std::this_thread::sleep_until(frame);
+    }
+    grid_.getGraphics()->images2Video();
+  }
+
+ private:
+  std::vector<Task> envs_;
+  rai::Vis::slungload_GridVisualizer grid_;
+  rai::Vis::slungload_GridVisualizer::Coordinates q_;
+};
+
 int main(int argc, char *argv[]) {
 
   RAI_init();
   omp_set_num_threads(nThread);
 
-  ////////////////////////// Define task ////////////////////////////
-  Task task;
+  /// usage: slungload_PPO [--grid]
+  bool recordGrid = false;
+  for (int i = 1; i < argc; i++)
+    recordGrid |= std::strcmp(argv[i], "--grid") == 0;
+  LOG_IF(WARNING, recordGrid && rai::Render::headlessByDefault())
+  << "--grid needs a display, not recording the grid";
+  std::unique_ptr<GridRecorder> grid;
+  if (recordGrid && !rai::Render::headlessByDefault()) grid.reset(new GridRecorder);
 
-  std::vector<Task> taskVec(nThread, Task());
+  ////////////////////////// Define task ////////////////////////////
+  /// every env is built by the pinned thread that simulates it, so it lives on that thread's numa node
+  rai::Numa::WorkerPlacement placement(nThread);
+  rai::Numa::NodeLocalObjects<Task> taskVec(placement);
   std::vector<rai::Task::Task<Dtype, StateDim, ActionDim, 0> *> taskVector;
-
-  for (auto &task : taskVec) {
-    task.setControlUpdate_dt(0.01);
-    task.setDiscountFactor(0.99);
-    task.setTimeLimitPerEpisode(5.0);
-    task.setValueAtTerminalState(1.5);
-    taskVector.push_back(&task);
+  std::vector<rai::Metrics::EpisodeStatistics *> episodeStatistics;
+  /// one filler thread for the whole process, seeded from RAI's generator
+  auto resetPool = rai::Task::slungloadResetPool();
+
+  for (auto task : taskVec) {
+    task->setResetPool(resetPool);
+    task->setControlUpdate_dt(0.01);
+    task->setDiscountFactor(0.99);
+    task->setTimeLimitPerEpisode(5.0);
+    task->setValueAtTerminalState(1.5);
+    episodeStatistics.push_back(&task->episodeStatistics());
+    taskVector.push_back(task);
   }
 
   ////////////////////////// Define Function approximations //////////
@@ -79,12 +175,14 @@ int main(int argc, char *argv[]) {
   algorithm.setVisualizationLevel(0);
 
   /////////////////////// Plotting properties ////////////////////////
-  rai::Utils::Graph::FigProp2D
-      figurePropertiesEVP("N. Steps Taken", "Performance", "Number of Episodes vs Performance");
-
   rai::Utils::Graph::FigPropPieChart propChart;
   rai::Utils::logger->addVariableToLog(1, "process time", "");
 
+  /////////////////////// Metrics //////////////////////////////////////
+  /// written by a background thread, plot them with tools/plot_metrics.py
+  rai::Metrics::Exporter metrics(RAI_LOG_PATH, "slungload_PPO");
+  rai::Metrics::EpisodeHistograms episodes;
+
   constexpr int loggingInterval = 100;
 
   ////////////////////////// Learning /////////////////////////////////
@@ -96,20 +194,19 @@ int main(int argc, char *argv[]) {
       taskVector[0]->enableVideoRecording();
     }
     algorithm.runOneLoop(5000);
+    metrics.set("performance", rai::Metrics::lastLogged("PerformanceTester/performance"));
+    metrics.setSteps(acquisitor.stepsTaken());
+    rai::Metrics::EpisodeStatistics::collect(episodeStatistics, episodes);
+    rai::Metrics::logEpisodes(episodes, &metrics);
+    metrics.commit(iterationNumber);
+    placement.checkThreads();
 
     if (iterationNumber % loggingInterval == 0) {
+      LOG(INFO) << placement.report();
+      if (grid) grid->record(policy, iterationNumber);
       algorithm.setVisualizationLevel(0);
       taskVector[0]->disableRecording();
 
-      graph->figure(1, figurePropertiesEVP);
-      graph->appendData(1, logger->getData("PerformanceTester/performance", 0),
-                        logger->getData("PerformanceTester/performance", 1),
-                        logger->getDataSize("PerformanceTester/performance"),
-                        rai::Utils::Graph::PlotMethods2D::linespoints,
-                        "performance",
-                        "lw 2 lc 4 pi 1 pt 5 ps 1");
-      graph->drawFigure(1, rai::Utils::Graph::OutputFormat::pdf);
-
       if (iterationNumber % 200 == 49) {
         policy.dumpParam(RAI_LOG_PATH + "/policy_" + std::to_string(iterationNumber) + ".txt");
         vfunction.dumpParam(RAI_LOG_PATH + "/value_" + std::to_string(iterationNumber) + ".txt");
@@ -118,6 +215,9 @@ int main(int argc, char *argv[]) {
 
   }
 
+#ifdef RAI_TRACE
+  rai::Trace::writeChromeTrace(RAI_LOG_PATH + "/trace.json");
+#endif
   graph->drawPieChartWith_RAI_Timer(3, timer->getTimedItems(), propChart);
   graph->drawFigure(3, rai::Utils::Graph::OutputFormat::pdf);
 }
\ No newline at end of file
@@ -18,6 +18,9 @@
 // acquisitor
 #include "rai/experienceAcquisitor/TrajectoryAcquisitor_Parallel.hpp"
 
+// training metrics
+#include "metrics/Metrics.hpp"
+
 using namespace std;
 using namespace boost;
 
@@ -74,22 +77,12 @@ int main(int argc, char *argv[]) {
   algorithm.setVisualizationLevel(0);
 
   /////////////////////// Plotting properties ////////////////////////
-  rai::Utils::Graph::FigProp2D figurePropertiesEVP;
-  figurePropertiesEVP.title = "Number of Steps Taken vs Performance";
-  figurePropertiesEVP.xlabel = "N. Steps Taken";
-  figurePropertiesEVP.ylabel = "Performance";
-
-  rai::Utils::Graph::FigProp2D figurePropertieskl;
-  figurePropertieskl.title = "Number of Steps Taken vs KlD";
-  figurePropertieskl.xlabel = "N. Steps Taken";
-  figurePropertieskl.ylabel = "KlD";
-
-  rai::Utils::Graph::FigProp2D figurePropertiesgnorm;
-  figurePropertiesgnorm.title = "Number of Steps Taken vs gradNorm";
-  figurePropertiesgnorm.xlabel = "N. Steps Taken";
-  figurePropertiesgnorm.ylabel = "gradNorm";
   rai::Utils::Graph::FigPropPieChart propChart;
 
+  /////////////////////// Metrics //////////////////////////////////////
+  /// written by a background thread, plot them with tools/plot_metrics.py
+  rai::Metrics::Exporter metrics(RAI_LOG_PATH, "slungload_RPPO");
+
   ////////////////////////// Learning /////////////////////////////////
   constexpr int loggingInterval =50;
   int iteration = 501;
@@ -104,38 +97,17 @@ int main(int argc, char *argv[]) {
       taskVector[0]->enableVideoRecording();
     }
     algorithm.runOneLoop(5000);
+    metrics.set("performance", rai::Metrics::lastLogged("PerformanceTester/performance"));
+    metrics.set("kl_divergence", rai::Metrics::lastLogged("klD"));
+    metrics.set("grad_norm", rai::Metrics::lastLogged("gradnorm"));
+    metrics.set("learning_rate", policy.getLearningRate());
+    metrics.setSteps(acquisitor.stepsTaken());
+    metrics.commit(iterationNumber);
 
     if (iterationNumber % loggingInterval == 0) {
       algorithm.setVisualizationLevel(0);
       taskVector[0]->disableRecording();
 
-      graph->figure(1, figurePropertiesEVP);
-      graph->appendData(1, logger->getData("PerformanceTester/performance", 0),
-                        logger->getData("PerformanceTester/performance", 1),
-                        logger->getDataSize("PerformanceTester/performance"),
-                        rai::Utils::Graph::PlotMethods2D::linespoints,
-                        "performance",
-                        "lw 2 lc 4 pi 1 pt 5 ps 1");
-      graph->drawFigure(1, rai::Utils::Graph::OutputFormat::pdf);
-
-
-      graph->figure(2, figurePropertieskl);
-      graph->appendData(2, logger->getData("klD", 0),
-                        logger->getData("klD", 1),
-                        logger->getDataSize("klD"),
-                        rai::Utils::Graph::PlotMethods2D::linespoints,
-                        "klD",
-                        "lw 2 lc 4 pi 1 pt 5 ps 1");
-      graph->drawFigure(2, rai::Utils::Graph::OutputFormat::pdf);
-
-      graph->figure(3, figurePropertiesgnorm);
-      graph->appendData(3, logger->getData("gradnorm", 0),
-                        logger->getData("gradnorm", 1),
-                        logger->getDataSize("gradnorm"),
-                        rai::Utils::Graph::PlotMethods2D::linespoints,
-                        "gradnorm",
-                        "lw 2 lc 4 pi 1 pt 5 ps 1");
-      graph->drawFigure(3, rai::Utils::Graph::OutputFormat::pdf);
         policy.dumpParam(RAI_LOG_PATH + "/policy_" + std::to_string(iterationNumber) + ".txt");
     }
 
@@ -0,0 +1,256 @@
+//
+// Off-policy actor-critic (TD3): a deterministic policy, two critics whose
+// larger target is used, target policy smoothing and delayed policy updates.
+// Every transition goes into a ReplayRing and is reused by many updates, so
+// it needs far fewer simulated steps than the on-policy algorithms.
+// The tasks step in parallel and push into the ring themselves; the updates
+// sample minibatches from it without taking a lock.
+// Costs are minimized, so the pessimistic critic is the larger one.
+//
+
+#ifndef RAI_TD3_HPP
+#define RAI_TD3_HPP
+
+#include <iostream>
+#include "glog/logging.h"
+
+#include "rai/tasks/common/Task.hpp"
+#include <Eigen/Core>
+#include <rai/noiseModel/NormalDistributionNoise.hpp>
+#include <rai/noiseModel/NoNoise.hpp>
+#include "rai/RAI_core"
+
+// Neural network
+//function approximations
+#include "rai/function/common/DeterministicPolicy.hpp"
+#include "rai/function/common/Qfunction.hpp"
+
+#include <rai/algorithm/common/PerformanceTester.hpp>
+
+#include "replay/ReplayRing.hpp"
+#include "trace/Trace.hpp"
+
+namespace rai {
+namespace Algorithm {
+
+template<typename Dtype>
+struct TD3Parameters {
+  unsigned batchSize = 256;
+  Dtype tau = 5e-3;              // target networks move this far towards the trained ones per policy update
+  int policyDelay = 2;           // critic updates per policy update
+  Dtype targetNoise = 0.2;       // stdev of the smoothing noise on the target action
+  Dtype targetNoiseClip = 0.5;
+  Dtype updatesPerStep = 1.0;    // critic updates per simulated step
+  long warmupSteps = 10000;      // steps in the ring before the first update
+};
+
+template<typename Dtype, int StateDim, int ActionDim>
+class TD3 {
+
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  typedef Eigen::Matrix<Dtype, StateDim, 1> State;
+  typedef Eigen::Matrix<Dtype, StateDim, Eigen::Dynamic> StateBatch;
+  typedef Eigen::Matrix<Dtype, ActionDim, 1> Action;
+  typedef Eigen::Matrix<Dtype, ActionDim, Eigen::Dynamic> ActionBatch;
+  typedef Eigen::Matrix<Dtype, 1, Eigen::Dynamic> ValueBatch;
+  typedef Eigen::Matrix<Dtype, 1, Eigen::Dynamic> CostBatch;
+
+  using Task_ = Task::Task<Dtype, StateDim, ActionDim, 0>;
+  using Noise_ = Noise::NormalDistributionNoise<Dtype, ActionDim>;
+  using Qfunction_ = FuncApprox::Qfunction<Dtype, StateDim, ActionDim>;
+  using Policy_ = FuncApprox::DeterministicPolicy<Dtype, StateDim, ActionDim>;
+  using ReplayRing_ = Replay::ReplayRing<Dtype, StateDim, ActionDim>;
+
+  using Parameters = TD3Parameters<Dtype>;
+
+  TD3(std::vector<Task_ *> &tasks,
+      Qfunction_ *qfunction1,
+      Qfunction_ *qfunction1_target,
+      Qfunction_ *qfunction2,
+      Qfunction_ *qfunction2_target,
+      Policy_ *policy,
+      Policy_ *policy_target,
+      std::vector<Noise_ *> &noises,
+      ReplayRing_ *replay,
+      const Parameters &parameters = Parameters(),
+      unsigned testingTrajN = 1) :
+      task_(tasks),
+      qfunction_{qfunction1, qfunction2},
+      qfunctionTarget_{qfunction1_target, qfunction2_target},
+      policy_(policy),
+      policyTarget_(policy_target),
+      noise_(noises),
+      replay_(replay),
+      param_(parameters),
+      testingTrajN_(testingTrajN),
+      state_(StateDim, tasks.size()),
+      episodeTime_(tasks.size(), 0.0) {
+    LOG_IF(FATAL, replay_->capacity() <= long(task_.size())) << "the replay ring has to hold more than one step";
+    for (int i = 0; i < 2; i++)
+      qfunctionTarget_[i]->copyAPI(*qfunction_[i]);
+    policyTarget_->copyAPI(*policy_);
+
+    noNoiseRaw_.resize(task_.size());
+    for (int i = 0; i < task_.size(); i++)
+      noNoise_.push_back(&noNoiseRaw_[i]);
+    for (int i = 0; i < task_.size(); i++) {
+      State state;
+      task_[i]->getInitialState(state);
+      state_.col(i) = state;
+    }
+  };
+
+  ~TD3() {};
+
+  void runOneLoop(int numOfSteps) {
+    iterNumber_++;
+    tester_.testPerformance(task_,
+                            noNoise_,
+                            policy_,
+                            task_[0]->timeLimit(),
+                            testingTrajN_,
+                            stepsTaken_,
+                            vis_lv_,
+                            std::to_string(iterNumber_));
+    /// the tester leaves the tasks wherever its episodes ended
+    for (int i = 0; i < task_.size(); i++)
+      restart(i);
+
+    LOG(INFO) << "Simulation and update";
+    for (long steps = 0; steps < numOfSteps; steps += task_.size()) {
+      Utils::timer->startTimer("Simulation");
+      {
+        RAI_TRACE_SCOPE("acquisition");
+        simulateOneStep();
+      }
+      Utils::timer->stopTimer("Simulation");
+
+      if (replay_->size() < std::max<long>(param_.warmupSteps, param_.batchSize)) continue;
+      Utils::timer->startTimer("TD3 update");
+      pendingUpdates_ += param_.updatesPerStep * task_.size();
+      for (; pendingUpdates_ >= 1.0; pendingUpdates_ -= 1.0)
+        update();
+      Utils::timer->stopTimer("TD3 update");
+    }
+    LOG(INFO) << "critic loss : " << qLoss_ << ", replay " << replay_->size() << " / " << replay_->capacity();
+  }
+
+  long stepsTaken() const { return stepsTaken_; }
+  void setVisualizationLevel(int vis_lv) { vis_lv_ = vis_lv; }
+
+ private:
+
+  void restart(int i) {
+    State state;
+    task_[i]->getInitialState(state);
+    state_.col(i) = state;
+    episodeTime_[i] = 0.0;
+  }
+
+  /// every task takes one exploring step, the transitions go straight into the ring
+  void simulateOneStep() {
+    ActionBatch action(ActionDim, task_.size());
+    policy_->forward(state_, action);
+
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < task_.size(); i++) {
+      const State state = state_.col(i);
+      const Action explored = action.col(i) + noise_[i]->sampleNoise();
+      State next;
+      Dtype cost;
+      TerminationType termType = TerminationType::not_terminated;
+      task_[i]->step(explored, next, termType, cost);
+      episodeTime_[i] += task_[i]->dt();
+      if (termType == TerminationType::not_terminated && episodeTime_[i] >= task_[i]->timeLimit() - 1e-9)
+        termType = TerminationType::timeout;
+      replay_->push(state, explored, cost, next, termType);
+
+      if (termType == TerminationType::not_terminated)
+        state_.col(i) = next;
+      else
+        restart(i);
+    }
+    stepsTaken_ += task_.size();
+  }
+
+  void update() {
+    RAI_TRACE_SCOPE("TD3 update");
+    replay_->sample(param_.batchSize, stateBat_, actionBat_, costBat_, nextStateBat_, terminationBat_, sampleSeed_++);
+
+    /// smoothed target action, the target is the larger of the two target critics
+    ActionBatch nextAction;
+    policyTarget_->forward(nextStateBat_, nextAction);
+    for (int j = 0; j < nextAction.cols(); j++)
+      for (int a = 0; a < ActionDim; a++)
+        nextAction(a, j) += std::min(std::max(rn_.sampleNormal() * param_.targetNoise, -param_.targetNoiseClip),
+                                     param_.targetNoiseClip);
+    ValueBatch value1, value2;
+    qfunctionTarget_[0]->forward(nextStateBat_, nextAction, value1);
+    qfunctionTarget_[1]->forward(nextStateBat_, nextAction, value2);
+
+    const Dtype discount = task_[0]->discountFtr();
+    ValueBatch target(1, costBat_.cols());
+    for (int j = 0; j < target.cols(); j++) {
+      const Dtype next = TerminationType(terminationBat_(j)) == TerminationType::terminalState ?
+                         task_[0]->termValue() : std::max(value1(j), value2(j));
+      target(j) = costBat_(j) + discount * next;
+    }
+
+    qLoss_ = qfunction_[0]->performOneSolverIter(stateBat_, actionBat_, target);
+    qfunction_[1]->performOneSolverIter(stateBat_, actionBat_, target);
+
+    if (++criticUpdates_ % param_.policyDelay != 0) return;
+    policy_->backwardUsingCritic(qfunction_[0], stateBat_);
+    for (int i = 0; i < 2; i++)
+      qfunctionTarget_[i]->interpolateAPI(*qfunction_[i], param_.tau);
+    policyTarget_->interpolateAPI(*policy_, param_.tau);
+  }
+
+  /////////////////////////// Core //////////////////////////////////////////
+  std::vector<Task_ *> task_;
+  Qfunction_ *qfunction_[2];
+  Qfunction_ *qfunctionTarget_[2];
+  Policy_ *policy_;
+  Policy_ *policyTarget_;
+  std::vector<Noise_ *> noise_;
+  std::vector<Noise::Noise<Dtype, ActionDim> *> noNoise_;
+  std::vector<Noise::NoNoise<Dtype, ActionDim>> noNoiseRaw_;
+  ReplayRing_ *replay_;
+  PerformanceTester<Dtype, StateDim, ActionDim> tester_;
+
+  /////////////////////////// Algorithmic parameter ///////////////////
+  Parameters param_;
+  Dtype pendingUpdates_ = 0;
+  long criticUpdates_ = 0;
+  Dtype qLoss_ = 0;
+
+  /////////////////////////// simulation
+  StateBatch state_;
+  std::vector<double> episodeTime_;
+  long stepsTaken_ = 0;
+
+  /////////////////////////// minibatch
+  StateBatch stateBat_, nextStateBat_;
+  ActionBatch actionBat_;
+  CostBatch costBat_;
+  typename ReplayRing_::TerminationBatch terminationBat_;
+  uint64_t sampleSeed_ = 0;
+
+  /////////////////////////// plotting
+  int iterNumber_ = 0;
+
+  /////////////////////////// random number generator
+  RandomNumberGenerator<Dtype> rn_;
+
+  ///////////////////////////testing
+  unsigned testingTrajN_;
+
+  /////////////////////////// visualization
+  int vis_lv_ = 0;
+};
+
+}
+}
+
+#endif //RAI_TD3_HPP
@@ -0,0 +1,277 @@
+//
+// Runs a hyperparameter sweep of the trainer on one machine. Every run gets
+// its own cores out of a global budget, the runs expected to take longest are
+// started first and smaller ones fill the cores left over. Runs are compared
+// at rungs (fractions of their iterations) and one whose performance is worse
+// than the median of the runs that already passed that rung is stopped.
+// usage: trainer_sweep <sweep spec> [sweep.key=value ...]
+//
+
+#include <sched.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config/Config.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Run {
+  int id;
+  rai::Config::Config config;
+  std::string directory;
+  int threads, iterations;
+  double cost;                          // expected cpu work, only used to order the runs
+
+  enum Status { queued, running, finished, stopped, failed } status = queued;
+  pid_t pid = -1;
+  std::vector<int> cores;
+  Clock::time_point start;
+  double seconds = 0;
+
+  std::streamoff metricsOffset = 0;     // metrics.csv is read incrementally
+  std::vector<double> performance;      // one per iteration
+  int rungsPassed = 0;
+};
+
+const char *statusName(Run::Status status) {
+  static const char *names[] = {"queued", "running", "finished", "stopped", "failed"};
+  return names[status];
+}
+
+/// mean of the last few iterations, a single test is too noisy to compare runs with
+double score(const Run &run) {
+  size_t n = std::min<size_t>(5, run.performance.size());
+  if (n == 0) return 0;
+  return std::accumulate(run.performance.end() - n, run.performance.end(), 0.0) / n;
+}
+
+/// samples times multiply-adds of the policy and value networks per sample, plus the simulation
+double expectedCost(const rai::Config::Config &config) {
+  std::vector<double> layers;
+  for (auto &width : rai::Config::split(config.get("hidden", "128 128"), ' '))
+    if (!width.empty()) layers.push_back(std::stod(width));
+  double weights = 0;
+  for (size_t i = 1; i < layers.size(); i++) weights += layers[i - 1] * layers[i];
+  if (!layers.empty()) weights += 30 * layers.front() + 5 * layers.back();
+  double samples = double(config.get("iterations", 500)) * config.get("steps_per_iteration", 5000);
+  double updates = config.get("algorithm", "PPO") == "PPO" ? config.get("epochs", 5) : 1;
+  return samples * (2e3 + 2 * weights * (1 + updates));
+}
+
+/// reads the performance lines appended to the run's metrics.csv since the last call
+void readProgress(Run &run) {
+  std::ifstream file(run.directory + "/metrics.csv");
+  if (!file) return;
+  file.seekg(run.metricsOffset);
+  std::string line;
+  while (std::getline(file, line)) {
+    if (file.eof()) break;                // the writer has not finished this line yet
+    run.metricsOffset = file.tellg();
+    auto fields = rai::Config::split(line, ',');
+    if (fields.size() == 5 && fields[3] == "performance") run.performance.push_back(std::stod(fields[4]));
+  }
+}
+
+class Sweep {
+ public:
+
+  Sweep(const rai::Config::Config &settings, const std::vector<rai::Config::Config> &grid) {
+    trainer_ = settings.get("sweep.trainer");
+    output_ = settings.get("sweep.output", "sweep");
+    int cores = settings.get("sweep.cores", 0);
+    if (cores <= 0) cores = int(std::thread::hardware_concurrency());
+    coreBusy_.assign(cores, false);
+    for (auto &rung : rai::Config::split(settings.get("sweep.rungs", "0.25, 0.5"), ','))
+      rungs_.push_back(std::stod(rung));
+    rungScores_.resize(rungs_.size());
+    minRuns_ = settings.get("sweep.min_runs", 3);
+    maximize_ = settings.get("sweep.maximize", false);
+
+    mkdir(output_.c_str(), 0755);
+    for (auto &config : grid) {
+      Run run;
+      run.id = int(runs_.size());
+      run.config = config;
+      char directory[32];
+      std::snprintf(directory, sizeof(directory), "/run_%03d", run.id);
+      run.directory = output_ + directory;
+      run.config.set("output", run.directory);
+      run.config.set("name", "run_" + std::to_string(run.id));
+      run.threads = std::min(std::max(config.get("threads", 10), 1), cores);
+      run.config.set("threads", std::to_string(run.threads));
+      run.iterations = config.get("iterations", 500);
+      run.cost = expectedCost(config);
+      runs_.push_back(run);
+    }
+  }
+
+  void run() {
+    std::cout << runs_.size() << " runs on " << coreBusy_.size() << " cores" << std::endl;
+    while (true) {
+      reap();
+      for (auto &run : runs_)
+        if (run.status == Run::running) {
+          readProgress(run);
+          judge(run);
+        }
+      schedule();
+      if (std::none_of(runs_.begin(), runs_.end(), [](const Run &run) {
+        return run.status == Run::queued || run.status == Run::running; }))
+        break;
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+    writeSummary();
+  }
+
+ private:
+
+  /// longest expected wall time first, then whatever still fits into the free cores
+  void schedule() {
+    std::vector<Run *> queue;
+    for (auto &run : runs_)
+      if (run.status == Run::queued) queue.push_back(&run);
+    std::sort(queue.begin(), queue.end(), [](const Run *a, const Run *b) {
+      return a->cost / a->threads > b->cost / b->threads; });
+
+    for (auto run : queue) {
+      int free = int(std::count(coreBusy_.begin(), coreBusy_.end(), false));
+      if (run->threads <= free) launch(*run);
+    }
+  }
+
+  void launch(Run &run) {
+    for (int core = 0; core < int(coreBusy_.size()) && int(run.cores.size()) < run.threads; core++)
+      if (!coreBusy_[core]) {
+        coreBusy_[core] = true;
+        run.cores.push_back(core);
+      }
+
+    mkdir(run.directory.c_str(), 0755);
+    std::string configPath = run.directory + "/sweep.cfg";
+    run.config.save(configPath);
+    std::string logPath = run.directory + "/log.txt";
+
+    pid_t pid = fork();
+    if (pid == 0) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      for (int core : run.cores) CPU_SET(core, &set);
+      sched_setaffinity(0, sizeof(set), &set);
+      setenv("OMP_NUM_THREADS", std::to_string(run.threads).c_str(), 1);
+      std::freopen(logPath.c_str(), "w", stdout);
+      std::freopen(logPath.c_str(), "a", stderr);
+      execl(trainer_.c_str(), trainer_.c_str(), configPath.c_str(), (char *) nullptr);
+      std::perror("exec");
+      _exit(127);
+    }
+
+    run.pid = pid;
+    run.status = pid > 0 ? Run::running : Run::failed;
+    run.start = Clock::now();
+    std::cout << "started run_" << run.id << " on " << run.threads << " cores" << std::endl;
+  }
+
+  void reap() {
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+      for (auto &run : runs_)
+        if (run.pid == pid) {
+          readProgress(run);
+          run.seconds = std::chrono::duration<double>(Clock::now() - run.start).count();
+          for (int core : run.cores) coreBusy_[core] = false;
+          if (run.status != Run::stopped)
+            run.status = WIFEXITED(status) && WEXITSTATUS(status) == 0 ? Run::finished : Run::failed;
+          std::cout << "run_" << run.id << " " << statusName(run.status) << " after "
+                    << run.performance.size() << " iterations, score " << score(run) << std::endl;
+        }
+  }
+
+  bool worse(double a, double b) const { return maximize_ ? a < b : a > b; }
+
+  /// median stopping rule at every rung the run passed since the last check
+  void judge(Run &run) {
+    while (run.rungsPassed < int(rungs_.size())
+        && run.performance.size() >= size_t(rungs_[run.rungsPassed] * run.iterations)) {
+      auto &others = rungScores_[run.rungsPassed];
+      double mine = score(run);
+      bool stop = false;
+      if (int(others.size()) >= minRuns_) {
+        std::vector<double> sorted(others);
+        std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+        double median = sorted[sorted.size() / 2];
+        stop = worse(mine, median);
+      }
+      others.push_back(mine);
+      run.rungsPassed++;
+      if (stop) {
+        std::cout << "stopping run_" << run.id << " at rung " << run.rungsPassed << ", score " << mine << std::endl;
+        run.status = Run::stopped;
+        kill(run.pid, SIGTERM);
+        return;
+      }
+    }
+  }
+
+  void writeSummary() {
+    std::vector<const Run *> ranked;
+    for (auto &run : runs_) ranked.push_back(&run);
+    std::sort(ranked.begin(), ranked.end(), [this](const Run *a, const Run *b) {
+      if (a->status == Run::finished && b->status != Run::finished) return true;
+      if (a->status != Run::finished && b->status == Run::finished) return false;
+      return worse(score(*b), score(*a)); });
+
+    std::ofstream summary(output_ + "/sweep.csv");
+    summary << "run,status,iterations,score,seconds,config\n";
+    for (auto run : ranked) {
+      std::string config;
+      for (auto &entry : run->config.entries())
+        if (entry.first != "output" && entry.first != "name") config += entry.first + "=" + entry.second + ";";
+      summary << "run_" << run->id << "," << statusName(run->status) << "," << run->performance.size() << ","
+              << score(*run) << "," << run->seconds << ",\"" << config << "\"\n";
+    }
+    std::cout << "summary written to " << output_ << "/sweep.csv" << std::endl;
+  }
+
+  std::string trainer_, output_;
+  std::vector<bool> coreBusy_;
+  std::vector<double> rungs_;
+  std::vector<std::vector<double>> rungScores_;
+  int minRuns_;
+  bool maximize_;
+  std::vector<Run> runs_;
+};
+
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <sweep spec> [sweep.key=value ...]" << std::endl;
+    return 1;
+  }
+
+  rai::Config::Config arguments(argv[1]), spec, settings;
+  arguments.parseArguments(argc, argv, 2);
+  for (auto &entry : arguments.entries())
+    if (entry.first.compare(0, 6, "sweep.") == 0)
+      settings.set(entry.first, entry.second);
+    else
+      spec.set(entry.first, entry.second);
+
+  Sweep sweep(settings, rai::Config::expandGrid(spec));
+  sweep.run();
+}
@@ -0,0 +1,296 @@
+//
+// Trains one configuration read at runtime, so a sweep does not rebuild for
+// every task, network, thread count or algorithm parameter.
+// usage: trainer <config file> [key=value ...]
+// The keys and their defaults are listed in slungload_PPO.cfg. Metrics,
+// the resolved config and the final policy are written to "output".
+// SIGTERM ends the run after the current iteration.
+//
+
+#include "rai/RAI_core"
+
+// Eigen
+#include <Eigen/Dense>
+
+// task
+#include "common/Tasks.hpp"
+
+// noise model
+#include "rai/noiseModel/NormalDistributionNoise.hpp"
+
+// Neural network
+#include "rai/function/tensorflow/StochasticPolicy_TensorFlow.hpp"
+#include "rai/function/tensorflow/ValueFunction_TensorFlow.hpp"
+#include "rai/function/tensorflow/DeterministicPolicy_TensorFlow.hpp"
+#include "rai/function/tensorflow/Qfunction_TensorFlow.hpp"
+
+// algorithm
+#include "rai/algorithm/PPO.hpp"
+#include "rai/algorithm/TRPO_gae.hpp"
+#include "TD3.hpp"
+
+// acquisitor
+#include "rai/experienceAcquisitor/TrajectoryAcquisitor_Parallel.hpp"
+
+// configuration and metrics
+#include "config/Config.hpp"
+#include "metrics/Metrics.hpp"
+
+#include <sys/stat.h>
+#include <cmath>
+#include <csignal>
+
+using namespace std;
+
+/// learning states
+using Dtype = double;
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void makeDirectories(const std::string &path) {
+  for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+    mkdir(path.substr(0, slash).c_str(), 0755);
+    if (slash == std::string::npos) break;
+  }
+}
+
+/// "tanh 3e-3 24 128 128 4" from activation, init_scale and hidden of the config
+std::string networkSpec(const rai::Config::Config &config, int inputs, int outputs) {
+  return config.get("activation", "tanh") + " " + config.get("init_scale", "3e-3") + " "
+      + std::to_string(inputs) + " " + config.get("hidden", "128 128") + " " + std::to_string(outputs);
+}
+
+/// running observation normalization of all envs, merged at every iteration boundary
+template<int StateDim>
+struct Normalization {
+  using Normalizer = rai::Task::ObservationNormalizer<Dtype, StateDim>;
+  std::vector<Normalizer *> normalizers;
+  typename Normalizer::Statistics total;
+  std::shared_ptr<const typename Normalizer::Frozen> frozen;
+
+  void update() {
+    if (!normalizers.empty()) frozen = Normalizer::update(normalizers, total);
+  }
+
+  /// written next to every policy dump, the policy expects its inputs normalized this way
+  void save(const std::string &path) const {
+    if (frozen) frozen->save(path);
+  }
+};
+
+/// per-episode statistics of all envs, merged and logged at every iteration boundary
+struct Episodes {
+  std::vector<rai::Metrics::EpisodeStatistics *> statistics;
+  rai::Metrics::EpisodeHistograms histograms;
+
+  void log(rai::Metrics::Exporter &metrics) {
+    rai::Metrics::EpisodeStatistics::collect(statistics, histograms);
+    rai::Metrics::logEpisodes(histograms, &metrics);
+  }
+};
+
+struct Schedule {
+  std::string name, output;
+  int iterations, stepsPerIteration, checkpointInterval;
+};
+
+template<typename Algorithm, typename Acquisitor, typename Policy, typename Normalization>
+void train(Algorithm &algorithm,
+           Acquisitor &acquisitor,
+           Policy &policy,
+           Normalization &normalization,
+           Episodes &episodes,
+           const rai::Config::Config &config,
+           const Schedule &schedule) {
+  /// every key has been read by now, so whatever is left over is a typo
+  for (auto &key : config.unusedKeys())
+    LOG(WARNING) << "config key " << key << " is not used";
+  config.save(schedule.output + "/config.txt");
+
+  const std::string &output = schedule.output;
+  rai::Metrics::Exporter metrics(output, schedule.name);
+  algorithm.setVisualizationLevel(0);
+
+  for (int iterationNumber = 0; iterationNumber < schedule.iterations && !stopRequested; iterationNumber++) {
+    algorithm.runOneLoop(schedule.stepsPerIteration);
+    metrics.set("performance", rai::Metrics::lastLogged("PerformanceTester/performance"));
+    metrics.setSteps(acquisitor.stepsTaken());
+    episodes.log(metrics);
+    metrics.commit(iterationNumber);
+    normalization.update();
+
+    const int interval = schedule.checkpointInterval;
+    if (interval > 0 && iterationNumber % interval == interval - 1) {
+      policy.dumpParam(output + "/policy_" + std::to_string(iterationNumber) + ".txt");
+      normalization.save(output + "/observation_normalization_" + std::to_string(iterationNumber) + ".txt");
+    }
+  }
+
+  if (stopRequested) LOG(INFO) << "stopped on request";
+  policy.dumpParam(output + "/policy.txt");
+  normalization.save(output + "/observation_normalization.txt");
+}
+
+/// off-policy training, the networks and the replay ring differ from the on-policy algorithms
+template<int StateDim, int ActionDim, typename Task, typename Normalization>
+void trainTD3(std::vector<Task *> &taskVector,
+              Normalization &normalization,
+              Episodes &episodes,
+              const rai::Config::Config &config,
+              const Schedule &schedule) {
+  using Noise = rai::Noise::NormalDistributionNoise<Dtype, ActionDim>;
+  using NoiseCovariance = Eigen::Matrix<Dtype, ActionDim, ActionDim>;
+  using Policy_TensorFlow = rai::FuncApprox::DeterministicPolicy_TensorFlow<Dtype, StateDim, ActionDim>;
+  using Qfunction_TensorFlow = rai::FuncApprox::Qfunction_TensorFlow<Dtype, StateDim, ActionDim>;
+  using Algorithm = rai::Algorithm::TD3<Dtype, StateDim, ActionDim>;
+
+  ////////////////////////// Define Function approximations //////////
+  /// the critics take the state and the action, "<activation> <init_scale> StateDim ActionDim <hidden> 1"
+  const std::string device = config.get("device", "cpu");
+  const std::string qSpec = config.get("activation", "tanh") + " " + config.get("init_scale", "3e-3") + " "
+      + std::to_string(StateDim) + " " + std::to_string(ActionDim) + " " + config.get("hidden", "128 128") + " 1";
+  const Dtype lrQ = config.get("lr_q", 1e-3), lrPolicy = config.get("lr_policy", 1e-3);
+  Qfunction_TensorFlow qfunction1(device, "MLP2", qSpec, lrQ), qfunction1Target(device, "MLP2", qSpec, lrQ);
+  Qfunction_TensorFlow qfunction2(device, "MLP2", qSpec, lrQ), qfunction2Target(device, "MLP2", qSpec, lrQ);
+  Policy_TensorFlow policy(device, "MLP", networkSpec(config, StateDim, ActionDim), lrPolicy);
+  Policy_TensorFlow policyTarget(device, "MLP", networkSpec(config, StateDim, ActionDim), lrPolicy);
+
+  ////////////////////////// Define Noise Model //////////////////////
+  /// the config holds a standard deviation, the noise model takes a covariance
+  const double noiseStdev = config.get("noise_stdev", 0.2);
+  NoiseCovariance covariance = NoiseCovariance::Identity() * std::pow(noiseStdev, 2);
+  std::vector<Noise> noiseVec(taskVector.size(), Noise(covariance));
+  std::vector<Noise *> noiseVector;
+  for (auto &noise : noiseVec)
+    noiseVector.push_back(&noise);
+
+  ////////////////////////// Algorithm ////////////////////////////////
+  typename Algorithm::Parameters parameters;
+  parameters.batchSize = config.get("batch_size", 256);
+  parameters.tau = config.get("tau", 5e-3);
+  parameters.policyDelay = config.get("policy_delay", 2);
+  parameters.targetNoise = config.get("target_noise", 0.2);
+  parameters.targetNoiseClip = config.get("target_noise_clip", 0.5);
+  parameters.updatesPerStep = config.get("updates_per_step", 1.0);
+  parameters.warmupSteps = config.get("warmup_steps", 10000);
+  typename Algorithm::ReplayRing_ replay(config.get("replay_capacity", 1000000));
+
+  Algorithm algorithm(taskVector, &qfunction1, &qfunction1Target, &qfunction2, &qfunction2Target,
+                      &policy, &policyTarget, noiseVector, &replay, parameters, config.get("test_trajectories", 20));
+  /// the algorithm counts its own steps, it has no acquisitor
+  train(algorithm, algorithm, policy, normalization, episodes, config, schedule);
+}
+
+/// builds the envs of the task called taskName through the registry and trains on them
+template<typename Tag>
+void run(const rai::Task::TaskRegistry<Dtype> &registry,
+         const std::string &taskName,
+         const rai::Config::Config &config,
+         const Schedule &schedule) {
+  constexpr int StateDim = Tag::Traits::StateDim;
+  constexpr int ActionDim = Tag::Traits::ActionDim;
+  using TaskType = typename Tag::template Type<Dtype>;
+  using Noise = rai::Noise::NormalDistributionNoise<Dtype, ActionDim>;
+  using NoiseCovariance = Eigen::Matrix<Dtype, ActionDim, ActionDim>;
+  using Policy_TensorFlow = rai::FuncApprox::StochasticPolicy_TensorFlow<Dtype, StateDim, ActionDim>;
+  using Vfunction_TensorFlow = rai::FuncApprox::ValueFunction_TensorFlow<Dtype, StateDim>;
+  using Acquisitor = rai::ExpAcq::TrajectoryAcquisitor_Parallel<Dtype, StateDim, ActionDim>;
+
+  const int nThread = config.get("threads", 10);
+  omp_set_num_threads(nThread);
+
+  ////////////////////////// Define task ////////////////////////////
+  auto taskVec = registry.template create<StateDim, ActionDim>(taskName, nThread);
+  std::vector<rai::Task::Task<Dtype, StateDim, ActionDim, 0> *> taskVector;
+  const auto randomization = rai::Task::ParameterRandomization::fromConfig(config);
+  Normalization<StateDim> normalization;
+  Episodes episodes;
+  const bool normalize = config.get("normalize_observations", false);
+  const std::string algorithmName = config.get("algorithm", "PPO");
+  /// a replayed state would be normalized with the statistics of the iteration that stored it
+  LOG_IF(FATAL, normalize && algorithmName == "TD3") << "TD3 does not support normalize_observations";
+
+  for (auto &task : taskVec) {
+    task->setControlUpdate_dt(config.get("dt", 0.01));
+    task->setDiscountFactor(config.get("discount", 0.99));
+    task->setTimeLimitPerEpisode(config.get("time_limit", 5.0));
+    if (config.has("terminal_value")) task->setValueAtTerminalState(config.get("terminal_value", 1.5));
+    /// the registry built taskName, so the envs are TaskType
+    static_cast<TaskType *>(task.get())->setParameterRandomization(randomization);
+    if (normalize) normalization.normalizers.push_back(&static_cast<TaskType *>(task.get())->observationNormalizer());
+    episodes.statistics.push_back(&static_cast<TaskType *>(task.get())->episodeStatistics());
+    taskVector.push_back(task.get());
+  }
+  /// the first iteration sees the states as they are and collects their statistics
+  for (auto normalizer : normalization.normalizers)
+    normalizer->enable(std::make_shared<const typename Normalization<StateDim>::Normalizer::Frozen>());
+
+  if (algorithmName == "TD3") {
+    trainTD3<StateDim, ActionDim>(taskVector, normalization, episodes, config, schedule);
+    return;
+  }
+
+  ////////////////////////// Define Function approximations //////////
+  const std::string device = config.get("device", "cpu");
+  Vfunction_TensorFlow vfunction(device, "MLP", networkSpec(config, StateDim, 1), config.get("lr_value", 1e-3));
+  Policy_TensorFlow policy(device, "MLP", networkSpec(config, StateDim, ActionDim), config.get("lr_policy", 1e-3));
+
+  ////////////////////////// Define Noise Model //////////////////////
+  /// the config holds a standard deviation, the noise model takes a covariance
+  const double noiseStdev = config.get("noise_stdev", 1.0);
+  NoiseCovariance covariance = NoiseCovariance::Identity() * std::pow(noiseStdev, 2);
+  std::vector<Noise> noiseVec(nThread, Noise(covariance));
+  std::vector<Noise *> noiseVector;
+  for (auto &noise : noiseVec)
+    noiseVector.push_back(&noise);
+
+  ////////////////////////// Acquisitor //////////////////////
+  Acquisitor acquisitor;
+
+  ////////////////////////// Algorithm ////////////////////////////////
+  const Dtype lambda = config.get("lambda", 0.97);
+  const int K = config.get("K", 0);
+  const int junctions = config.get("junctions", 0);
+  const int testTrajectories = config.get("test_trajectories", 20);
+
+  if (algorithmName == "PPO") {
+    rai::Algorithm::PPO<Dtype, StateDim, ActionDim>
+        algorithm(taskVector, &vfunction, &policy, noiseVector, &acquisitor, lambda, K, junctions, testTrajectories,
+                  config.get("epochs", 5), config.get("minibatches", 5));
+    train(algorithm, acquisitor, policy, normalization, episodes, config, schedule);
+  } else if (algorithmName == "TRPO") {
+    rai::Algorithm::TRPO_gae<Dtype, StateDim, ActionDim>
+        algorithm(taskVector, &vfunction, &policy, noiseVector, &acquisitor, lambda, K, junctions, testTrajectories);
+    train(algorithm, acquisitor, policy, normalization, episodes, config, schedule);
+  } else {
+    LOG(FATAL) << "unknown algorithm " << algorithmName << ", expected PPO, TRPO or TD3";
+  }
+}
+
+}
+
+int main(int argc, char *argv[]) {
+
+  LOG_IF(FATAL, argc < 2) << "usage: " << argv[0] << " <config file> [key=value ...]";
+  rai::Config::Config config(argv[1]);
+  config.parseArguments(argc, argv, 2);
+
+  RAI_init();
+  std::signal(SIGTERM, [](int) { stopRequested = 1; });
+
+  Schedule schedule;
+  schedule.name = config.get("name", "trainer");
+  schedule.output = config.get("output", RAI_LOG_PATH);
+  schedule.iterations = config.get("iterations", 500);
+  schedule.stepsPerIteration = config.get("steps_per_iteration", 5000);
+  schedule.checkpointInterval = config.get("checkpoint_interval", 0);
+  makeDirectories(schedule.output);
+
+  const auto registry = rai::Task::defaultTaskRegistry<Dtype>();
+  const std::string taskName = config.get("task", "slungload");
+  rai::Task::visitTask(taskName, [&](auto tag) {
+    run<decltype(tag)>(registry, taskName, config, schedule);
+  });
+}
@@ -0,0 +1,283 @@
+//
+// Benchmarks every kernel variant this cpu can run and cross-checks it
+// against a scalar reference first. The gaussian kernel is also tested for
+// its moments, autocorrelation and distribution (Kolmogorov-Smirnov), and the
+// cached LSTM steps against recomputing each episode from its start.
+// Exits with 1 if a variant disagrees or fails a statistical test.
+// usage: bench_simd [--reps N] [--min-time SEC] [--filter STR] [--json PATH]
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "benchmark/Benchmark.hpp"
+#include "simd/Kernels.hpp"
+#include "simd/LstmPolicy.hpp"
+#include "simd/MlpPolicy.hpp"
+
+using rai::Simd::Activation;
+
+namespace {
+
+void referenceDense(const double *in, const double *weight, const double *bias, double *out,
+                    int nIn, int nOut, int nBatch, Activation activation) {
+  for (int b = 0; b < nBatch; b++)
+    for (int o = 0; o < nOut; o++) {
+      double sum = bias[o];
+      for (int i = 0; i < nIn; i++) sum += in[b * nIn + i] * weight[i * nOut + o];
+      if (activation == Activation::tanh) sum = std::tanh(sum);
+      if (activation == Activation::relu) sum = std::max(sum, 0.0);
+      out[b * nOut + o] = sum;
+    }
+}
+
+std::vector<double> randomVector(size_t size, double scale, std::mt19937 &rng) {
+  std::normal_distribution<double> normal(0.0, scale);
+  std::vector<double> values(size);
+  for (auto &value : values) value = normal(rng);
+  return values;
+}
+
+/// sizes that are not multiples of any vector width are included to cover the remainder loops
+bool crossCheck(const rai::Simd::Kernels &kernels) {
+  const int shapes[][3] = {{24, 128, 1}, {24, 128, 100}, {128, 128, 37}, {128, 4, 100}, {13, 7, 5}, {3, 1, 1}};
+  const Activation activations[] = {Activation::linear, Activation::tanh, Activation::relu};
+  std::mt19937 rng(7);
+  double worst = 0;
+
+  for (auto &shape : shapes)
+    for (auto activation : activations) {
+      const int nIn = shape[0], nOut = shape[1], nBatch = shape[2];
+      auto in = randomVector(size_t(nIn) * nBatch, 2.0, rng);
+      auto weight = randomVector(size_t(nIn) * nOut, 1.0 / std::sqrt(nIn), rng);
+      auto bias = randomVector(nOut, 0.5, rng);
+      std::vector<double> expected(size_t(nOut) * nBatch), actual(expected.size());
+
+      referenceDense(in.data(), weight.data(), bias.data(), expected.data(), nIn, nOut, nBatch, activation);
+      kernels.dense(in.data(), weight.data(), bias.data(), actual.data(), nIn, nOut, nBatch, activation);
+      for (size_t k = 0; k < expected.size(); k++)
+        worst = std::max(worst, std::abs(actual[k] - expected[k]) / (1.0 + std::abs(expected[k])));
+    }
+
+  bool ok = worst < 1e-12;
+  std::printf("%-8s cross-check %s, worst relative error %.2e\n",
+              rai::Simd::isaName(kernels.isa), ok ? "passed" : "FAILED", worst);
+  return ok;
+}
+
+uint64_t referenceSplitmix64(uint64_t key, uint64_t k) {
+  uint64_t z = key + k * 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/// the same pairs and layout as the kernel, with libm doing the math
+void referenceGaussian(uint64_t key, uint64_t counter, double *out, int n) {
+  const int half = n / 2;
+  for (int j = 0; j < (n + 1) / 2; j++) {
+    const uint64_t radiusBits = referenceSplitmix64(key, 2 * (counter + j));
+    const uint64_t angleBits = referenceSplitmix64(key, 2 * (counter + j) + 1);
+    const double u = 1.0 - double(radiusBits >> 12) / 4503599627370496.0;
+    const double f = (double(angleBits >> 12) / 4503599627370496.0 - 0.5) * M_PI / 2;
+    const double r = std::sqrt(-2.0 * std::log(u)), angle = f + double(angleBits & 3) * M_PI / 2;
+    if (j < half) {
+      out[j] = r * std::cos(angle);
+      out[half + j] = r * std::sin(angle);
+    } else {
+      out[n - 1] = r * std::cos(angle);
+    }
+  }
+}
+
+/// 5 sigma bounds for the sample moments, so a correct kernel fails about once in a million runs
+bool checkGaussian(const rai::Simd::Kernels &kernels) {
+  double worst = 0;
+  for (int n : {1, 2, 7, 400, 4001}) {
+    std::vector<double> expected(n), actual(n);
+    referenceGaussian(12345, 678, expected.data(), n);
+    kernels.gaussian(12345, 678, actual.data(), n);
+    for (int k = 0; k < n; k++)
+      worst = std::max(worst, std::abs(actual[k] - expected[k]));
+  }
+
+  const int n = 1 << 22;
+  std::vector<double> samples(n);
+  for (int block = 0; block < n; block += 400)
+    kernels.gaussian(7, uint64_t(block) / 2, samples.data() + block, std::min(400, n - block));
+
+  double mean = 0, m2 = 0, m3 = 0, m4 = 0, lag = 0;
+  for (double x : samples) mean += x;
+  mean /= n;
+  for (int k = 0; k < n; k++) {
+    const double d = samples[k] - mean;
+    m2 += d * d;
+    m3 += d * d * d;
+    m4 += d * d * d * d;
+    if (k > 0) lag += d * (samples[k - 1] - mean);
+  }
+  m2 /= n;
+  const double skew = m3 / n / std::pow(m2, 1.5), kurtosis = m4 / n / (m2 * m2) - 3.0;
+  const double correlation = lag / (n - 1) / m2;
+
+  std::sort(samples.begin(), samples.end());
+  double ks = 0;
+  for (int k = 0; k < n; k++) {
+    const double cdf = 0.5 * std::erfc(-samples[k] / std::sqrt(2.0));
+    ks = std::max(ks, std::max(cdf - double(k) / n, double(k + 1) / n - cdf));
+  }
+
+  const double sqrtN = std::sqrt(double(n));
+  const bool ok = worst < 1e-12
+      && std::abs(mean) < 5 / sqrtN
+      && std::abs(m2 - 1) < 5 * std::sqrt(2.0) / sqrtN
+      && std::abs(skew) < 5 * std::sqrt(6.0) / sqrtN
+      && std::abs(kurtosis) < 5 * std::sqrt(24.0) / sqrtN
+      && std::abs(correlation) < 5 / sqrtN
+      && ks * sqrtN < 1.95;  // Kolmogorov p = 0.001
+  std::printf("%-8s gaussian %s, worst error %.2e, mean %.1e, var %.5f, skew %.1e, "
+              "kurtosis %.1e, lag-1 corr %.1e, KS %.2f\n",
+              rai::Simd::isaName(kernels.isa), ok ? "passed" : "FAILED", worst, mean, m2, skew,
+              kurtosis, correlation, ks * sqrtN);
+  return ok;
+}
+
+/// LSTM output of one env after the states of its episode so far, computed from scratch
+std::vector<double> referenceLstm(const std::vector<std::vector<double> > &episode, const std::vector<double> &parameter,
+                                  int nIn, int nHidden, int nAction) {
+  const int nGates = 4 * nHidden;
+  const double *kernel = parameter.data(), *bias = kernel + (nIn + nHidden) * nGates;
+  const double *headWeight = bias + nGates, *headBias = headWeight + nHidden * nAction;
+  auto sigmoid = [](double x) { return 1.0 / (1.0 + std::exp(-x)); };
+  std::vector<double> h(nHidden, 0.0), c(nHidden, 0.0), input(nIn + nHidden), gate(nGates);
+
+  for (auto &state : episode) {
+    std::copy(state.begin(), state.end(), input.begin());
+    std::copy(h.begin(), h.end(), input.begin() + nIn);
+    referenceDense(input.data(), kernel, bias, gate.data(), nIn + nHidden, nGates, 1, Activation::linear);
+    for (int k = 0; k < nHidden; k++) {
+      c[k] = sigmoid(gate[2 * nHidden + k] + 1.0) * c[k] + sigmoid(gate[k]) * std::tanh(gate[nHidden + k]);
+      h[k] = sigmoid(gate[3 * nHidden + k]) * std::tanh(c[k]);
+    }
+  }
+  std::vector<double> action(nAction);
+  referenceDense(h.data(), headWeight, headBias, action.data(), nHidden, nAction, 1, Activation::linear);
+  return action;
+}
+
+/// steps 5 envs with the state cache, env e starts a new episode every 7 + e steps
+bool checkLstm() {
+  const int nIn = 12, nHidden = 16, nAction = 4, nEnvs = 5, nSteps = 30;
+  rai::Simd::LstmPolicy policy(nIn, nHidden, {nHidden, nAction}, Activation::relu);
+  rai::Simd::RecurrentStateCache cache(nHidden, nEnvs);
+  std::mt19937 rng(11);
+  auto parameter = randomVector(policy.parameterSize(), 0.3, rng);
+  policy.setParameters(parameter.data(), long(parameter.size()));
+
+  std::vector<std::vector<std::vector<double> > > episodes(nEnvs);
+  std::vector<double> states(nIn * nEnvs), actions(nAction * nEnvs);
+  double worst = 0;
+  for (int t = 0; t < nSteps; t++) {
+    for (int e = 0; e < nEnvs; e++) {
+      if (t % (7 + e) == 0) {
+        episodes[e].clear();
+        cache.reset(e);
+      }
+      episodes[e].push_back(randomVector(nIn, 1.0, rng));
+      std::copy(episodes[e].back().begin(), episodes[e].back().end(), states.begin() + e * nIn);
+    }
+    policy.step(states.data(), actions.data(), cache);
+    for (int e = 0; e < nEnvs; e++) {
+      auto expected = referenceLstm(episodes[e], parameter, nIn, nHidden, nAction);
+      for (int a = 0; a < nAction; a++)
+        worst = std::max(worst, std::abs(actions[e * nAction + a] - expected[a]) / (1.0 + std::abs(expected[a])));
+    }
+  }
+
+  /// a parameter vector of another network is rejected, not read with shifted weights
+  parameter.push_back(0.0);
+  bool ok = worst < 1e-12 && !policy.setParameters(parameter.data(), long(parameter.size()));
+  std::printf("lstm state cache %s, worst relative error %.2e\n", ok ? "passed" : "FAILED", worst);
+  return ok;
+}
+
+void benchDense(rai::Bench::Runner &runner, const rai::Simd::Kernels &kernels,
+                const std::string &name, int nIn, int nOut, int nBatch, Activation activation) {
+  std::mt19937 rng(1);
+  auto in = randomVector(size_t(nIn) * nBatch, 1.0, rng);
+  auto weight = randomVector(size_t(nIn) * nOut, 0.1, rng);
+  auto bias = randomVector(nOut, 0.1, rng);
+  std::vector<double> out(size_t(nOut) * nBatch);
+
+  runner.run(std::string("Simd/") + rai::Simd::isaName(kernels.isa), name, [&]() {
+    kernels.dense(in.data(), weight.data(), bias.data(), out.data(), nIn, nOut, nBatch, activation);
+    rai::Bench::doNotOptimize(out[0]);
+  });
+}
+
+}
+
+int main(int argc, char *argv[]) {
+  rai::Bench::Runner runner(argc, argv);
+  std::printf("dispatched to %s\n", rai::Simd::isaName(rai::Simd::detectIsa()));
+
+  bool ok = true;
+  for (auto kernels : rai::Simd::availableKernels()) {
+    ok = crossCheck(*kernels) && ok;
+    ok = checkGaussian(*kernels) && ok;
+  }
+  ok = checkLstm() && ok;
+
+  /// the layers of the slungload policy "tanh 3e-3 24 128 128 4" over one step of 100 envs
+  for (auto kernels : rai::Simd::availableKernels()) {
+    benchDense(runner, *kernels, "dense24x128Tanh", 24, 128, 100, Activation::tanh);
+    benchDense(runner, *kernels, "dense128x128Tanh", 128, 128, 100, Activation::tanh);
+    benchDense(runner, *kernels, "dense128x128Linear", 128, 128, 100, Activation::linear);
+    benchDense(runner, *kernels, "dense128x4Linear", 128, 4, 100, Activation::linear);
+  }
+
+  /// exploration noise of 100 envs with 4 actions, against a normal distribution per sample
+  std::vector<double> noise(4 * 100);
+  uint64_t counter = 0;
+  for (auto kernels : rai::Simd::availableKernels())
+    runner.run(std::string("Simd/") + rai::Simd::isaName(kernels->isa), "gaussian4x100", [&]() {
+      kernels->gaussian(1, counter, noise.data(), 400);
+      counter += 200;
+      rai::Bench::doNotOptimize(noise[0]);
+    });
+  std::mt19937 noiseRng(1);
+  std::normal_distribution<double> normal;
+  runner.run("Simd/std", "normalDistribution4x100", [&]() {
+    for (auto &value : noise) value = normal(noiseRng);
+    rai::Bench::doNotOptimize(noise[0]);
+  });
+
+  rai::Simd::MlpPolicy policy({24, 128, 128, 4}, Activation::tanh);
+  std::mt19937 rng(3);
+  auto parameter = randomVector(policy.parameterSize(), 0.1, rng);
+  auto states = randomVector(24 * 100, 1.0, rng);
+  std::vector<double> actions(4 * 100);
+  policy.setParameters(parameter.data(), long(parameter.size()));
+  runner.run("Simd/dispatched", "mlpPolicy100", [&]() {
+    policy.forward(states.data(), actions.data(), 100);
+    rai::Bench::doNotOptimize(actions[0]);
+  });
+
+  /// one step of the "relu 1e-3 12 128 / 128 64 4" recurrent policy for 100 envs
+  rai::Simd::LstmPolicy lstm(12, 128, {128, 64, 4}, Activation::relu);
+  rai::Simd::RecurrentStateCache lstmState(128, 100);
+  auto lstmParameter = randomVector(lstm.parameterSize(), 0.1, rng);
+  auto lstmStates = randomVector(12 * 100, 1.0, rng);
+  lstm.setParameters(lstmParameter.data(), long(lstmParameter.size()));
+  runner.run("Simd/dispatched", "lstmPolicyStep100", [&]() {
+    lstm.step(lstmStates.data(), actions.data(), lstmState);
+    rai::Bench::doNotOptimize(actions[0]);
+  });
+
+  runner.report();
+  return ok ? 0 : 1;
+}
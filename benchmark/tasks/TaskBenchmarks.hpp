@@ -0,0 +1,83 @@
+//
+// Benchmarks shared by every task. Include the task header first.
+//
+
+#ifndef RAI_TASKBENCHMARKS_HPP
+#define RAI_TASKBENCHMARKS_HPP
+
+#include "benchmark/Benchmark.hpp"
+
+template<typename TaskType>
+void benchTask(rai::Bench::Runner &runner, const std::string &group) {
+  using State = typename TaskType::State;
+  using Action = typename TaskType::Action;
+  using Dtype = typename State::Scalar;
+  using rai::Bench::doNotOptimize;
+
+  TaskType task;
+  task.setControlUpdate_dt(0.01);
+  task.setTimeLimitPerEpisode(5.0);
+
+  State state;
+  Action action = Action::Zero();
+  rai::TerminationType termType = rai::TerminationType::not_terminated;
+  Dtype cost;
+
+  /// the episode restarts whenever it terminates, as it would during acquisition
+  runner.run(group, "step", [&]() {
+    task.step(action, state, termType, cost);
+    if (termType != rai::TerminationType::not_terminated) {
+      termType = rai::TerminationType::not_terminated;
+      task.init();
+    }
+    doNotOptimize(cost);
+  }, [&]() { task.init(); });
+
+  runner.run(group, "getState", [&]() {
+    task.getState(state);
+    doNotOptimize(state);
+  }, [&]() { task.init(); });
+
+  runner.run(group, "init", [&]() {
+    task.init();
+    doNotOptimize(task);
+  });
+
+  runner.run(group, "getInitialState", [&]() {
+    task.getInitialState(state);
+    doNotOptimize(state);
+  });
+
+  State initial;
+  runner.run(group, "initTo", [&]() {
+    task.initTo(initial);
+    doNotOptimize(task);
+  }, [&]() { task.getInitialState(initial); });
+
+  bool violating = false;
+  runner.run(group, "isViolatingBoxConstraint", [&]() {
+    violating ^= task.isViolatingBoxConstraint(state);
+    doNotOptimize(violating);
+  }, [&]() { task.getInitialState(state); });
+
+  /// what a vine junction costs per branch
+  typename TaskType::Snapshot snapshot;
+  runner.run(group, "saveState", [&]() {
+    task.saveState(snapshot);
+    doNotOptimize(snapshot);
+  }, [&]() { task.init(); });
+
+  runner.run(group, "restoreState", [&]() {
+    task.restoreState(snapshot);
+    doNotOptimize(task);
+  }, [&]() { task.init(); task.saveState(snapshot); });
+}
+
+/// drawWorld of a visualizer, called with the arguments the task passes
+template<typename Draw>
+void benchDrawWorld(rai::Bench::Runner &runner, const std::string &group, Draw draw) {
+  if (!runner.options().visualization) return;
+  runner.run(group, "drawWorld", draw);
+}
+
+#endif //RAI_TASKBENCHMARKS_HPP
@@ -0,0 +1,45 @@
+#include "slungload/multiSlungloadControl.hpp"
+#include "TaskBenchmarks.hpp"
+
+/// per agent cost of the team task, K = 4 and K = 8 should take about the same time per agent
+template<int K>
+void benchMultiSlungloadTeam(rai::Bench::Runner &runner) {
+  using TaskType = rai::Task::multiSlungloadControl<double, K>;
+  const std::string group = "multiSlungloadControl" + std::to_string(K);
+  benchTask<TaskType>(runner, group);
+
+  using Action = typename TaskType::Action;
+  using StateBatch = typename TaskType::StateBatch;
+  using ActionBatch = typename TaskType::ActionBatch;
+  const int nEnvs = 64;
+  std::vector<TaskType> tasks(nEnvs);
+  std::vector<TaskType *> envs;
+  for (auto &task : tasks) envs.push_back(&task);
+  ActionBatch actions = ActionBatch::Zero(int(TaskType::ActionDim), nEnvs);
+  StateBatch states;
+  std::vector<rai::TerminationType> termTypes;
+  typename TaskType::CostBatch costs;
+
+  runner.run(group, "stepBatch64", [&]() {
+    TaskType::stepBatch(envs, actions, states, termTypes, costs);
+    for (int e = 0; e < nEnvs; e++)
+      if (termTypes[e] != rai::TerminationType::not_terminated) envs[e]->init();
+    rai::Bench::doNotOptimize(costs);
+  }, [&]() { for (auto env : envs) env->init(); });
+
+  if (!runner.enabled(group, "drawWorld") || !runner.options().visualization) return;
+  rai::Vis::slungload_Visualizer visualizer(K);
+  rai::HomogeneousTransform frame = rai::HomogeneousTransform::Identity();
+  Eigen::Matrix3Xd positions = Eigen::Matrix3Xd::Random(3, K);
+  Eigen::Matrix4Xd orientations = Eigen::Matrix4Xd::Zero(4, K);
+  orientations.row(0).setOnes();
+  rai::Position loadPosition(0.1, 0.2, -0.7);
+  benchDrawWorld(runner, group, [&]() {
+    visualizer.drawWorld(frame, positions, orientations, loadPosition);
+  });
+}
+
+void benchMultiSlungload(rai::Bench::Runner &runner) {
+  benchMultiSlungloadTeam<4>(runner);
+  benchMultiSlungloadTeam<8>(runner);
+}
@@ -0,0 +1,16 @@
+#include "quadrotor/QuadrotorControl.hpp"
+#include "TaskBenchmarks.hpp"
+
+void benchQuadrotor(rai::Bench::Runner &runner) {
+  const std::string group = "QuadrotorControl";
+  benchTask<rai::Task::QuadrotorControl<double> >(runner, group);
+
+  if (!runner.enabled(group, "drawWorld") || !runner.options().visualization) return;
+  rai::Vis::Quadrotor_Visualizer visualizer;
+  rai::HomogeneousTransform frame = rai::HomogeneousTransform::Identity();
+  rai::Position position(0.1, 0.2, 0.3);
+  rai::Quaternion orientation(1.0, 0.0, 0.0, 0.0);
+  benchDrawWorld(runner, group, [&]() {
+    visualizer.drawWorld(frame, position, orientation);
+  });
+}
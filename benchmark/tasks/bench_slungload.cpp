@@ -0,0 +1,108 @@
+#include "slungload/slungloadControl.hpp"
+#include "slungload/visualizer/slungload_GridVisualizer.hpp"
+#include "common/SamplingMpc.hpp"
+#include "common/VineBranching.hpp"
+#include "compression/CompressedTrajectory.hpp"
+#include "TaskBenchmarks.hpp"
+
+void benchSlungload(rai::Bench::Runner &runner) {
+  const std::string group = "slungloadControl";
+  benchTask<rai::Task::slungloadControl<double> >(runner, group);
+
+  /// storing 200 steps of 10 envs, the rotation matrix in the first 9 rows
+  using Task = rai::Task::slungloadControl<double>;
+  using Compressed = rai::Compression::CompressedTrajectory<double, Task::StateDim>;
+  constexpr int nEnvs = 10, nSteps = 200;
+  Compressed::Batch states(int(Task::StateDim), nEnvs * nSteps), decoded;
+  {
+    Task task;
+    task.setControlUpdate_dt(0.01);
+    Task::State state;
+    Task::Action action = Task::Action::Zero();
+    rai::TerminationType termType;
+    double cost;
+    for (int e = 0; e < nEnvs; e++) {
+      task.getInitialState(state);
+      for (int t = 0; t < nSteps; t++) {
+        termType = rai::TerminationType::not_terminated;
+        task.step(action, state, termType, cost);
+        if (termType != rai::TerminationType::not_terminated) task.getInitialState(state);
+        states.col(t * nEnvs + e) = state;
+      }
+    }
+  }
+  Compressed compressed(nEnvs, Compressed::Layout::uniform(1e-3, 0));
+  runner.run(group, "compressTrajectory2000", [&]() {
+    compressed.clear();
+    compressed.append(states);
+    rai::Bench::doNotOptimize(compressed);
+  });
+  compressed.clear();
+  compressed.append(states);
+  runner.run(group, "decodeTrajectory2000", [&]() {
+    compressed.decode(0, nSteps, decoded);
+    rai::Bench::doNotOptimize(decoded);
+  });
+  compressed.decode(0, nSteps, decoded);
+  LOG(INFO) << "compressed trajectory: " << compressed.bytes() << " bytes for "
+            << states.size() * sizeof(double) << " bytes of states, max error "
+            << (decoded - states).cwiseAbs().maxCoeff();
+
+  /// 8 branches of 100 steps from one junction, one worker task per branch
+  std::vector<Task> workerTasks(8);
+  std::vector<Task *> workers;
+  for (auto &worker : workerTasks) {
+    worker.setControlUpdate_dt(0.01);
+    workers.push_back(&worker);
+  }
+  rai::Task::VineBrancher<Task> vine(workers);
+  rai::Task::VineBrancher<Task>::Branches branches;
+  Task::Snapshot junction;
+  Task::ActionBatch firstActions = Task::ActionBatch::Random(int(Task::ActionDim), 8);
+  runner.run(group, "vineBranch8x100", [&]() {
+    vine.branch(junction, firstActions, 100, [](Task::StateBatch &states, Task::ActionBatch &actions) {
+      actions.setZero();
+    }, branches);
+    rai::Bench::doNotOptimize(branches);
+  }, [&]() {
+    Task::State state;
+    workerTasks[0].getInitialState(state);
+    workerTasks[0].saveState(junction);
+  });
+
+  /// one MPPI iteration of 64 sequences over 50 steps on the same workers
+  rai::Task::MpcParameters mpcParameters;
+  mpcParameters.samples = 64;
+  mpcParameters.maxIterations = 1;
+  rai::Task::SamplingMpc<Task> mpc(workers, mpcParameters);
+  Task::Action mpcAction;
+  runner.run(group, "mpcAct64x50", [&]() {
+    mpc.act(junction, mpcAction);
+    rai::Bench::doNotOptimize(mpcAction);
+  });
+
+  /// 64 envs in one window, the grid of a policy evaluation
+  if (runner.enabled(group, "drawGrid64") && runner.options().visualization) {
+    rai::Vis::slungload_GridVisualizer grid(64);
+    rai::Vis::slungload_GridVisualizer::Coordinates q(10, 64);
+    Task task;
+    Task::State state;
+    for (int i = 0; i < 64; i++) {
+      task.getInitialState(state);
+      task.saveState(junction);
+      q.col(i) = junction.coordinate();
+    }
+    runner.run(group, "drawGrid64", [&]() {
+      grid.drawWorld(q);
+    });
+  }
+
+  if (!runner.enabled(group, "drawWorld") || !runner.options().visualization) return;
+  rai::Vis::slungload_Visualizer visualizer;
+  rai::HomogeneousTransform frame = rai::HomogeneousTransform::Identity();
+  rai::Position position(0.1, 0.2, 0.3), loadPosition(0.1, 0.2, -0.7);
+  rai::Quaternion orientation(1.0, 0.0, 0.0, 0.0);
+  benchDrawWorld(runner, group, [&]() {
+    visualizer.drawWorld(frame, position, orientation, loadPosition);
+  });
+}
@@ -0,0 +1,36 @@
+#include "slungload/slungloadControl_partial.hpp"
+#include "slungload/slungloadControl_history.hpp"
+#include "slungload/slungloadControl_estimator.hpp"
+#include "TaskBenchmarks.hpp"
+
+/// the partial task draws through the same visualizer as slungloadControl, so drawWorld is measured there
+void benchSlungloadPartial(rai::Bench::Runner &runner) {
+  benchTask<rai::Task::slungloadControl_partial<double> >(runner, "slungloadControl_partial");
+  /// the stacking on top of the partial task
+  benchTask<rai::Task::slungloadControl_history4<double> >(runner, "slungloadControl_history4");
+
+  rai::Task::ObservationHistoryBatch<double, 21, 4, rai::Task::HistoryMode::deltas> history(100);
+  Eigen::Matrix<double, 21, Eigen::Dynamic> observations = Eigen::Matrix<double, 21, Eigen::Dynamic>::Random(21, 100);
+  Eigen::Matrix<double, 84, Eigen::Dynamic> stacked(84, 100);
+  history.resetAll(observations);
+  runner.run("slungloadControl_history4", "pushStackBatch100", [&]() {
+    history.push(observations);
+    history.stack(stacked);
+    rai::Bench::doNotOptimize(stacked);
+  });
+
+  benchTask<rai::Task::slungloadControl_estimator<double> >(runner, "slungloadControl_estimator");
+
+  /// the filter step alone, for 100 envs at once
+  using Estimator = rai::Task::LoadEstimator<Eigen::Dynamic>;
+  Estimator estimator(100);
+  for (int e = 0; e < 100; e++)
+    estimator.reset(e, Eigen::Vector3d(0.0, 0.0, -1.0), Eigen::Vector3d::Zero());
+  Estimator::Rows3 velocity = Estimator::Rows3::Random(3, 100), velocityNext = velocity;
+  Estimator::Rows3 thrust = Estimator::Rows3::Zero(3, 100);
+  thrust.row(2).setConstant(9.81);
+  runner.run("slungloadControl_estimator", "filterStepBatch100", [&]() {
+    estimator.step(velocity, velocityNext, thrust, 0.01, 0.08, 1.0);
+    rai::Bench::doNotOptimize(estimator);
+  });
+}
@@ -0,0 +1,39 @@
+//
+// Microbenchmarks of the task hot paths.
+// usage: bench_tasks [--reps N] [--min-time SEC] [--filter STR] [--json PATH] [--no-vis]
+//
+
+#include "benchmark/Benchmark.hpp"
+#include "trace/Trace.hpp"
+
+void benchQuadrotor(rai::Bench::Runner &runner);
+void benchSlungload(rai::Bench::Runner &runner);
+void benchSlungloadPartial(rai::Bench::Runner &runner);
+void benchMultiSlungload(rai::Bench::Runner &runner);
+
+/// cost of one recorded span, independent of whether RAI_TRACE is defined
+void benchTrace(rai::Bench::Runner &runner) {
+  auto &tracer = rai::Trace::Tracer::instance();
+  runner.run("Trace", "scope", [&]() {
+    rai::Trace::Scope scope("bench scope");
+  }, [&]() { tracer.clear(); });
+
+  tracer.setEnabled(false);
+  runner.run("Trace", "disabledScope", [&]() {
+    rai::Trace::Scope scope("bench scope");
+  });
+  tracer.setEnabled(true);
+  tracer.clear();
+}
+
+int main(int argc, char *argv[]) {
+  rai::Bench::Runner runner(argc, argv);
+
+  benchTrace(runner);
+  benchQuadrotor(runner);
+  benchSlungload(runner);
+  benchSlungloadPartial(runner);
+  benchMultiSlungload(runner);
+
+  runner.report();
+}
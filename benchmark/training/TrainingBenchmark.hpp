@@ -0,0 +1,175 @@
+//
+// Runs a training configuration headless for a fixed number of iterations and
+// measures its throughput. The update phases are read from rai::Utils::timer,
+// which the algorithms already feed, so the numbers match the pie chart the
+// applications draw. Every config runs in a forked child, the peak resident
+// set a process reports only ever grows and would otherwise carry over from
+// the largest config to all later ones.
+//
+
+#ifndef RAI_TRAININGBENCHMARK_HPP
+#define RAI_TRAININGBENCHMARK_HPP
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "rai/RAI_core"
+#include "metrics/TimerPhases.hpp"
+#include "glog/logging.h"
+
+namespace rai {
+namespace Bench {
+
+struct TrainingOptions {
+  int iterations = 10;
+  int warmupIterations = 1;
+  int stepsPerIteration = 5000;
+  int nThreads = 10;
+};
+
+struct TrainingResult {
+  std::string config;
+  int iterations = 0;
+  long samples = 0;
+  double wallSeconds = 0;
+  double cpuSeconds = 0;
+  long peakRssKb = 0;                    // of the process that ran the config, see runIsolated
+  int nThreads = 0;
+  std::map<std::string, double> phases;  // acquisition, value_fit, gradient, cg, line_search
+  std::map<std::string, double> timers;  // every item of rai::Utils::timer, accumulated over the measured iterations
+
+  double samplesPerSecond() const { return samples / wallSeconds; }
+  /// fraction of the configured threads kept busy
+  double threadUtilization() const { return cpuSeconds / (wallSeconds * nThreads); }
+};
+
+inline double cpuSecondsOfProcess() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + 1e-6 * (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+/// runs runOneLoop of algorithm and reads the number of samples from the acquisitor
+template<typename Algorithm, typename Acquisitor>
+TrainingResult measureTraining(const std::string &config,
+                               const TrainingOptions &options,
+                               Algorithm &algorithm,
+                               Acquisitor &acquisitor) {
+  algorithm.setVisualizationLevel(0);
+  for (int i = 0; i < options.warmupIterations; i++)
+    algorithm.runOneLoop(options.stepsPerIteration);
+
+  TrainingResult result;
+  result.config = config;
+  result.iterations = options.iterations;
+  result.nThreads = options.nThreads;
+
+  const auto timerBefore = Metrics::readTimer();
+  const long stepsBefore = long(acquisitor.stepsTaken());
+  const double cpuBefore = cpuSecondsOfProcess();
+  const auto start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < options.iterations; i++)
+    algorithm.runOneLoop(options.stepsPerIteration);
+
+  result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  result.cpuSeconds = cpuSecondsOfProcess() - cpuBefore;
+  result.samples = long(acquisitor.stepsTaken()) - stepsBefore;
+
+  const auto timerAfter = Metrics::readTimer();
+  for (auto &item : timerAfter) {
+    auto before = timerBefore.find(item.first);
+    result.timers[item.first] = item.second - (before == timerBefore.end() ? 0.0 : before->second);
+  }
+  result.phases = Metrics::phaseDeltas(timerBefore, timerAfter);
+  return result;
+}
+
+/// one field per line, tab separated, timer names may contain spaces
+inline std::string serialize(const TrainingResult &result) {
+  std::ostringstream out;
+  out.precision(17);
+  out << "config\t" << result.config << "\n"
+      << "iterations\t" << result.iterations << "\n"
+      << "samples\t" << result.samples << "\n"
+      << "wall\t" << result.wallSeconds << "\n"
+      << "cpu\t" << result.cpuSeconds << "\n"
+      << "threads\t" << result.nThreads << "\n";
+  for (auto &phase : result.phases) out << "phase\t" << phase.first << "\t" << phase.second << "\n";
+  for (auto &timer : result.timers) out << "timer\t" << timer.first << "\t" << timer.second << "\n";
+  return out.str();
+}
+
+inline TrainingResult deserialize(const std::string &text) {
+  TrainingResult result;
+  std::istringstream in(text);
+  std::string line;
+  while (std::getline(in, line)) {
+    const size_t tab = line.find('\t');
+    if (tab == std::string::npos) continue;
+    const std::string key = line.substr(0, tab), value = line.substr(tab + 1);
+    if (key == "config") result.config = value;
+    else if (key == "iterations") result.iterations = std::stoi(value);
+    else if (key == "samples") result.samples = std::stol(value);
+    else if (key == "wall") result.wallSeconds = std::stod(value);
+    else if (key == "cpu") result.cpuSeconds = std::stod(value);
+    else if (key == "threads") result.nThreads = std::stoi(value);
+    else if (key == "phase" || key == "timer") {
+      const size_t split = value.rfind('\t');
+      (key == "phase" ? result.phases : result.timers)[value.substr(0, split)] = std::stod(value.substr(split + 1));
+    }
+  }
+  return result;
+}
+
+/// runs bench(options) in a forked child and takes the peak resident set of that child alone.
+/// Call it before the process starts TensorFlow or any OpenMP thread, a fork only copies the calling thread
+template<typename Bench>
+TrainingResult runIsolated(Bench &&bench, const TrainingOptions &options) {
+  int fds[2];
+  LOG_IF(FATAL, pipe(fds) != 0) << "could not create a pipe for the benchmark child";
+  std::fflush(nullptr);
+  const pid_t child = fork();
+  LOG_IF(FATAL, child < 0) << "could not fork the benchmark child";
+  if (child == 0) {
+    close(fds[0]);
+    const std::string text = serialize(bench(options));
+    size_t written = 0;
+    while (written < text.size()) {
+      const ssize_t n = write(fds[1], text.data() + written, text.size() - written);
+      if (n <= 0) std::_Exit(1);
+      written += size_t(n);
+    }
+    close(fds[1]);
+    std::fflush(nullptr);
+    /// skips the destructors of TensorFlow and the tasks, the parent only needs the result
+    std::_Exit(0);
+  }
+
+  close(fds[1]);
+  std::string text;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) text.append(buffer, size_t(n));
+  close(fds[0]);
+
+  int status = 0;
+  rusage usage;
+  LOG_IF(FATAL, wait4(child, &status, 0, &usage) != child) << "lost the benchmark child";
+  LOG_IF(FATAL, !WIFEXITED(status) || WEXITSTATUS(status) != 0) << "the benchmark child failed with status " << status;
+  TrainingResult result = deserialize(text);
+  result.peakRssKb = usage.ru_maxrss;
+  return result;
+}
+
+}
+}
+
+#endif //RAI_TRAININGBENCHMARK_HPP
@@ -0,0 +1,55 @@
+#include <rai/RAI_core>
+#include <Eigen/Dense>
+#include "rai/tasks/poleBalancing/PoleBalancing.hpp"
+#include "rai/noiseModel/NormalDistributionNoise.hpp"
+#include "functions/customPolicy.hpp"
+#include "functions/customValue.hpp"
+#include "customAlgo.hpp"
+#include <rai/experienceAcquisitor/TrajectoryAcquisitor_MultiThreadBatch.hpp>
+#include "TrainingBenchmark.hpp"
+
+using Dtype = float;
+using rai::Task::ActionDim;
+using rai::Task::StateDim;
+using Task = rai::Task::PoleBalancing<Dtype>;
+using Policy_ = customPolicy<Dtype, StateDim, ActionDim>;
+using Vfunction_ = customValue<Dtype, StateDim>;
+using Acquisitor_ = rai::ExpAcq::TrajectoryAcquisitor_MultiThreadBatch<Dtype, StateDim, ActionDim>;
+using Noise = rai::Noise::NormalDistributionNoise<Dtype, ActionDim>;
+using NoiseCovariance = Eigen::Matrix<Dtype, ActionDim, ActionDim>;
+
+/// same setup as applications/DIY, the graphs are generated for the cpu
+rai::Bench::TrainingResult benchDIY(const rai::Bench::TrainingOptions &options) {
+  std::vector<Task> taskVec(options.nThreads, Task(Task::fixed, Task::easy));
+  std::vector<rai::Task::Task<Dtype, StateDim, ActionDim, 0> *> taskVector;
+  for (auto &task : taskVec) {
+    task.setControlUpdate_dt(0.05);
+    task.setDiscountFactor(0.995);
+    task.setTimeLimitPerEpisode(25.0);
+    taskVector.push_back(&task);
+  }
+
+  NoiseCovariance covariance = NoiseCovariance::Identity();
+  std::vector<Noise> noiseVec(options.nThreads, Noise(covariance));
+  std::vector<Noise *> noiseVector;
+  for (auto &noise : noiseVec)
+    noiseVector.push_back(&noise);
+
+  std::string shellFilePath = std::string(std::getenv("RAI_ROOT")) + "/applications/examples/DIY/proto/";
+  shellFilePath = shellFilePath + "run_python_scripts.sh " + shellFilePath + "protobufGenerator.py";
+  shellFilePath += typeid(Dtype) == typeid(double) ? " 2 " : " 1 ";
+  shellFilePath += RAI_LOG_PATH;
+  std::string cmdPolicy = shellFilePath + " cpu customPolicy MLP_ 3 1 / 32 32";
+  std::string cmdValue = shellFilePath + " cpu customValue MLP_ 3 1 / 32 32";
+  system(cmdPolicy.c_str());
+  system(cmdValue.c_str());
+
+  Policy_ policy(RAI_LOG_PATH + "/customPolicy_MLP_.pb", 0.001);
+  Vfunction_ vfunction(RAI_LOG_PATH + "/customValue_MLP_.pb", 0.001);
+
+  Acquisitor_ acquisitor;
+  rai::Algorithm::Algo<Dtype, StateDim, ActionDim>
+      algorithm(taskVector, &vfunction, &policy, noiseVector, &acquisitor, 0.97, 2, 3, 1);
+
+  return rai::Bench::measureTraining("DIY", options, algorithm, acquisitor);
+}
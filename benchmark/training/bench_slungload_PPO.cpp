@@ -0,0 +1,48 @@
+#include "rai/RAI_core"
+#include <Eigen/Dense>
+#include "slungload/slungloadControl.hpp"
+#include "rai/noiseModel/NormalDistributionNoise.hpp"
+#include "rai/function/tensorflow/StochasticPolicy_TensorFlow.hpp"
+#include "rai/function/tensorflow/ValueFunction_TensorFlow.hpp"
+#include "rai/algorithm/PPO.hpp"
+#include "rai/experienceAcquisitor/TrajectoryAcquisitor_Parallel.hpp"
+#include "TrainingBenchmark.hpp"
+
+using Dtype = double;
+using TaskTraits = rai::Task::TaskTraits<rai::Task::slungloadControl>;
+constexpr int StateDim = TaskTraits::StateDim;
+constexpr int ActionDim = TaskTraits::ActionDim;
+using Task = rai::Task::slungloadControl<Dtype>;
+using Noise = rai::Noise::NormalDistributionNoise<Dtype, ActionDim>;
+using NoiseCovariance = Eigen::Matrix<Dtype, ActionDim, ActionDim>;
+using Policy_TensorFlow = rai::FuncApprox::StochasticPolicy_TensorFlow<Dtype, StateDim, ActionDim>;
+using Vfunction_TensorFlow = rai::FuncApprox::ValueFunction_TensorFlow<Dtype, StateDim>;
+using Acquisitor = rai::ExpAcq::TrajectoryAcquisitor_Parallel<Dtype, StateDim, ActionDim>;
+
+/// same setup as applications/slungloadwithPPO, on the cpu
+rai::Bench::TrainingResult benchSlungloadPPO(const rai::Bench::TrainingOptions &options) {
+  std::vector<Task> taskVec(options.nThreads, Task());
+  std::vector<rai::Task::Task<Dtype, StateDim, ActionDim, 0> *> taskVector;
+  for (auto &task : taskVec) {
+    task.setControlUpdate_dt(0.01);
+    task.setDiscountFactor(0.99);
+    task.setTimeLimitPerEpisode(5.0);
+    task.setValueAtTerminalState(1.5);
+    taskVector.push_back(&task);
+  }
+
+  Vfunction_TensorFlow vfunction("cpu", "MLP", "tanh 3e-3 24 128 128 1", 1e-3);
+  Policy_TensorFlow policy("cpu", "MLP", "tanh 3e-3 24 128 128 4", 1e-3);
+
+  NoiseCovariance covariance = NoiseCovariance::Identity();
+  std::vector<Noise> noiseVec(options.nThreads, Noise(covariance));
+  std::vector<Noise *> noiseVector;
+  for (auto &noise : noiseVec)
+    noiseVector.push_back(&noise);
+
+  Acquisitor acquisitor;
+  rai::Algorithm::PPO<Dtype, StateDim, ActionDim>
+      algorithm(taskVector, &vfunction, &policy, noiseVector, &acquisitor, 0.97, 0, 0, 20, 5, 5);
+
+  return rai::Bench::measureTraining("slungload_PPO", options, algorithm, acquisitor);
+}
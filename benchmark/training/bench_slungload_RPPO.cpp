@@ -0,0 +1,45 @@
+#include "rai/RAI_core"
+#include <Eigen/Dense>
+#include "rai/tasks/quadrotor/QuadrotorControl_PO.hpp"
+#include "rai/noiseModel/NormalDistributionNoise.hpp"
+#include "rai/function/tensorflow/RecurrentStochasticPolicyValue_TensorFlow.hpp"
+#include "rai/algorithm/RPPO.hpp"
+#include "rai/experienceAcquisitor/TrajectoryAcquisitor_Parallel.hpp"
+#include "TrainingBenchmark.hpp"
+
+using Dtype = double;
+using rai::Task::ActionDim;
+using rai::Task::StateDim;
+using Task = rai::Task::QuadrotorControl_PO<Dtype>;
+using Noise = rai::Noise::NormalDistributionNoise<Dtype, ActionDim>;
+using NoiseCovariance = Eigen::Matrix<Dtype, ActionDim, ActionDim>;
+using PolicyValue_TensorFlow = rai::FuncApprox::RecurrentStochasticPolicyValue_Tensorflow<Dtype, StateDim, ActionDim>;
+using Acquisitor = rai::ExpAcq::TrajectoryAcquisitor_Parallel<Dtype, StateDim, ActionDim>;
+
+/// same setup as applications/slungloadwithRPPO, on the cpu
+rai::Bench::TrainingResult benchSlungloadRPPO(const rai::Bench::TrainingOptions &options) {
+  std::vector<Task> taskVec(options.nThreads, Task());
+  std::vector<rai::Task::Task<Dtype, StateDim, ActionDim, 0> *> taskVector;
+  for (auto &task : taskVec) {
+    task.setControlUpdate_dt(0.01);
+    task.setDiscountFactor(0.99);
+    task.setTimeLimitPerEpisode(8.0);
+    taskVector.push_back(&task);
+  }
+
+  PolicyValue_TensorFlow policy("cpu", "LSTM_merged", "relu 1e-3 12 128 / 128 64 4", 1e-4);
+  policy.setLearningRateDecay(0.99, 50);
+  policy.setMaxGradientNorm(0.05);
+
+  NoiseCovariance covariance = NoiseCovariance::Identity();
+  std::vector<Noise> noiseVec(options.nThreads, Noise(covariance));
+  std::vector<Noise *> noiseVector;
+  for (auto &noise : noiseVec)
+    noiseVector.push_back(&noise);
+
+  Acquisitor acquisitor;
+  rai::Algorithm::RPPO<Dtype, StateDim, ActionDim>
+      algorithm(taskVector, &policy, noiseVector, &acquisitor, 0.95, 1, 5, 20, 5, 5, 5, 1, true, 0.99);
+
+  return rai::Bench::measureTraining("slungload_RPPO", options, algorithm, acquisitor);
+}
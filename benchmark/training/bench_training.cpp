@@ -0,0 +1,96 @@
+//
+// End-to-end training throughput of every application configuration, headless and on the cpu.
+// usage: bench_training [--config NAME] [--iterations N] [--warmup N] [--steps N] [--threads N] [--json PATH]
+//
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include "rai/RAI_core"
+#include "benchmark/Benchmark.hpp"
+#include "TrainingBenchmark.hpp"
+
+using rai::Bench::TrainingOptions;
+using rai::Bench::TrainingResult;
+
+TrainingResult benchQuadrotorPPO(const TrainingOptions &options);
+TrainingResult benchQuadrotorTRPO(const TrainingOptions &options);
+TrainingResult benchSlungloadPPO(const TrainingOptions &options);
+TrainingResult benchSlungloadTRPO(const TrainingOptions &options);
+TrainingResult benchSlungloadRPPO(const TrainingOptions &options);
+TrainingResult benchDIY(const TrainingOptions &options);
+
+static void writeJson(std::ostream &out, const std::map<std::string, double> &values) {
+  out << "{";
+  for (auto it = values.begin(); it != values.end(); ++it)
+    out << (it == values.begin() ? "" : ", ") << rai::Bench::jsonString(it->first) << ": " << it->second;
+  out << "}";
+}
+
+int main(int argc, char *argv[]) {
+  TrainingOptions options;
+  std::string config, jsonPath;
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    LOG_IF(FATAL, i + 1 >= argc) << "usage: " << argv[0]
+                                 << " [--config NAME] [--iterations N] [--warmup N] [--steps N] [--threads N] [--json PATH]";
+    std::string value(argv[++i]);
+    if (arg == "--config") config = value;
+    else if (arg == "--iterations") options.iterations = std::stoi(value);
+    else if (arg == "--warmup") options.warmupIterations = std::stoi(value);
+    else if (arg == "--steps") options.stepsPerIteration = std::stoi(value);
+    else if (arg == "--threads") options.nThreads = std::stoi(value);
+    else if (arg == "--json") jsonPath = value;
+    else LOG(FATAL) << "unknown option " << arg;
+  }
+
+  RAI_init();
+  omp_set_num_threads(options.nThreads);
+
+  const std::vector<std::pair<std::string, std::function<TrainingResult(const TrainingOptions &)> > > configs = {
+      {"quadrotor_PPO", benchQuadrotorPPO},
+      {"quadrotor_TRPO", benchQuadrotorTRPO},
+      {"slungload_PPO", benchSlungloadPPO},
+      {"slungload_TRPO", benchSlungloadTRPO},
+      {"slungload_RPPO", benchSlungloadRPPO},
+      {"DIY", benchDIY}};
+
+  std::vector<TrainingResult> results;
+  for (auto &entry : configs) {
+    if (!config.empty() && entry.first != config) continue;
+    LOG(INFO) << "benchmarking " << entry.first;
+    results.push_back(rai::Bench::runIsolated(entry.second, options));
+    const TrainingResult &r = results.back();
+    std::printf("%-16s %10.0f samples/s  %5.1f%% thread utilization  %8ld kB peak rss\n",
+                r.config.c_str(), r.samplesPerSecond(), 100.0 * r.threadUtilization(), r.peakRssKb);
+    for (auto &phase : r.phases)
+      std::printf("    %-14s %8.3f s/iteration\n", phase.first.c_str(), phase.second / r.iterations);
+  }
+  LOG_IF(FATAL, results.empty()) << "unknown config " << config;
+
+  if (jsonPath.empty()) return 0;
+  std::ofstream out(jsonPath);
+  out << "{\n  \"iterations\": " << options.iterations
+      << ", \"steps_per_iteration\": " << options.stepsPerIteration
+      << ", \"threads\": " << options.nThreads << ",\n  \"configs\": [\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    const TrainingResult &r = results[i];
+    std::map<std::string, double> phasesPerIteration;
+    for (auto &phase : r.phases) phasesPerIteration[phase.first] = phase.second / r.iterations;
+    out << "    {\"config\": " << rai::Bench::jsonString(r.config)
+        << ", \"samples\": " << r.samples
+        << ", \"wall_seconds\": " << r.wallSeconds
+        << ", \"samples_per_second\": " << r.samplesPerSecond()
+        << ", \"cpu_seconds\": " << r.cpuSeconds
+        << ", \"thread_utilization\": " << r.threadUtilization()
+        << ", \"peak_rss_kb\": " << r.peakRssKb
+        << ",\n     \"phase_seconds_per_iteration\": ";
+    writeJson(out, phasesPerIteration);
+    out << ",\n     \"timers\": ";
+    writeJson(out, r.timers);
+    out << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+  std::cout << "wrote " << jsonPath << std::endl;
+}
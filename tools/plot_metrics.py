@@ -0,0 +1,50 @@
+# Draws the metrics a training run exported (metrics.csv in the run's log
+# directory) into one pdf per metric. Runs offline or next to a live run,
+# training never waits on it.
+#
+#   python3 tools/plot_metrics.py <log dir>/metrics.csv [output dir] [metric ...]
+
+import csv
+import os
+import sys
+from collections import defaultdict
+
+import matplotlib
+matplotlib.use('Agg')
+import matplotlib.pyplot as plt
+
+# arguments
+csv_path = sys.argv[1]
+output_dir = sys.argv[2] if len(sys.argv) > 2 else os.path.dirname(os.path.abspath(csv_path))
+selected = set(sys.argv[3:])
+
+# metric -> run -> (x, y); performance and the rates are plotted over steps when they were exported
+series = defaultdict(lambda: defaultdict(lambda: ([], [])))
+steps = defaultdict(dict)
+with open(csv_path) as f:
+    for row in csv.DictReader(f):
+        run, iteration, name, value = row['run'], int(row['iteration']), row['name'], float(row['value'])
+        if name == 'steps':
+            steps[run][iteration] = value
+        if selected and name not in selected:
+            continue
+        x, y = series[name][run]
+        x.append(iteration)
+        y.append(value)
+
+for name, runs in sorted(series.items()):
+    fig, ax = plt.subplots()
+    over_steps = all(steps[run] for run in runs)
+    for run, (x, y) in sorted(runs.items()):
+        if over_steps:
+            x = [steps[run].get(i, float('nan')) for i in x]
+        ax.plot(x, y, marker='s', markersize=2, linewidth=1, label=run)
+    ax.set_xlabel('N. Steps Taken' if over_steps else 'Iteration')
+    ax.set_ylabel(name)
+    ax.set_title(name)
+    ax.grid(True, alpha=0.3)
+    if len(runs) > 1:
+        ax.legend()
+    fig.savefig(os.path.join(output_dir, name + '.pdf'))
+    plt.close(fig)
+    print('wrote ' + os.path.join(output_dir, name + '.pdf'))